@@ -0,0 +1,164 @@
+#ifndef DIGIMESH_AGGREGATE_H
+#define DIGIMESH_AGGREGATE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Bytes in front of every message packed into a payload: the message length.
+ */
+#define DIGI_AGGREGATE_HEADER_SIZE 1
+
+/**
+ * @brief Longest message that can be packed, limited by the width of its length.
+ */
+#define DIGI_AGGREGATE_MAXIMUM_MESSAGE UINT8_MAX
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Called with each packed payload that is ready to go out in one transmit request.
+ * 
+ * @param context - the context pointer given to digi_aggregate_init
+ * @param destination - serial number of the digi module every message in the payload is for
+ * @param payload - the packed messages. Only valid for the duration of the call.
+ * @param length - number of bytes in payload
+ * 
+ * @return digi_status_t - DIGI_ERROR if the payload couldn't be sent, e.g. the TX queue is full. The messages
+ * stay queued and are offered again later.
+ */
+typedef digi_status_t (*digi_aggregate_send_t)(void * context, const digi_serial_t * destination, const uint8_t * payload, size_t length);
+
+/**
+ * @brief Called with each message unpacked from a received payload.
+ * 
+ * @param context - the context pointer given to digi_aggregate_split
+ * @param source - serial number of the digi module that sent the message
+ * @param data - the message. Points into the received payload.
+ * @param length - number of bytes in the message
+ */
+typedef void (*digi_aggregate_receive_t)(void * context, const digi_serial_t * source, const uint8_t * data, size_t length);
+
+/**
+ * @brief Messages waiting for one destination.
+ */
+typedef struct{
+    digi_serial_t destination;  // Where the messages are going
+    uint8_t * buffer;           // The packed messages
+    size_t length;              // Bytes used in buffer
+    uint32_t deadline;          // When the most urgent message must go out
+    bool active;                // The slot holds messages
+}digi_aggregate_slot_t;
+
+/**
+ * @brief Packs small messages for the same destination into one transmit request payload, sent when it fills
+ * or when a message's latency runs out. Allocate one per digi module and initialize it with
+ * digi_aggregate_init. The contents are private to the driver.
+ */
+typedef struct{
+    digi_aggregate_slot_t * slots;      // Caller supplied slots, one destination each
+    uint32_t slot_count;                // Number of slots
+    size_t maximum_payload;             // Most payload bytes in one transmit request, the digi module's NP
+    digi_aggregate_send_t send;         // Called with each packed payload
+    void * context;                     // Passed to send
+    uint32_t messages;                  // Number of messages packed
+    uint32_t payloads;                  // Number of payloads sent
+}digi_aggregate_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize an aggregator with nothing queued.
+ * 
+ * @param aggregate - the aggregator
+ * @param slots - storage for the destinations with messages waiting, the most there can be at once
+ * @param slot_count - number of slots
+ * @param buffers - slot_count * maximum_payload bytes for the waiting messages
+ * @param maximum_payload - most payload bytes the digi module sends in one transmit request, its NP
+ * @param send - called with each packed payload
+ * @param context - passed to send
+ * 
+ * @return digi_status_t - DIGI_ERROR if slots or buffers is NULL, slot_count is 0, maximum_payload can't hold
+ * an empty message, or slot_count * maximum_payload overflows
+ */
+digi_status_t digi_aggregate_init(digi_aggregate_t * aggregate, digi_aggregate_slot_t * slots, uint32_t slot_count, uint8_t * buffers, size_t maximum_payload, digi_aggregate_send_t send, void * context);
+
+/**
+ * @brief Queue a message to go out packed with others for the same destination. The destination's messages
+ * are sent first if this one doesn't fit after them, and the most urgent destination is sent if every slot
+ * is in use.
+ * 
+ * @param aggregate - the aggregator
+ * @param destination - serial number of the digi module to send to
+ * @param data - the message, copied
+ * @param length - bytes in the message
+ * @param latency - how long the message may wait, in the caller's time units
+ * @param now - the current time, in the caller's time units
+ * 
+ * @return digi_status_t - DIGI_ERROR if the message is too long to pack, and should be sent on its own, or a
+ * send needed to make room for it failed. The message isn't queued.
+ */
+digi_status_t digi_aggregate_queue(digi_aggregate_t * aggregate, const digi_serial_t * destination, const uint8_t * data, size_t length, uint32_t latency, uint32_t now);
+
+/**
+ * @brief Send every destination whose most urgent message has waited as long as it may. Call this
+ * periodically.
+ * 
+ * @param aggregate - the aggregator
+ * @param now - the current time, in the caller's time units
+ * 
+ * @return digi_status_t - DIGI_ERROR if a send failed. Its destination stays queued for the next poll.
+ */
+digi_status_t digi_aggregate_poll(digi_aggregate_t * aggregate, uint32_t now);
+
+/**
+ * @brief Send everything waiting.
+ * 
+ * @param aggregate - the aggregator
+ * 
+ * @return digi_status_t - DIGI_ERROR if a send failed. Its destination stays queued.
+ */
+digi_status_t digi_aggregate_flush(digi_aggregate_t * aggregate);
+
+/**
+ * @brief Unpack a received payload into its messages. Nothing is delivered unless the whole payload is well
+ * formed.
+ * 
+ * @param packet - the receive packet carrying the packed messages
+ * @param receive - called with each message in order
+ * @param context - passed to receive
+ * 
+ * @return digi_status_t - DIGI_ERROR if a message's length runs past the end of the payload
+ */
+digi_status_t digi_aggregate_split(const digi_receive_packet_t * packet, digi_aggregate_receive_t receive, void * context);
+
+/**
+ * @brief Number of messages packed.
+ * 
+ * @param aggregate - the aggregator
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_aggregate_messages(const digi_aggregate_t * aggregate);
+
+/**
+ * @brief Number of payloads sent, one transmit request each.
+ * 
+ * @param aggregate - the aggregator
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_aggregate_payloads(const digi_aggregate_t * aggregate);
+
+#endif
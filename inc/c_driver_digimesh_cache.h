@@ -0,0 +1,124 @@
+#ifndef DIGIMESH_CACHE_H
+#define DIGIMESH_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief The last known value of each integer field of one digi module, so reads can be answered without a
+ * round trip. Values are learned from local AT command responses and forgotten when they may have changed.
+ * Allocate one per digi module and initialize it with digi_cache_init. The contents are private to the
+ * driver.
+ */
+typedef struct{
+    uint32_t values[DIGI_FIELD_END];        // Last value received for each field
+    uint32_t generations[DIGI_FIELD_END];   // The generation each value was received in
+    uint32_t generation;                    // Values from older generations are stale
+    uint32_t hits;                          // Number of reads answered from the cache
+    uint32_t misses;                        // Number of reads that need the digi module asked
+}digi_cache_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize a cache with nothing known.
+ * 
+ * @param cache - the cache
+ */
+void digi_cache_init(digi_cache_t * cache);
+
+/**
+ * @brief Read a field from the cache without going to the digi module. digi_cache_read builds the query on a
+ * miss.
+ * 
+ * @param cache - the cache
+ * @param field - the field to read
+ * @param value - populated with the field's value on a hit
+ * 
+ * @return digi_status_t - DIGI_ERROR on a miss
+ */
+digi_status_t digi_cache_get(digi_cache_t * cache, digi_field_t field, uint32_t * value);
+
+/**
+ * @brief Read a field through the cache: answered from memory on a hit, and on a miss the query for it is
+ * built with digi_generate_get_field_message, ready to send. Its response, handed to digi_cache_frame, fills
+ * the cache for the next read.
+ * 
+ * @param cache - the cache
+ * @param field - the field to read
+ * @param value - populated with the field's value on a hit
+ * @param message - buffer to write the query into on a miss
+ * @param size - number of bytes available in message
+ * @param frame_id - id the query's response will carry
+ * @param written - populated with the number of bytes of the query, 0 on a hit, if it doesn't fit, or if the
+ * field is a string or wider than a uint32_t and so is never cached
+ * 
+ * @return digi_status_t - DIGI_OK on a hit, DIGI_ERROR on a miss
+ */
+digi_status_t digi_cache_read(digi_cache_t * cache, digi_field_t field, uint32_t * value, uint8_t * message, size_t size, uint8_t frame_id, size_t * written);
+
+/**
+ * @brief Learn from a frame received from the digi module. Matches digi_frame_handler_t so it can be
+ * registered with a dispatch table for local AT command responses and modem status, with the cache as the
+ * context. Query responses fill the cache. Successful AC, RE and FR responses and modem status resets empty
+ * it.
+ * 
+ * @param context - the cache
+ * @param frame - the received frame
+ */
+void digi_cache_frame(void * context, const digi_frame_view_t * frame);
+
+/**
+ * @brief Forget whatever frames about to be sent to the digi module may change. Setting or queueing a field
+ * forgets that field and AC, RE and FR forget everything. Call this with every buffer built by
+ * digi_generate_set_field_message, digi_generate_get_field_message or digi_generate_configuration.
+ * 
+ * @param cache - the cache
+ * @param message - one or more whole frames, back to back
+ * @param size - number of bytes in message
+ */
+void digi_cache_sent(digi_cache_t * cache, const uint8_t * message, size_t size);
+
+/**
+ * @brief Forget one field.
+ * 
+ * @param cache - the cache
+ * @param field - the field
+ */
+void digi_cache_invalidate(digi_cache_t * cache, digi_field_t field);
+
+/**
+ * @brief Forget every field.
+ * 
+ * @param cache - the cache
+ */
+void digi_cache_invalidate_all(digi_cache_t * cache);
+
+/**
+ * @brief Number of reads answered from the cache.
+ * 
+ * @param cache - the cache
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_cache_hits(const digi_cache_t * cache);
+
+/**
+ * @brief Number of reads that missed the cache.
+ * 
+ * @param cache - the cache
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_cache_misses(const digi_cache_t * cache);
+
+#endif
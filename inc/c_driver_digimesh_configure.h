@@ -0,0 +1,74 @@
+#ifndef DIGIMESH_CONFIGURE_H
+#define DIGIMESH_CONFIGURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+#include "c_driver_digimesh_pending.h"
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Waits on the one response to a batch built by digi_generate_configuration. Allocate one per batch in
+ * flight and keep it until digi_configure_done. The contents are private to the driver.
+ */
+typedef struct{
+    digi_pending_t * pending;   // Hands out the AC's frame id and matches its response
+    uint8_t frame_id;           // Frame id of the AC
+    uint8_t status;             // Status of the AC's response once it has arrived
+    bool waiting;               // The AC's response is still to come
+}digi_configure_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Build a configuration batch with digi_generate_configuration, taking the AC's frame id from the
+ * pending table so its response is picked up when it's handed to digi_pending_complete.
+ * 
+ * @param configure - holds the batch while it's in flight
+ * @param pending - the digi module's pending table
+ * @param message - buffer to write the frames into
+ * @param size - number of bytes available in message
+ * @param settings - the fields to set, in the order they're sent
+ * @param count - number of settings
+ * 
+ * @return size_t - the number of bytes written or 0 if they don't fit, a setting can't be written or there's
+ * no free frame id
+ */
+size_t digi_configure_start(digi_configure_t * configure, digi_pending_t * pending, uint8_t * message, size_t size, const digi_setting_t * settings, size_t count);
+
+/**
+ * @brief Check whether the batch has been applied or given up on.
+ * 
+ * @param configure - the batch
+ * 
+ * @return true - the AC's response has arrived or the batch was cancelled
+ * @return false - the response is still to come
+ */
+bool digi_configure_done(const digi_configure_t * configure);
+
+/**
+ * @brief Status of the AC's response: 0 if every queued value was applied, otherwise the digi module's error.
+ * A response that doesn't decode is reported as 1, an error.
+ * 
+ * @param configure - the batch
+ * 
+ * @return uint8_t - 0xFF if the response hasn't arrived or the batch was cancelled
+ */
+uint8_t digi_configure_status(const digi_configure_t * configure);
+
+/**
+ * @brief Stop waiting for the response, e.g. on a timeout, and give back its frame id. Does nothing if the
+ * batch is already done.
+ * 
+ * @param configure - the batch
+ */
+void digi_configure_cancel(digi_configure_t * configure);
+
+#endif
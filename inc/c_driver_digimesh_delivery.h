@@ -0,0 +1,197 @@
+#ifndef DIGIMESH_DELIVERY_H
+#define DIGIMESH_DELIVERY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+#include "c_driver_digimesh_pending.h"
+#include "c_driver_digimesh_nodes.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Buckets in a latency histogram. Bucket 0 counts latencies of 0, bucket n counts latencies from
+ * 2^(n-1) up to 2^n - 1 and the last bucket counts everything longer.
+ */
+#define DIGI_DELIVERY_LATENCY_BUCKETS 16
+
+/**
+ * @brief Buckets in a retry histogram, one per retry count with the last counting everything higher.
+ */
+#define DIGI_DELIVERY_RETRY_BUCKETS 8
+
+/**
+ * @brief Buckets in a discovery histogram, one per digi_delivery_discovery_t.
+ */
+#define DIGI_DELIVERY_DISCOVERY_BUCKETS 6
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Discovery a transmission needed, as reported in its transmit status. Indexes the discovery histogram.
+ */
+typedef enum{
+    DIGI_DELIVERY_DISCOVERY_NONE,               // 0x00, no discovery overhead
+    DIGI_DELIVERY_DISCOVERY_ADDRESS,            // 0x01, address discovery
+    DIGI_DELIVERY_DISCOVERY_ROUTE,              // 0x02, route discovery
+    DIGI_DELIVERY_DISCOVERY_ADDRESS_AND_ROUTE,  // 0x03, address and route discovery
+    DIGI_DELIVERY_DISCOVERY_EXTENDED_TIMEOUT,   // 0x40, extended timeout discovery
+    DIGI_DELIVERY_DISCOVERY_OTHER               // Any value not listed above
+}digi_delivery_discovery_t;
+
+/**
+ * @brief How transmissions to one destination have gone. Read it with digi_delivery_link or
+ * digi_delivery_next.
+ */
+typedef struct{
+    uint64_t key;                                           // The destination's key from digi_serial_to_key
+    uint32_t latency[DIGI_DELIVERY_LATENCY_BUCKETS];        // Time from sending to transmit status, in the caller's time units
+    uint32_t retries[DIGI_DELIVERY_RETRY_BUCKETS];          // Retries per transmission
+    uint32_t discovery[DIGI_DELIVERY_DISCOVERY_BUCKETS];    // Discovery needed per transmission
+    uint32_t delivered;                                     // Number of transmissions delivered
+    uint32_t failed;                                        // Number of transmissions that weren't
+}digi_delivery_link_t;
+
+/**
+ * @brief A transmit request waiting for its transmit status.
+ */
+typedef struct{
+    uint32_t link;          // Index of the destination's node and link
+    uint32_t sent;          // When the request was sent
+    bool active;            // Still waiting for its transmit status
+}digi_delivery_request_t;
+
+/**
+ * @brief Sends transmit requests with frame ids from the pending table, matches their transmit statuses and
+ * keeps delivery statistics per destination. Allocate one per digi module and initialize it with
+ * digi_delivery_init. The contents are private to the driver.
+ */
+typedef struct{
+    digi_pending_t * pending;                               // Hands out frame ids and matches transmit statuses
+    digi_node_table_t nodes;                                // Destinations, over caller supplied nodes
+    digi_delivery_link_t * links;                           // Caller supplied, one per node slot
+    digi_delivery_request_t requests[DIGI_PENDING_SLOTS];   // Requests in flight, by the frame id the pending table gave them
+    uint32_t now;                                           // Time given to digi_delivery_complete
+    uint32_t untracked;                                     // Transmissions not counted because the node table was full
+}digi_delivery_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize a delivery tracker with no destinations. Destinations are kept in a node table over the
+ * caller's nodes, which also counts each destination's transmissions waiting for a transmit status in
+ * pending_tx.
+ * 
+ * @param delivery - the tracker
+ * @param pending - the digi module's pending table
+ * @param nodes - storage for the destinations' node table
+ * @param links - storage for one link per node slot
+ * @param capacity - number of slots in nodes and in links. A power of two of at least 2, of which
+ * DIGI_NODES_MAXIMUM_LOAD percent can be used.
+ * 
+ * @return digi_status_t - DIGI_ERROR if capacity isn't a power of two of at least 2
+ */
+digi_status_t digi_delivery_init(digi_delivery_t * delivery, digi_pending_t * pending, digi_node_t * nodes, digi_delivery_link_t * links, uint32_t capacity);
+
+/**
+ * @brief Build a transmit request with a frame id from the pending table, so its transmit status can be
+ * matched to it.
+ * 
+ * @param delivery - the tracker
+ * @param message - buffer to write the frame into
+ * @param size - number of bytes available in message
+ * @param destination - serial number of the digi module to send to
+ * @param options - transmit options byte
+ * @param payload - the pieces of the payload in the order they are sent
+ * @param count - number of pieces in payload
+ * @param now - the current time, in the caller's time units
+ * @param frame_id - populated with the frame id the request was given, for digi_delivery_cancel
+ * 
+ * @return size_t - the number of bytes written to message or 0 if it doesn't fit or there's no free frame id
+ */
+size_t digi_delivery_generate(digi_delivery_t * delivery, uint8_t * message, size_t size, const digi_serial_t * destination, uint8_t options, const digi_payload_t * payload, size_t count, uint32_t now, uint8_t * frame_id);
+
+/**
+ * @brief Take in a transmit status. It's handed on to digi_pending_complete, which matches it to its
+ * request. Give transmit statuses to this rather than straight to digi_pending_complete so their latency
+ * can be measured.
+ * 
+ * @param delivery - the tracker
+ * @param frame - the transmit status frame
+ * @param now - the current time, in the caller's time units
+ * 
+ * @return digi_status_t - DIGI_ERROR if the frame isn't a transmit status or nothing is waiting on its frame id
+ */
+digi_status_t digi_delivery_complete(digi_delivery_t * delivery, const digi_frame_view_t * frame, uint32_t now);
+
+/**
+ * @brief Stop waiting for the transmit status of a request, e.g. because it was never written to the digi
+ * module, and free its frame id. Nothing is recorded against the destination.
+ * 
+ * @param delivery - the tracker
+ * @param frame_id - the frame id digi_delivery_generate gave the request
+ * 
+ * @return digi_status_t - DIGI_ERROR if no request is waiting on frame_id
+ */
+digi_status_t digi_delivery_cancel(digi_delivery_t * delivery, uint8_t frame_id);
+
+/**
+ * @brief Give up on requests whose transmit status hasn't arrived within the timeout, e.g. because it was
+ * corrupted or the digi module reset, and free their frame ids. Each counts as a failed delivery. Call this
+ * periodically.
+ * 
+ * @param delivery - the tracker
+ * @param now - the current time, in the caller's time units
+ * @param timeout - how long to wait for a transmit status, in the caller's time units
+ */
+void digi_delivery_poll(digi_delivery_t * delivery, uint32_t now, uint32_t timeout);
+
+/**
+ * @brief Look up the statistics of one destination.
+ * 
+ * @param delivery - the tracker
+ * @param destination - the destination's serial number
+ * 
+ * @return const digi_delivery_link_t* - NULL if nothing has been sent to it
+ */
+const digi_delivery_link_t * digi_delivery_link(digi_delivery_t * delivery, const digi_serial_t * destination);
+
+/**
+ * @brief Walk every destination, e.g. to find the slow ones.
+ * 
+ * @param delivery - the tracker
+ * @param cursor - set to 0 before the first call and left alone between calls
+ * 
+ * @return const digi_delivery_link_t* - the next destination or NULL once they've all been seen
+ */
+const digi_delivery_link_t * digi_delivery_next(const digi_delivery_t * delivery, uint32_t * cursor);
+
+/**
+ * @brief Estimate a latency percentile of a destination from its histogram.
+ * 
+ * @param link - the destination
+ * @param percent - the percentile, from 1 to 100
+ * 
+ * @return uint32_t - the upper bound of the bucket the percentile falls in, UINT32_MAX for the last bucket,
+ * 0 if nothing has been recorded
+ */
+uint32_t digi_delivery_latency_percentile(const digi_delivery_link_t * link, uint8_t percent);
+
+/**
+ * @brief Number of transmissions not counted because the destination didn't fit in the table.
+ * 
+ * @param delivery - the tracker
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_delivery_untracked(const digi_delivery_t * delivery);
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef DIGIMESH_DISPATCH_H
+#define DIGIMESH_DISPATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Number of slots in a dispatch table, one for every value of a frame type byte
+ */
+#define DIGI_DISPATCH_SLOTS 256
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Handles one received frame.
+ * 
+ * @param context - the context pointer given when the handler was registered
+ * @param frame - the frame. Only valid for the duration of the call.
+ */
+typedef void (*digi_frame_handler_t)(void * context, const digi_frame_view_t * frame);
+
+/**
+ * @brief A registered handler.
+ */
+typedef struct{
+    digi_frame_handler_t handler;   // Called for every frame of this type
+    void * context;                 // Passed to handler
+}digi_dispatch_entry_t;
+
+/**
+ * @brief Routes received frames to a handler per frame type. Allocate one per digi module and initialize it
+ * with digi_dispatch_init. The contents are private to the driver.
+ */
+typedef struct{
+    digi_dispatch_entry_t entries[DIGI_DISPATCH_SLOTS];    // Indexed directly by frame type
+    uint32_t unhandled;                                     // Frames dropped because no handler was registered
+}digi_dispatch_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize a dispatch table with no handlers registered.
+ * 
+ * @param dispatch - the dispatch table
+ */
+void digi_dispatch_init(digi_dispatch_t * dispatch);
+
+/**
+ * @brief Register the handler for a frame type, replacing any handler already registered for it.
+ * 
+ * @param dispatch - the dispatch table
+ * @param type - the frame type, e.g. DIGI_FRAME_RECEIVE_PACKET
+ * @param handler - called for every frame of this type
+ * @param context - passed to handler
+ * 
+ * @return digi_status_t - DIGI_ERROR if handler is NULL
+ */
+digi_status_t digi_dispatch_register(digi_dispatch_t * dispatch, uint8_t type, digi_frame_handler_t handler, void * context);
+
+/**
+ * @brief Remove the handler for a frame type. Frames of that type are counted as unhandled again.
+ * 
+ * @param dispatch - the dispatch table
+ * @param type - the frame type
+ */
+void digi_dispatch_unregister(digi_dispatch_t * dispatch, uint8_t type);
+
+/**
+ * @brief Hand a frame to the handler registered for its type. Frames with no handler are counted and
+ * dropped. Every frame costs one table lookup and one indirect call, there are no branches on the type.
+ * 
+ * @param dispatch - the dispatch table
+ * @param frame - the frame
+ */
+void digi_dispatch_frame(digi_dispatch_t * dispatch, const digi_frame_view_t * frame);
+
+/**
+ * @brief Feed raw bytes to a parser and dispatch every frame it completes.
+ * 
+ * @param dispatch - the dispatch table
+ * @param parser - the parser for the serial stream the bytes came from
+ * @param bytes - raw bytes received from the digi module
+ * @param size - number of bytes in bytes
+ * 
+ * @return size_t - the number of frames dispatched, handled or not
+ */
+size_t digi_dispatch_receive(digi_dispatch_t * dispatch, digi_parser_t * parser, const uint8_t * bytes, size_t size);
+
+/**
+ * @brief Total number of frames dropped because no handler was registered for their type.
+ * 
+ * @param dispatch - the dispatch table
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_dispatch_unhandled(const digi_dispatch_t * dispatch);
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef DIGIMESH_ESCAPE_H
+#define DIGIMESH_ESCAPE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Byte that precedes an escaped byte in API mode 2
+ */
+#define DIGI_ESCAPE 0x7D
+
+/**
+ * @brief An escaped byte is sent XORed with this value
+ */
+#define DIGI_ESCAPE_XOR 0x20
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief State of an unescaper. Allocate one per serial stream and initialize it with digi_unescaper_init.
+ * The contents are private to the driver.
+ */
+typedef struct{
+    bool escape_pending;    // The last byte seen was an escape so the next byte is XORed
+}digi_unescaper_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Escape frames for a digi module in API mode 2 (AP=2). Every 0x7E, 0x7D, 0x11 and 0x13 after each
+ * frame's start delimiter is replaced with 0x7D followed by the byte XORed with 0x20.
+ * 
+ * @param frames - one or more complete unescaped frames back to back, e.g. from
+ * digi_generate_transmit_request or a batch from the TX queue or digi_generate_configuration
+ * @param size - number of bytes in frames
+ * @param escaped - buffer to write the escaped frames into. Must not overlap frames.
+ * @param capacity - number of bytes available in escaped. Twice size is always enough.
+ * 
+ * @return size_t - number of bytes written to escaped or 0 if it doesn't fit
+ */
+size_t digi_escape(const uint8_t * frames, size_t size, uint8_t * escaped, size_t capacity);
+
+/**
+ * @brief Reset an unescaper.
+ * 
+ * @param unescaper - the unescaper
+ */
+void digi_unescaper_init(digi_unescaper_t * unescaper);
+
+/**
+ * @brief Unescape bytes received from a digi module in API mode 2 so they can be given to digi_parser_feed.
+ * Bytes may arrive in chunks of any size, an escape at the end of one chunk is applied to the first byte of
+ * the next. Unescaping never makes data longer so it can be done in place.
+ * 
+ * @param unescaper - the unescaper state
+ * @param input - bytes received from the digi module
+ * @param size - number of bytes in input
+ * @param output - buffer for the unescaped bytes, at least size bytes long. May be the same as input.
+ * 
+ * @return size_t - number of bytes written to output
+ */
+size_t digi_unescape(digi_unescaper_t * unescaper, const uint8_t * input, size_t size, uint8_t * output);
+
+#endif
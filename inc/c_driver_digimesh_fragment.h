@@ -0,0 +1,176 @@
+#ifndef DIGIMESH_FRAGMENT_H
+#define DIGIMESH_FRAGMENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Bytes at the start of every fragment's payload: message id, fragment index, fragment count and
+ * the number of message bytes in every fragment but the last.
+ */
+#define DIGI_FRAGMENT_HEADER_SIZE 4
+
+/**
+ * @brief Most fragments one message can be split into.
+ */
+#define DIGI_FRAGMENT_MAXIMUM_COUNT 255
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Called with each message once all of its fragments have arrived.
+ * 
+ * @param context - the context pointer given to digi_reassembly_init
+ * @param source - serial number of the digi module that sent the message
+ * @param data - the message. Only valid for the duration of the call.
+ * @param length - number of bytes in the message
+ */
+typedef void (*digi_reassembly_callback_t)(void * context, const digi_serial_t * source, const uint8_t * data, size_t length);
+
+/**
+ * @brief A message being put back together.
+ */
+typedef struct{
+    uint64_t source;                                        // Key of the sender from digi_serial_to_key
+    uint8_t * buffer;                                       // Where the message is put back together
+    uint32_t started;                                       // When the first fragment arrived
+    size_t length;                                          // Length of the message, known once the last fragment arrives
+    uint8_t received[(DIGI_FRAGMENT_MAXIMUM_COUNT + 7) / 8];    // Bit per fragment that has arrived
+    uint8_t message_id;                                     // The sender's id for the message
+    uint8_t count;                                          // Number of fragments in the message
+    uint8_t fragment_size;                                  // Message bytes in every fragment but the last
+    uint8_t remaining;                                      // Number of fragments still to arrive
+    bool active;                                            // The slot holds a message
+    bool complete;                                          // The message was handed over and the slot is kept until the timeout to catch repeated fragments
+}digi_reassembly_slot_t;
+
+/**
+ * @brief Puts fragmented messages back together, several senders at a time, in caller supplied buffers.
+ * Allocate one per digi module and initialize it with digi_reassembly_init. The contents are private to
+ * the driver.
+ */
+typedef struct{
+    digi_reassembly_slot_t * slots;         // Caller supplied slots
+    uint32_t slot_count;                    // Number of slots
+    size_t buffer_size;                     // Bytes in each slot's buffer, the longest message that can be received
+    uint32_t timeout;                       // How long a message may take to arrive in full
+    digi_reassembly_callback_t callback;    // Called with complete messages
+    void * context;                         // Passed to callback
+    uint32_t completed;                     // Number of messages put back together
+    uint32_t timeouts;                      // Number of messages dropped because a fragment never arrived
+    uint32_t dropped;                       // Number of fragments dropped as malformed, too long or inconsistent
+    uint32_t evictions;                     // Number of messages dropped to make room for a newer one
+}digi_reassembly_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Number of fragments a message needs.
+ * 
+ * @param length - bytes in the message
+ * @param maximum_payload - most payload bytes the digi module sends in one transmit request, its NP
+ * 
+ * @return uint8_t - 0 if the message needs more than DIGI_FRAGMENT_MAXIMUM_COUNT fragments or maximum_payload
+ * can't fit a header and some data
+ */
+uint8_t digi_fragment_count(size_t length, uint16_t maximum_payload);
+
+/**
+ * @brief Builds the transmit request frame for one fragment of a message. The fragment header and the slice
+ * of the message are gathered straight into message without copying the message first.
+ * 
+ * @param message - buffer to write the frame into
+ * @param size - number of bytes available in message
+ * @param frame_id - id the transmit status will carry. If 0 the device will not emit a transmit status.
+ * @param destination - serial number of the digi module to send to
+ * @param options - transmit options byte
+ * @param message_id - the id of this message, different from the sender's other messages in flight
+ * @param data - the whole message
+ * @param length - bytes in the whole message
+ * @param maximum_payload - most payload bytes the digi module sends in one transmit request, its NP
+ * @param index - which fragment to build, from 0 to one less than digi_fragment_count
+ * 
+ * @return size_t - the number of bytes written to message or 0 if it doesn't fit or index is out of range
+ */
+size_t digi_generate_fragment(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, uint8_t options, uint8_t message_id, const uint8_t * data, size_t length, uint16_t maximum_payload, uint8_t index);
+
+/**
+ * @brief Initialize a reassembler with every slot free. A message's slot is kept for the timeout after the
+ * message is handed over, so fragments the sender repeats late are recognised rather than starting a message
+ * that can never complete. Messages that fit in one fragment are remembered the same way when a slot is free
+ * or holds a message already handed over. Senders mustn't reuse a message id within the timeout.
+ * 
+ * @param reassembly - the reassembler
+ * @param slots - storage for the messages being put back together, the most that can be in flight at once
+ * @param slot_count - number of slots
+ * @param buffers - slot_count * buffer_size bytes for the messages
+ * @param buffer_size - bytes for each message, the longest message that can be received
+ * @param timeout - how long a message may take to arrive in full, in the caller's time units
+ * @param callback - called with complete messages
+ * @param context - passed to callback
+ * 
+ * @return digi_status_t - DIGI_ERROR if there are no slots
+ */
+digi_status_t digi_reassembly_init(digi_reassembly_t * reassembly, digi_reassembly_slot_t * slots, uint32_t slot_count, uint8_t * buffers, size_t buffer_size, uint32_t timeout, digi_reassembly_callback_t callback, void * context);
+
+/**
+ * @brief Take in a received fragment. When it completes its message the callback is called. If every slot
+ * is in use a message already handed over makes room before the oldest message still arriving is dropped.
+ * 
+ * @param reassembly - the reassembler
+ * @param packet - the receive packet carrying the fragment
+ * @param now - the current time, in the caller's time units
+ * 
+ * @return digi_status_t - DIGI_ERROR if the fragment was dropped
+ */
+digi_status_t digi_reassembly_receive(digi_reassembly_t * reassembly, const digi_receive_packet_t * packet, uint32_t now);
+
+/**
+ * @brief Drop messages whose fragments haven't all arrived within the timeout, and free the slots of messages
+ * handed over more than the timeout ago. Call this periodically.
+ * 
+ * @param reassembly - the reassembler
+ * @param now - the current time, in the caller's time units
+ */
+void digi_reassembly_poll(digi_reassembly_t * reassembly, uint32_t now);
+
+/**
+ * @brief Number of messages put back together.
+ * 
+ * @param reassembly - the reassembler
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_reassembly_completed(const digi_reassembly_t * reassembly);
+
+/**
+ * @brief Number of messages that failed to arrive in full: timed out, or dropped to make room for a newer one.
+ * 
+ * @param reassembly - the reassembler
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_reassembly_failures(const digi_reassembly_t * reassembly);
+
+/**
+ * @brief Number of fragments dropped as malformed, too long for the buffers or inconsistent with the rest
+ * of their message.
+ * 
+ * @param reassembly - the reassembler
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_reassembly_dropped(const digi_reassembly_t * reassembly);
+
+#endif
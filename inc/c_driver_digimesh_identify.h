@@ -0,0 +1,108 @@
+#ifndef DIGIMESH_IDENTIFY_H
+#define DIGIMESH_IDENTIFY_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+#include "c_driver_digimesh_pending.h"
+#include "c_driver_digimesh_cache.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Number of fields queried to identify a digi module: SH, SL, NI, ID, CH, NP, VR and HV.
+ */
+#define DIGI_IDENTIFY_FIELDS 8
+
+/**
+ * @brief Longest node identifier (NI) a digi module holds.
+ */
+#define DIGI_IDENTIFY_NODE_IDENTIFIER_SIZE 20
+
+/**
+ * @brief Most bytes digi_identify_start writes, for sizing its buffer.
+ */
+#define DIGI_IDENTIFY_MESSAGE_SIZE (DIGI_IDENTIFY_FIELDS * 8)
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Asks a digi module who it is with every query in flight at once and fills in the digi module's
+ * context as the responses come back in whatever order. Allocate one per digi module and keep it until
+ * digi_identify_done, or digi_identify_cancel. The contents are private to the driver.
+ */
+typedef struct{
+    digi_t * digi;                                                  // Gets its serial number once SH and SL are both back
+    digi_cache_t * cache;                                           // Gets the integer values. May be NULL.
+    digi_pending_t * pending;                                       // Hands out the frame ids and matches responses
+    uint8_t frame_ids[DIGI_IDENTIFY_FIELDS];                        // Frame id of each query, in the order of the queried fields
+    uint8_t serial[DIGI_SERIAL_LENGTH];                             // SH and SL as they arrive
+    uint8_t outstanding;                                            // Bit per query still waiting for its response
+    uint8_t failed;                                                 // Bit per query answered with an error, malformed or cancelled
+    char node_identifier[DIGI_IDENTIFY_NODE_IDENTIFIER_SIZE + 1];   // NI, NUL terminated
+}digi_identify_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Build every identification query back to back in message, so they can go out in one write, each
+ * with its own frame id from the pending table. Responses are handled when they're handed to
+ * digi_pending_complete. digi_is_initialized becomes true as soon as both SH and SL have arrived.
+ * 
+ * @param identify - holds the identification while it's in flight
+ * @param digi - the digi module to identify
+ * @param pending - the digi module's pending table
+ * @param cache - the digi module's parameter cache, to fill with ID, CH, NP, VR and HV. May be NULL.
+ * @param message - buffer to write the queries into
+ * @param size - number of bytes available in message, DIGI_IDENTIFY_MESSAGE_SIZE is enough
+ * 
+ * @return size_t - the number of bytes written or 0 if they don't fit or there aren't enough free frame ids
+ */
+size_t digi_identify_start(digi_identify_t * identify, digi_t * digi, digi_pending_t * pending, digi_cache_t * cache, uint8_t * message, size_t size);
+
+/**
+ * @brief Check whether every query has been answered.
+ * 
+ * @param identify - the identification
+ * 
+ * @return true - nothing is outstanding
+ * @return false - responses are still to come
+ */
+bool digi_identify_done(const digi_identify_t * identify);
+
+/**
+ * @brief Stop waiting for the responses still to come, e.g. on a timeout, and give back their frame ids. The
+ * queries they answer count as failed. Afterwards the identification can be reused or freed.
+ * 
+ * @param identify - the identification
+ */
+void digi_identify_cancel(digi_identify_t * identify);
+
+/**
+ * @brief Check whether any query was answered with an error, didn't decode or was cancelled.
+ * 
+ * @param identify - the identification
+ * 
+ * @return true - at least one query failed
+ * @return false - no query has failed so far
+ */
+bool digi_identify_failed(const digi_identify_t * identify);
+
+/**
+ * @brief The digi module's node identifier (NI).
+ * 
+ * @param identify - the identification
+ * 
+ * @return const char* - NUL terminated, empty until the response arrives
+ */
+const char * digi_identify_node_identifier(const digi_identify_t * identify);
+
+#endif
@@ -0,0 +1,128 @@
+#ifndef DIGIMESH_NODES_H
+#define DIGIMESH_NODES_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "c_driver_digimesh_parser.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Percentage of a node table's slots that can be used. Keeping some free keeps probe sequences short.
+ */
+#define DIGI_NODES_MAXIMUM_LOAD 75
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Whether a remote node is known to be asleep.
+ */
+typedef enum{
+    DIGI_NODE_SLEEP_UNKNOWN,    // Nothing has been heard about the node's sleep state
+    DIGI_NODE_AWAKE,            // The node is awake and can be sent to
+    DIGI_NODE_ASLEEP            // The node is asleep, messages to it will be held by its parent or lost
+}digi_node_sleep_t;
+
+/**
+ * @brief What is known about a remote node. Everything but key and used is for the caller to maintain.
+ */
+typedef struct{
+    uint64_t key;               // The node's serial number packed with digi_serial_to_key
+    uint32_t last_seen;         // When a frame was last received from the node, in the caller's time units
+    uint8_t link_quality;       // Link quality to the node, e.g. the RSSI of its last packet (DB)
+    uint8_t pending_tx;         // Number of frames sent to the node still waiting for a transmit status
+    uint8_t sleep;              // A digi_node_sleep_t
+    bool used;                  // The slot holds a node
+}digi_node_t;
+
+/**
+ * @brief A fixed capacity table of remote nodes keyed by serial number. Uses open addressing over caller
+ * supplied storage so it never allocates. The contents are private to the driver.
+ */
+typedef struct{
+    digi_node_t * nodes;        // Caller supplied slots
+    uint32_t mask;              // Number of slots minus one. The number of slots is a power of two.
+    uint32_t count;             // Number of slots in use
+    uint32_t limit;             // Most slots that can be in use
+    uint8_t shift;              // Shift that turns a 64 bit hash into a slot index
+}digi_node_table_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Pack a serial number into a 64 bit key, most significant byte first.
+ * 
+ * @param serial - the serial number
+ * 
+ * @return uint64_t 
+ */
+uint64_t digi_serial_to_key(const digi_serial_t * serial);
+
+/**
+ * @brief Unpack a 64 bit key into a serial number.
+ * 
+ * @param key - a key made by digi_serial_to_key
+ * @param serial - populated with the serial number
+ */
+void digi_key_to_serial(uint64_t key, digi_serial_t * serial);
+
+/**
+ * @brief Initialize an empty node table over caller supplied slots.
+ * 
+ * @param table - the table to initialize
+ * @param nodes - storage for the slots. It must outlive the table.
+ * @param capacity - number of slots in nodes. Must be a power of two of at least 2. Only
+ * DIGI_NODES_MAXIMUM_LOAD percent of them can be used.
+ * 
+ * @return digi_status_t - DIGI_ERROR if capacity isn't a power of two of at least 2
+ */
+digi_status_t digi_nodes_init(digi_node_table_t * table, digi_node_t * nodes, uint32_t capacity);
+
+/**
+ * @brief Find a node.
+ * 
+ * @param table - the table
+ * @param key - the node's key from digi_serial_to_key
+ * 
+ * @return digi_node_t* - the node or NULL if it isn't in the table. Only valid until the next evict.
+ */
+digi_node_t * digi_nodes_find(digi_node_table_t * table, uint64_t key);
+
+/**
+ * @brief Find a node, adding it if it isn't in the table yet. A new node starts with all of its
+ * information cleared.
+ * 
+ * @param table - the table
+ * @param key - the node's key from digi_serial_to_key
+ * 
+ * @return digi_node_t* - the node or NULL if it's new and the table is full. Only valid until the next evict.
+ */
+digi_node_t * digi_nodes_insert(digi_node_table_t * table, uint64_t key);
+
+/**
+ * @brief Remove a node from the table. Other nodes may move so pointers to them are no longer valid.
+ * 
+ * @param table - the table
+ * @param key - the node's key from digi_serial_to_key
+ * 
+ * @return digi_status_t - DIGI_ERROR if the node isn't in the table
+ */
+digi_status_t digi_nodes_evict(digi_node_table_t * table, uint64_t key);
+
+/**
+ * @brief Number of nodes in the table.
+ * 
+ * @param table - the table
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_nodes_count(const digi_node_table_t * table);
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <stdint.h> 
 #include <stdbool.h>
+#include <stddef.h>
 
 /**********************/
 /* PUBLIC DEFINITIONS */
@@ -18,6 +19,31 @@
  */
 #define MAXIMUM_MESSAGE_SIZE 128
 
+/**
+ * @brief Bytes of storage a caller has to supply for each digi module context
+ */
+#define DIGI_CONTEXT_SIZE 32
+
+/**
+ * @brief Byte that marks the start of every API frame
+ */
+#define DIGI_START_DELIMITER 0x7E
+
+/**
+ * @brief Bytes in front of the frame data, the start delimiter and two length bytes.
+ */
+#define DIGI_FRAME_HEADER_SIZE 3
+
+/**
+ * @brief Bytes a frame adds around its frame data, the header plus the checksum.
+ */
+#define DIGI_FRAME_OVERHEAD (DIGI_FRAME_HEADER_SIZE + 1)
+
+/**
+ * @brief Bytes of frame data in a local AT command before any value, frame type, frame id and command.
+ */
+#define DIGI_LOCAL_AT_SIZE 4
+
 
 /****************/
 /* PUBLIC TYPES */
@@ -39,18 +65,232 @@ typedef struct{
 }digi_serial_t;
 
 /**
- * @brief Holds state information about a digimodule.
+ * @brief Holds state information about a digimodule. A handle to one is obtained from digi_init.
  */
 typedef struct digi_t digi_t;
 
 /**
- * @brief For identifying what digi device field you want to set or get.
+ * @brief Caller supplied storage for one digi module context. Declare one per digi module, statically or
+ * otherwise, and hand it to digi_init. Contexts share no state so each can be driven from its own thread.
+ */
+typedef union{
+    uint8_t bytes[DIGI_CONTEXT_SIZE];   // Room for the private context
+    uint64_t align;                     // Forces alignment suitable for the private context
+    void * align_pointer;               // Forces alignment suitable for the private context
+}digi_context_storage_t;
+
+/**
+ * @brief For identifying what digi device field you want to set or get. Fields that are commands, like
+ * DIGI_FIELD_AC, take no value and are sent with digi_generate_get_field_message.
  */
 typedef enum{
-    DIGI_FIELD_ID,
+    DIGI_FIELD_ID,        // Network ID
+    DIGI_FIELD_CH,        // Operating channel
+    DIGI_FIELD_HP,        // Preamble ID
+    DIGI_FIELD_CE,        // Routing and messaging mode
+    DIGI_FIELD_MT,        // Broadcast multi-transmits
+    DIGI_FIELD_RR,        // Unicast mac retries
+    DIGI_FIELD_MR,        // Mesh unicast retries
+    DIGI_FIELD_NH,        // Network hops
+    DIGI_FIELD_BH,        // Broadcast hops
+    DIGI_FIELD_NN,        // Network delay slots
+    DIGI_FIELD_NT,        // Node discover timeout
+    DIGI_FIELD_NO,        // Node discover options
+    DIGI_FIELD_DH,        // Destination address high
+    DIGI_FIELD_DL,        // Destination address low
+    DIGI_FIELD_TO,        // Transmit options
+    DIGI_FIELD_NI,        // Node identifier string
+    DIGI_FIELD_SH,        // Serial number high
+    DIGI_FIELD_SL,        // Serial number low
+    DIGI_FIELD_MY,        // 16 bit network address
+    DIGI_FIELD_NP,        // Maximum payload bytes
+    DIGI_FIELD_DD,        // Device type identifier
+    DIGI_FIELD_CI,        // Cluster ID
+    DIGI_FIELD_EE,        // Encryption enable
+    DIGI_FIELD_KY,        // Encryption key
+    DIGI_FIELD_PL,        // Transmit power level
+    DIGI_FIELD_BD,        // Serial baud rate
+    DIGI_FIELD_NB,        // Serial parity
+    DIGI_FIELD_SB,        // Serial stop bits
+    DIGI_FIELD_RO,        // Packetization timeout
+    DIGI_FIELD_FT,        // Flow control threshold
+    DIGI_FIELD_AP,        // API mode
+    DIGI_FIELD_AO,        // API options
+    DIGI_FIELD_SM,        // Sleep mode
+    DIGI_FIELD_SO,        // Sleep options
+    DIGI_FIELD_SN,        // Number of sleep periods
+    DIGI_FIELD_SP,        // Sleep period
+    DIGI_FIELD_ST,        // Wake time
+    DIGI_FIELD_WH,        // Wake host delay
+    DIGI_FIELD_D0,        // DIO0 configuration
+    DIGI_FIELD_D1,        // DIO1 configuration
+    DIGI_FIELD_D2,        // DIO2 configuration
+    DIGI_FIELD_D3,        // DIO3 configuration
+    DIGI_FIELD_D4,        // DIO4 configuration
+    DIGI_FIELD_D5,        // DIO5 configuration
+    DIGI_FIELD_D6,        // DIO6 configuration
+    DIGI_FIELD_D7,        // DIO7 configuration
+    DIGI_FIELD_D8,        // DIO8 configuration
+    DIGI_FIELD_D9,        // DIO9 configuration
+    DIGI_FIELD_P0,        // DIO10 configuration
+    DIGI_FIELD_P1,        // DIO11 configuration
+    DIGI_FIELD_P2,        // DIO12 configuration
+    DIGI_FIELD_PR,        // Pull up resistor enable
+    DIGI_FIELD_IR,        // IO sample rate
+    DIGI_FIELD_IC,        // Digital change detection
+    DIGI_FIELD_VR,        // Firmware version
+    DIGI_FIELD_HV,        // Hardware version
+    DIGI_FIELD_VOLTAGE,   // Supply voltage (%V)
+    DIGI_FIELD_DB,        // Last packet RSSI
+    DIGI_FIELD_TP,        // Module temperature
+    DIGI_FIELD_ER,        // Received error count
+    DIGI_FIELD_GD,        // Good packets received
+    DIGI_FIELD_EA,        // MAC ACK failures
+    DIGI_FIELD_TR,        // Transmission failures
+    DIGI_FIELD_UA,        // MAC unicast transmissions
+    DIGI_FIELD_AI,        // Association indication
+    DIGI_FIELD_AC,        // Apply changes
+    DIGI_FIELD_WR,        // Write parameters to flash
+    DIGI_FIELD_RE,        // Restore factory defaults
+    DIGI_FIELD_FR,        // Software reset
+    DIGI_FIELD_ND,        // Node discover
+    DIGI_FIELD_CN,        // Exit command mode
     DIGI_FIELD_END
 }digi_field_t;
 
+/**
+ * @brief Describes a digi device field.
+ */
+typedef struct{
+    char code[2];       // The 2 ascii characters the digi module knows the field by. E.g. "ID" or "CH"
+    uint8_t width;      // Bytes in the field's value, the maximum for strings. 0 for commands that take no value.
+    bool writable;      // The field can be set
+    bool apply;         // A new value only takes effect once changes are applied (AC)
+}digi_field_info_t;
+
+/**
+ * @brief Identifies the type of an API frame. This is the first byte of the frame data.
+ */
+typedef enum{
+    DIGI_FRAME_LOCAL_AT = 0x08,
+    DIGI_FRAME_LOCAL_AT_QUEUE = 0x09,
+    DIGI_FRAME_TRANSMIT_REQUEST = 0x10,
+    DIGI_FRAME_REMOTE_AT = 0x17,
+    DIGI_FRAME_LOCAL_AT_RESPONSE = 0x88,
+    DIGI_FRAME_MODEM_STATUS = 0x8A,
+    DIGI_FRAME_TRANSMIT_STATUS = 0x8B,
+    DIGI_FRAME_RECEIVE_PACKET = 0x90,
+    DIGI_FRAME_REMOTE_AT_RESPONSE = 0x97,
+    DIGI_FRAME_END
+}digi_frame_t;
+
+/**
+ * @brief The status a modem status frame reports. This is the only byte of its frame data.
+ */
+typedef enum{
+    DIGI_MODEM_STATUS_HARDWARE_RESET = 0x00,    // Powered up or reset, unsaved values are lost
+    DIGI_MODEM_STATUS_WATCHDOG_RESET = 0x01,    // The watchdog timer reset it, unsaved values are lost
+    DIGI_MODEM_STATUS_JOINED = 0x02             // Joined a network
+}digi_modem_status_t;
+
+/**
+ * @brief One piece of a payload that is spread over several buffers. The pieces are sent back to back.
+ */
+typedef struct{
+    const uint8_t * data;   // Start of this piece
+    size_t length;          // Number of bytes in this piece
+}digi_payload_t;
+
+/**
+ * @brief A value for one field, for setting several fields at once with digi_generate_configuration.
+ */
+typedef struct{
+    digi_field_t field;     // The field to set
+    uint32_t value;         // The value to set the field to
+}digi_setting_t;
+
+/**
+ * @brief Outcome of feeding bytes to a frame parser.
+ */
+typedef enum{
+    DIGI_PARSE_NEED_MORE,       // All of the input was consumed without completing a frame
+    DIGI_PARSE_FRAME,           // A complete frame with a valid checksum is available
+    DIGI_PARSE_BAD_CHECKSUM,    // A complete frame was received but its checksum didn't match. It was dropped.
+    DIGI_PARSE_BAD_LENGTH       // The length field was zero or larger than MAXIMUM_MESSAGE_SIZE. The frame was dropped.
+}digi_parse_result_t;
+
+/**
+ * @brief A decoded API frame. Points at memory owned by someone else, either the input handed to
+ * digi_parser_feed or the parser itself, so it is only valid until the next call to digi_parser_feed
+ * or until the caller reuses its input buffer.
+ */
+typedef struct{
+    uint8_t type;           // The frame type. Compare against digi_frame_t.
+    const uint8_t * data;   // The frame data following the frame type byte
+    uint16_t length;        // Number of bytes pointed to by data
+}digi_frame_view_t;
+
+/**
+ * @brief A decoded receive packet frame. The payload is not copied, it points into the same memory as the
+ * frame it was decoded from so it has the same lifetime. It is valid until the next call to digi_parser_feed,
+ * until the caller reuses its input buffer or until the bytes are released with digi_ring_read_commit,
+ * whichever comes first.
+ */
+typedef struct{
+    digi_serial_t source;       // Serial number of the digi module that sent the packet
+    uint8_t options;            // Receive options byte
+    const uint8_t * payload;    // The received data
+    uint16_t length;            // Number of bytes pointed to by payload
+}digi_receive_packet_t;
+
+/**
+ * @brief A decoded local AT command response. The value points into the same memory as the frame it was
+ * decoded from so it has the same lifetime.
+ */
+typedef struct{
+    uint8_t frame_id;           // The frame id of the command this responds to
+    digi_field_t field;         // The field the command was for. DIGI_FIELD_END if it isn't a known field.
+    uint8_t code[2];            // The 2 ascii characters of the command as received
+    uint8_t status;             // 0 OK, 1 error, 2 invalid command, 3 invalid parameter
+    const uint8_t * value;      // The field's value when it was queried
+    uint16_t length;            // Number of bytes pointed to by value
+}digi_at_response_t;
+
+/**
+ * @brief A decoded transmit status, reporting how a transmit request went.
+ */
+typedef struct{
+    uint8_t frame_id;           // The frame id of the transmit request this reports on
+    uint8_t retries;            // Number of times the transmission was retried
+    uint8_t delivery;           // 0 delivered, anything else is a failure reason
+    uint8_t discovery;          // 0 none needed, 1 address, 2 route, 3 address and route, 0x40 extended timeout
+}digi_transmit_status_t;
+
+/**
+ * @brief A decoded remote AT command response. The value points into the same memory as the frame it was
+ * decoded from so it has the same lifetime.
+ */
+typedef struct{
+    digi_serial_t source;           // Serial number of the digi module that responded
+    digi_at_response_t response;    // The response, laid out as for a local AT command
+}digi_remote_at_response_t;
+
+/**
+ * @brief State of an incremental frame parser. Allocate one per serial stream and initialize it with
+ * digi_parser_init. The contents are private to the driver.
+ */
+typedef struct{
+    uint8_t state;                              // Where in the frame the parser currently is
+    uint8_t sum;                                // Running 8 bit sum of the frame data received so far
+    uint16_t length;                            // Value of the length field of the current frame
+    uint16_t stored;                            // Bytes after the start delimiter held in buffer
+    uint16_t replay_start;                      // Start in buffer of bytes from a bad frame still to be parsed
+    uint16_t replay_length;                     // Number of bytes from a bad frame still to be parsed
+    uint32_t discarded;                         // Bytes thrown away because they weren't part of a good frame
+    uint32_t resyncs;                           // Times a bad frame was dropped and the parser resynchronized
+    uint8_t buffer[MAXIMUM_MESSAGE_SIZE + 3];   // Length, frame data and checksum of a frame split across calls
+}digi_parser_t;
+
 
 
 
@@ -59,36 +299,262 @@ typedef enum{
 /********************************/
 
 /**
- * @brief Initialize the state of the digimesh parser driver.
+ * @brief Initialize the state of a digi module context in caller supplied storage.
+ * 
+ * @param storage - the memory the context lives in. It must outlive the returned handle.
+ * 
+ * @return digi_t* - handle to the context, used by every other call for this digi module
  */
-void digi_init(void);
+digi_t * digi_init(digi_context_storage_t * storage);
 
 /**
- * @brief Allows users to check if the digi module owned by the code module is initialized or not. A digi module is initialzed if it's
+ * @brief Allows users to check if a digi module is initialized or not. A digi module is initialzed if it's
  * serial number isn't empty.
  * 
+ * @param digi - the digi module context
+ * 
  * @return true - state is initialized
  * @return false - state is not initialized
  */
-bool digi_is_initialized(void);
+bool digi_is_initialized(const digi_t * digi);
 
 /**
  * @brief Populates an array with the digimesh serial number
  * 
+ * @param digi - the digi module context
  * @param serial - pointer to a digi serial object for population.
  * 
  * @return digi_status_t 
  */
-digi_status_t digi_get_serial(digi_serial_t * serial);
+digi_status_t digi_get_serial(const digi_t * digi, digi_serial_t * serial);
 
 /**
  * @brief Stores the state information of a digi module
  * 
+ * @param digi - the digi module context
  * @param serial - Digi serial number object used to give information to the digi module
  * @return digi_status_t
  */
-digi_status_t digi_register(digi_serial_t * serial);
+digi_status_t digi_register(digi_t * digi, digi_serial_t * serial);
+
+/**
+ * @brief Reset a frame parser so that it waits for the next start delimiter.
+ * 
+ * @param parser - the parser to reset
+ */
+void digi_parser_init(digi_parser_t * parser);
+
+/**
+ * @brief Feed raw bytes from the serial line to a frame parser. Bytes may arrive in chunks of any size,
+ * the parser resumes where the previous call left off. The parser stops as soon as a frame is complete
+ * or dropped so call it in a loop, advancing the input by consumed each time, until it returns
+ * DIGI_PARSE_NEED_MORE.
+ * 
+ * Keep calling after the input is used up, with size 0, until DIGI_PARSE_NEED_MORE comes back. A dropped
+ * frame that was split across calls can hold a good frame, and the parser keeps those bytes back to parse
+ * again. They are only parsed by a later call, so a caller that stops as soon as consumed reaches size
+ * doesn't get that frame until more bytes arrive, and the frame is lost if none do.
+ * 
+ * A frame that lies entirely within one call's input is returned as a view straight into that input.
+ * Only frames that are split across calls are gathered in the parser's own buffer.
+ * 
+ * When a frame is dropped for a bad length or checksum the parser doesn't step through it byte by byte.
+ * It jumps to the next start delimiter inside the dropped frame, or past it if there isn't one, so
+ * recovering from noise costs one pass over the corrupted bytes.
+ * 
+ * @param parser - the parser state
+ * @param bytes - raw bytes received from the digi module
+ * @param size - number of bytes in bytes
+ * @param consumed - populated with the number of bytes of input that were used
+ * @param frame - populated with the frame when DIGI_PARSE_FRAME is returned
+ * 
+ * @return digi_parse_result_t 
+ */
+digi_parse_result_t digi_parser_feed(digi_parser_t * parser, const uint8_t * bytes, size_t size, size_t * consumed, digi_frame_view_t * frame);
+
+/**
+ * @brief Total number of bytes a parser has thrown away because they weren't part of a good frame. This
+ * counts noise between frames as well as the bytes of dropped frames.
+ * 
+ * @param parser - the parser
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_parser_discarded(const digi_parser_t * parser);
+
+/**
+ * @brief Total number of times a parser dropped a frame for a bad length or checksum and resynchronized.
+ * 
+ * @param parser - the parser
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_parser_resyncs(const digi_parser_t * parser);
 
+/**
+ * @brief Look up the description of a field.
+ * 
+ * @param field - the field
+ * 
+ * @return const digi_field_info_t* - the description or NULL if the field is unknown
+ */
+const digi_field_info_t * digi_field_info(digi_field_t field);
 
+/**
+ * @brief Find the field a 2 character AT command refers to, in constant time.
+ * 
+ * @param code - the 2 ascii characters of the command, as they appear in a frame
+ * 
+ * @return digi_field_t - the field or DIGI_FIELD_END if the command isn't known
+ */
+digi_field_t digi_field_from_code(const uint8_t * code);
+
+/**
+ * @brief Builds a local AT command frame that sets a field on the local digi module. The frame is written
+ * straight into message. The value is sent most significant byte first using the field's width.
+ * 
+ * @param message - buffer to write the frame into
+ * @param size - number of bytes available in message
+ * @param frame_id - id the response will carry. If 0 the device will not emit a response.
+ * @param field - the field to set
+ * @param value - the value to set the field to
+ * 
+ * @return size_t - the number of bytes written to message or 0 if it doesn't fit, the field is unknown,
+ * the field can't be written or the field's value is wider than 4 bytes
+ */
+size_t digi_generate_set_field_message(uint8_t * message, size_t size, uint8_t frame_id, digi_field_t field, uint32_t value);
+
+/**
+ * @brief Builds a local AT command frame that queries a field on the local digi module. The frame is written
+ * straight into message.
+ * 
+ * @param message - buffer to write the frame into
+ * @param size - number of bytes available in message
+ * @param frame_id - id the response will carry. If 0 the device will not emit a response.
+ * @param field - the field to query
+ * 
+ * @return size_t - the number of bytes written to message or 0 if it doesn't fit or the field is unknown
+ */
+size_t digi_generate_get_field_message(uint8_t * message, size_t size, uint8_t frame_id, digi_field_t field);
+
+/**
+ * @brief Builds every frame needed to set several fields on the local digi module and apply them together,
+ * back to back in message so they can go out in one write. Each value is queued with frame id 0, so the
+ * digi module sends no response for it, and the batch ends with an AC that applies them all. Only the AC's
+ * response, carrying frame_id, needs to be waited for, which digi_configure_start does through the pending
+ * table. A value the digi module rejects isn't reported so read the field back if that matters.
+ * 
+ * @param message - buffer to write the frames into
+ * @param size - number of bytes available in message
+ * @param frame_id - id the response to the AC will carry
+ * @param settings - the fields and the values to set them to, in the order they're sent
+ * @param count - number of settings
+ * 
+ * @return size_t - the number of bytes written to message or 0 if it doesn't fit or any setting couldn't be
+ * built by digi_generate_set_field_message
+ */
+size_t digi_generate_configuration(uint8_t * message, size_t size, uint8_t frame_id, const digi_setting_t * settings, size_t count);
+
+/**
+ * @brief Builds a remote AT command frame that sets a field on another digi module. The value is sent most
+ * significant byte first using the field's width.
+ * 
+ * @param message - buffer to write the frame into
+ * @param size - number of bytes available in message
+ * @param frame_id - id the response will carry. If 0 the device will not emit a response.
+ * @param destination - serial number of the digi module to configure
+ * @param options - remote command options. 0x02 applies the change straight away.
+ * @param field - the field to set
+ * @param value - the value to set the field to
+ * 
+ * @return size_t - the number of bytes written to message or 0 if it doesn't fit, the field is unknown,
+ * the field can't be written or the field's value is wider than 4 bytes
+ */
+size_t digi_generate_remote_set_field_message(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, uint8_t options, digi_field_t field, uint32_t value);
+
+/**
+ * @brief Builds a remote AT command frame that queries a field on another digi module.
+ * 
+ * @param message - buffer to write the frame into
+ * @param size - number of bytes available in message
+ * @param frame_id - id the response will carry. If 0 the device will not emit a response.
+ * @param destination - serial number of the digi module to query
+ * @param field - the field to query
+ * 
+ * @return size_t - the number of bytes written to message or 0 if it doesn't fit or the field is unknown
+ */
+size_t digi_generate_remote_get_field_message(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, digi_field_t field);
+
+/**
+ * @brief Builds a transmit request frame that sends a payload to another digi module. The payload is gathered
+ * from any number of pieces straight into message and the checksum is summed in the same pass.
+ * 
+ * @param message - buffer to write the frame into
+ * @param size - number of bytes available in message
+ * @param frame_id - id the transmit status will carry. If 0 the device will not emit a transmit status.
+ * @param destination - serial number of the digi module to send to
+ * @param options - transmit options byte
+ * @param payload - the pieces of the payload in the order they are sent
+ * @param count - number of pieces in payload
+ * 
+ * @return size_t - the number of bytes written to message or 0 if it doesn't fit
+ */
+size_t digi_generate_transmit_request(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, uint8_t options, const digi_payload_t * payload, size_t count);
+
+/**
+ * @brief Points a transmit request frame at another destination in place, for sending the same payload to
+ * many digi modules. Only the frame id and destination are overwritten and the checksum is adjusted by the
+ * bytes that changed, so the cost doesn't depend on the payload length. Send the frame before retargeting
+ * it again. digi_tx_queue doesn't copy the frames it queues, so fanning out through the TX batcher needs a
+ * buffer per destination: retargeting a frame that is queued but not yet flushed changes what goes out.
+ * 
+ * @param message - a frame built by digi_generate_transmit_request
+ * @param length - number of bytes in the frame
+ * @param frame_id - id the transmit status will carry. If 0 the device will not emit a transmit status.
+ * @param destination - serial number of the digi module to send to
+ * 
+ * @return digi_status_t - DIGI_ERROR if message isn't a transmit request frame of that length
+ */
+digi_status_t digi_retarget_transmit_request(uint8_t * message, size_t length, uint8_t frame_id, const digi_serial_t * destination);
+
+/**
+ * @brief Decodes a receive packet frame without copying its payload.
+ * 
+ * @param frame - a frame returned by digi_parser_feed
+ * @param packet - populated with the packet. The payload points into the frame's memory.
+ * 
+ * @return digi_status_t - DIGI_ERROR if the frame isn't a receive packet or is too short to be one
+ */
+digi_status_t digi_decode_receive_packet(const digi_frame_view_t * frame, digi_receive_packet_t * packet);
+
+/**
+ * @brief Decodes a local AT command response frame without copying its value.
+ * 
+ * @param frame - a frame returned by digi_parser_feed
+ * @param response - populated with the response. The value points into the frame's memory.
+ * 
+ * @return digi_status_t - DIGI_ERROR if the frame isn't a local AT command response or is too short to be one
+ */
+digi_status_t digi_decode_at_response(const digi_frame_view_t * frame, digi_at_response_t * response);
+
+/**
+ * @brief Decode a transmit status frame.
+ * 
+ * @param frame - the frame to decode
+ * @param status - populated with the transmit status
+ * 
+ * @return digi_status_t - DIGI_ERROR if the frame isn't a transmit status or is too short to be one
+ */
+digi_status_t digi_decode_transmit_status(const digi_frame_view_t * frame, digi_transmit_status_t * status);
+
+/**
+ * @brief Decode a remote AT command response frame in place.
+ * 
+ * @param frame - the frame to decode
+ * @param response - populated with the response
+ * 
+ * @return digi_status_t - DIGI_ERROR if the frame isn't a remote AT command response or is too short to be one
+ */
+digi_status_t digi_decode_remote_at_response(const digi_frame_view_t * frame, digi_remote_at_response_t * response);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef DIGIMESH_PENDING_H
+#define DIGIMESH_PENDING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "c_driver_digimesh_parser.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Number of slots in a pending table, one for every value of a frame id. Id 0 asks the digi module
+ * not to respond so it is never handed out.
+ */
+#define DIGI_PENDING_SLOTS 256
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Called when the response to a pending request arrives.
+ * 
+ * @param context - the context pointer given when the request was added
+ * @param frame - the response frame. Only valid for the duration of the call.
+ */
+typedef void (*digi_pending_callback_t)(void * context, const digi_frame_view_t * frame);
+
+/**
+ * @brief A request waiting for its response.
+ */
+typedef struct{
+    digi_pending_callback_t callback;   // Called with the response. May be NULL.
+    void * context;                     // Passed to callback
+    bool active;                        // The frame id is in use
+}digi_pending_entry_t;
+
+/**
+ * @brief Hands out frame ids for one digi module and tracks the requests waiting on them. Allocate one per
+ * digi module and initialize it with digi_pending_init. The contents are private to the driver.
+ */
+typedef struct{
+    digi_pending_entry_t entries[DIGI_PENDING_SLOTS];   // Indexed directly by frame id
+    uint8_t free_ids[DIGI_PENDING_SLOTS];               // Queue of frame ids not in use, least recently used first
+    uint8_t free_head;                                  // Position of the oldest free id in free_ids
+    uint16_t free_count;                                // Number of ids in free_ids
+}digi_pending_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize a pending table with every frame id free.
+ * 
+ * @param pending - the pending table
+ */
+void digi_pending_init(digi_pending_t * pending);
+
+/**
+ * @brief Allocate a frame id for a request that expects a response. Ids are reused least recently used
+ * first so a late response is unlikely to match a newer request.
+ * 
+ * @param pending - the pending table
+ * @param callback - called when the response arrives. May be NULL.
+ * @param context - passed to callback
+ * @param frame_id - populated with the frame id to put in the request
+ * 
+ * @return digi_status_t - DIGI_ERROR if every frame id is in use
+ */
+digi_status_t digi_pending_add(digi_pending_t * pending, digi_pending_callback_t callback, void * context, uint8_t * frame_id);
+
+/**
+ * @brief Complete the request a response frame belongs to. Handles local AT command responses, transmit
+ * status and remote AT command responses, whose first byte after the frame type is the frame id. The
+ * request's callback is called and its frame id is freed.
+ * 
+ * @param pending - the pending table
+ * @param frame - the response frame
+ * 
+ * @return digi_status_t - DIGI_ERROR if the frame isn't a response or its frame id isn't pending
+ */
+digi_status_t digi_pending_complete(digi_pending_t * pending, const digi_frame_view_t * frame);
+
+/**
+ * @brief Give up on a request, e.g. when its response has timed out, and free its frame id. The callback
+ * isn't called.
+ * 
+ * @param pending - the pending table
+ * @param frame_id - the request's frame id
+ * 
+ * @return digi_status_t - DIGI_ERROR if the frame id isn't pending
+ */
+digi_status_t digi_pending_cancel(digi_pending_t * pending, uint8_t frame_id);
+
+/**
+ * @brief Check whether a frame id is waiting for a response.
+ * 
+ * @param pending - the pending table
+ * @param frame_id - the frame id
+ * 
+ * @return true - the frame id is in use
+ * @return false - the frame id is free
+ */
+bool digi_pending_is_active(const digi_pending_t * pending, uint8_t frame_id);
+
+/**
+ * @brief Number of requests waiting for a response.
+ * 
+ * @param pending - the pending table
+ * 
+ * @return uint16_t 
+ */
+uint16_t digi_pending_count(const digi_pending_t * pending);
+
+#endif
@@ -0,0 +1,159 @@
+#ifndef DIGIMESH_POOL_H
+#define DIGIMESH_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Bytes in each block, enough for the largest frame: start delimiter, length, frame data and checksum.
+ * Make it bigger to hold e.g. escaped frames. See the readme for changing it.
+ */
+#ifndef DIGI_POOL_BLOCK_SIZE
+#define DIGI_POOL_BLOCK_SIZE (MAXIMUM_MESSAGE_SIZE + 4)
+#endif
+
+/**
+ * @brief Blocks a thread's cache moves to or from the shared pool at a time. See the readme for changing it.
+ */
+#ifndef DIGI_POOL_CACHE_BATCH
+#define DIGI_POOL_CACHE_BATCH 8
+#endif
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief One block of a pool. Declare an array of these as the pool's storage.
+ */
+typedef union digi_pool_block{
+    union digi_pool_block * next;           // Next free block while the block is free
+    uint8_t data[DIGI_POOL_BLOCK_SIZE];     // The frame while the block is in use
+}digi_pool_block_t;
+
+/**
+ * @brief Hands out fixed size frame buffers from caller supplied storage without touching the heap.
+ * Allocate one and initialize it with digi_pool_init. Build with DIGI_POOL_THREADS defined to share one pool
+ * between threads. The contents are private to the driver.
+ */
+typedef struct{
+    digi_pool_block_t * blocks;     // Caller supplied storage
+    digi_pool_block_t * free;       // First free block
+    uint32_t count;                 // Number of blocks in storage
+    uint32_t used;                  // Number of blocks handed out, including those held by caches
+    uint32_t high_water;            // Most blocks ever handed out at once
+    uint32_t failures;              // Number of allocations refused because the pool was empty
+    uint8_t lock;                   // Held while the pool is changed, when built with DIGI_POOL_THREADS
+}digi_pool_t;
+
+/**
+ * @brief A thread's own stash of blocks so most allocations and frees don't touch the shared pool. Declare
+ * one per thread, e.g. _Thread_local, initialized to all zero.
+ */
+typedef struct{
+    digi_pool_block_t * free;       // First block in the stash
+    uint32_t count;                 // Number of blocks in the stash
+}digi_pool_cache_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize a pool with every block free.
+ * 
+ * @param pool - the pool
+ * @param blocks - storage for the blocks
+ * @param count - number of blocks in storage
+ * @param block_size - DIGI_POOL_BLOCK_SIZE, so storage laid out by a caller built with a different value is
+ * caught before it's touched
+ * 
+ * @return digi_status_t - DIGI_ERROR if count is 0 or block_size isn't the value the driver was built with
+ */
+digi_status_t digi_pool_init(digi_pool_t * pool, digi_pool_block_t * blocks, uint32_t count, size_t block_size);
+
+/**
+ * @brief Take a block.
+ * 
+ * @param pool - the pool
+ * 
+ * @return uint8_t* - DIGI_POOL_BLOCK_SIZE bytes or NULL if every block is in use
+ */
+uint8_t * digi_pool_alloc(digi_pool_t * pool);
+
+/**
+ * @brief Give a block back. Any pointer into the block will do.
+ * 
+ * @param pool - the pool
+ * @param block - the block
+ * 
+ * @return digi_status_t - DIGI_ERROR if block isn't from this pool or is already free in it, and nothing is
+ * changed
+ */
+digi_status_t digi_pool_free(digi_pool_t * pool, const uint8_t * block);
+
+/**
+ * @brief Take a block through a thread's cache, refilling the cache from the pool a batch at a time.
+ * 
+ * @param cache - the calling thread's cache
+ * @param pool - the pool
+ * 
+ * @return uint8_t* - DIGI_POOL_BLOCK_SIZE bytes or NULL if every block is in use
+ */
+uint8_t * digi_pool_cache_alloc(digi_pool_cache_t * cache, digi_pool_t * pool);
+
+/**
+ * @brief Give a block back through a thread's cache, returning a batch to the pool when the cache is full.
+ * 
+ * @param cache - the calling thread's cache
+ * @param pool - the pool
+ * @param block - the block. Any pointer into the block will do.
+ * 
+ * @return digi_status_t - DIGI_ERROR if block isn't from this pool or is already in the cache, and nothing is
+ * changed
+ */
+digi_status_t digi_pool_cache_free(digi_pool_cache_t * cache, digi_pool_t * pool, const uint8_t * block);
+
+/**
+ * @brief Give every block in a thread's cache back to the pool, e.g. when the thread exits.
+ * 
+ * @param cache - the thread's cache
+ * @param pool - the pool
+ */
+void digi_pool_cache_drain(digi_pool_cache_t * cache, digi_pool_t * pool);
+
+/**
+ * @brief Number of blocks handed out, including those held by caches.
+ * 
+ * @param pool - the pool
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_pool_used(const digi_pool_t * pool);
+
+/**
+ * @brief Most blocks ever handed out at once.
+ * 
+ * @param pool - the pool
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_pool_high_water(const digi_pool_t * pool);
+
+/**
+ * @brief Number of allocations refused because the pool was empty.
+ * 
+ * @param pool - the pool
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_pool_failures(const digi_pool_t * pool);
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef DIGIMESH_REMOTE_H
+#define DIGIMESH_REMOTE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+#include "c_driver_digimesh_pending.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Most remote AT commands that can be in flight at once. See the readme for changing it.
+ */
+#ifndef DIGI_REMOTE_MAXIMUM_WINDOW
+#define DIGI_REMOTE_MAXIMUM_WINDOW 16
+#endif
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief One remote AT command to run.
+ */
+typedef struct{
+    digi_serial_t destination;  // The digi module to run the command on
+    digi_field_t field;         // The field to query or set
+    bool set;                   // Set the field to value rather than query it
+    uint32_t value;             // The value to set the field to
+    uint8_t options;            // Remote command options. 0x02 applies a set straight away.
+}digi_remote_request_t;
+
+/**
+ * @brief Called with the outcome of each request as it finishes, in whatever order they finish.
+ * 
+ * @param context - the context pointer given to digi_remote_init
+ * @param request - the request
+ * @param response - the response, which may report an error status. NULL if no response came after every
+ * attempt. Only valid for the duration of the call.
+ */
+typedef void (*digi_remote_callback_t)(void * context, const digi_remote_request_t * request, const digi_remote_at_response_t * response);
+
+/**
+ * @brief A request in flight.
+ */
+typedef struct{
+    digi_remote_request_t request;  // Copy of the request, so the caller's list can be replaced
+    uint32_t due;                   // When to send it, or when its response is overdue once sent
+    uint8_t attempts;               // Number of times it has been sent
+    uint8_t frame_id;               // Frame id of the last send
+    bool waiting;                   // Sent and waiting for its response
+    bool active;                    // The slot holds a request
+}digi_remote_slot_t;
+
+/**
+ * @brief Runs a list of remote AT commands with a window of them in flight at once, retrying with backoff
+ * when a response doesn't come. Allocate one per digi module and initialize it with digi_remote_init. The
+ * contents are private to the driver.
+ */
+typedef struct{
+    const digi_remote_request_t * requests;             // The caller's requests, not copied
+    size_t count;                                       // Number of requests
+    size_t next;                                        // Index of the next request to start
+    digi_remote_slot_t slots[DIGI_REMOTE_MAXIMUM_WINDOW];   // Requests in flight
+    digi_pending_t * pending;                           // Hands out frame ids and matches responses
+    digi_remote_callback_t callback;                    // Called with each outcome
+    void * context;                                     // Passed to callback
+    uint32_t timeout;                                   // How long to wait for a response
+    uint32_t backoff;                                   // Wait before the first retry, doubled for each one after
+    uint32_t now;                                       // Time of the last poll
+    uint8_t window;                                     // Most requests in flight
+    uint8_t attempts;                                   // Most times a request is sent
+    uint32_t retries;                                   // Number of times a request was sent again
+    uint32_t failures;                                  // Number of requests given up on
+}digi_remote_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize a remote AT engine with nothing to run.
+ * 
+ * @param remote - the engine
+ * @param pending - the digi module's pending table. Remote AT command responses must be handed to
+ * digi_pending_complete.
+ * @param window - most requests in flight at once, from 1 to DIGI_REMOTE_MAXIMUM_WINDOW
+ * @param attempts - most times a request is sent before giving up, at least 1
+ * @param timeout - how long to wait for a response, in the caller's time units
+ * @param backoff - how long to wait before the first retry, doubled for each retry after. Capped at
+ * UINT32_MAX / 2 so it can be compared across the caller's clock wrapping.
+ * @param callback - called with the outcome of each request
+ * @param context - passed to callback
+ * 
+ * @return digi_status_t - DIGI_ERROR if window or attempts is out of range
+ */
+digi_status_t digi_remote_init(digi_remote_t * remote, digi_pending_t * pending, uint8_t window, uint8_t attempts, uint32_t timeout, uint32_t backoff, digi_remote_callback_t callback, void * context);
+
+/**
+ * @brief Start running a list of requests. Each request is copied into the window as it starts, so requests
+ * still in flight from an earlier list carry on. Requests of an earlier list that haven't started yet are
+ * dropped.
+ * 
+ * @param remote - the engine
+ * @param requests - the requests, which must stay untouched until they have all started or the next
+ * digi_remote_start
+ * @param count - number of requests
+ */
+void digi_remote_start(digi_remote_t * remote, const digi_remote_request_t * requests, size_t count);
+
+/**
+ * @brief Move the requests along: give up waiting on every overdue response, then build the frames for every
+ * request due to be sent, back to back in message so they go out in one write. Call this periodically and
+ * whenever a response arrives.
+ * 
+ * @param remote - the engine
+ * @param message - buffer to write the frames into
+ * @param size - number of bytes available in message
+ * @param now - the current time, in the caller's time units
+ * 
+ * @return size_t - the number of bytes written to message, 0 if nothing is due
+ */
+size_t digi_remote_poll(digi_remote_t * remote, uint8_t * message, size_t size, uint32_t now);
+
+/**
+ * @brief Check whether every request has finished.
+ * 
+ * @param remote - the engine
+ * 
+ * @return true - nothing is left to run
+ * @return false - requests are in flight or still to start
+ */
+bool digi_remote_done(const digi_remote_t * remote);
+
+/**
+ * @brief Number of times a request was sent again.
+ * 
+ * @param remote - the engine
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_remote_retries(const digi_remote_t * remote);
+
+/**
+ * @brief Number of requests given up on without a response.
+ * 
+ * @param remote - the engine
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_remote_failures(const digi_remote_t * remote);
+
+#endif
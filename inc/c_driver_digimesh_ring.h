@@ -0,0 +1,117 @@
+#ifndef DIGIMESH_RING_H
+#define DIGIMESH_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief A single producer, single consumer byte ring. One context (e.g. a UART ISR or reader thread) pushes
+ * bytes and another drains them, without locks. The contents are private to the driver.
+ */
+typedef struct{
+    uint8_t * buffer;           // Caller supplied storage for the bytes
+    size_t mask;                // Size of the buffer minus one. The size is a power of two.
+    volatile size_t head;       // Total bytes ever written. Only the producer changes it.
+    volatile size_t tail;       // Total bytes ever read. Only the consumer changes it.
+    volatile uint32_t overruns; // Total bytes dropped because the ring was full. Only the producer changes it.
+}digi_ring_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize an empty ring over caller supplied storage.
+ * 
+ * @param ring - the ring to initialize
+ * @param buffer - storage for the bytes. It must outlive the ring.
+ * @param size - number of bytes in buffer. Must be a power of two.
+ * 
+ * @return digi_status_t - DIGI_ERROR if size isn't a power of two
+ */
+digi_status_t digi_ring_init(digi_ring_t * ring, uint8_t * buffer, size_t size);
+
+/**
+ * @brief Producer side. Copy bytes into the ring. Bytes that don't fit are dropped and counted as overruns.
+ * 
+ * @param ring - the ring
+ * @param bytes - the bytes to add
+ * @param size - number of bytes to add
+ * 
+ * @return size_t - the number of bytes stored
+ */
+size_t digi_ring_push(digi_ring_t * ring, const uint8_t * bytes, size_t size);
+
+/**
+ * @brief Producer side. Get the largest contiguous free region so bytes can be written straight into the
+ * ring, e.g. by read(). Follow with digi_ring_write_commit.
+ * 
+ * @param ring - the ring
+ * @param region - populated with the start of the free region
+ * 
+ * @return size_t - the number of bytes that can be written at region
+ */
+size_t digi_ring_write_peek(digi_ring_t * ring, uint8_t ** region);
+
+/**
+ * @brief Producer side. Publish bytes written into the region returned by digi_ring_write_peek.
+ * 
+ * @param ring - the ring
+ * @param size - number of bytes written. Must not exceed what digi_ring_write_peek returned.
+ */
+void digi_ring_write_commit(digi_ring_t * ring, size_t size);
+
+/**
+ * @brief Producer side. Count bytes that were received but couldn't be stored, for producers that write
+ * through digi_ring_write_peek.
+ * 
+ * @param ring - the ring
+ * @param size - number of bytes dropped
+ */
+void digi_ring_record_overrun(digi_ring_t * ring, size_t size);
+
+/**
+ * @brief Consumer side. Get the oldest contiguous region of unread bytes so they can be parsed in place.
+ * When the unread bytes wrap around the end of the buffer this only returns the part before the wrap, the
+ * rest is returned by the next peek after a commit. Follow with digi_ring_read_commit.
+ * 
+ * @param ring - the ring
+ * @param region - populated with the start of the unread bytes
+ * 
+ * @return size_t - the number of bytes that can be read at region
+ */
+size_t digi_ring_read_peek(const digi_ring_t * ring, const uint8_t ** region);
+
+/**
+ * @brief Consumer side. Release bytes returned by digi_ring_read_peek back to the producer.
+ * 
+ * @param ring - the ring
+ * @param size - number of bytes finished with. Must not exceed what digi_ring_read_peek returned.
+ */
+void digi_ring_read_commit(digi_ring_t * ring, size_t size);
+
+/**
+ * @brief Number of unread bytes in the ring. Exact from the consumer, a lower bound from the producer.
+ * 
+ * @param ring - the ring
+ * 
+ * @return size_t 
+ */
+size_t digi_ring_used(const digi_ring_t * ring);
+
+/**
+ * @brief Total number of bytes dropped because the ring was full.
+ * 
+ * @param ring - the ring
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_ring_overruns(const digi_ring_t * ring);
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef DIGIMESH_SNAPSHOT_H
+#define DIGIMESH_SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+#include "c_driver_digimesh_cache.h"
+#include "c_driver_digimesh_nodes.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Layout version written into snapshots. Snapshots of any other version are refused.
+ */
+#define DIGI_SNAPSHOT_VERSION 1
+
+/**
+ * @brief Bytes in a snapshot before the first record.
+ */
+#define DIGI_SNAPSHOT_HEADER_SIZE 32
+
+/**
+ * @brief Bytes per cached field value in a snapshot.
+ */
+#define DIGI_SNAPSHOT_FIELD_SIZE 8
+
+/**
+ * @brief Bytes per remote node in a snapshot.
+ */
+#define DIGI_SNAPSHOT_NODE_SIZE 16
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Number of bytes a snapshot of this state takes, for sizing the buffer given to digi_snapshot_save.
+ * 
+ * @param cache - the digi module's parameter cache. May be NULL.
+ * @param nodes - the digi module's remote nodes. May be NULL.
+ * 
+ * @return size_t 
+ */
+size_t digi_snapshot_size(const digi_cache_t * cache, const digi_node_table_t * nodes);
+
+/**
+ * @brief Write a digi module's state to a versioned, checksummed blob that can be stored and loaded back
+ * with digi_snapshot_load after a restart. Fields are stored by their 2 character code and every number is
+ * little endian, so snapshots stay valid across builds and machines. Every record is 8 byte aligned so a
+ * snapshot can be loaded straight from a memory mapped file.
+ * 
+ * @param buffer - where to write the snapshot
+ * @param size - number of bytes available in buffer
+ * @param digi - the digi module
+ * @param cache - the cached parameter values to keep. May be NULL.
+ * @param nodes - the remote nodes to keep. May be NULL.
+ * 
+ * @return size_t - the number of bytes written or 0 if it doesn't fit
+ */
+size_t digi_snapshot_save(uint8_t * buffer, size_t size, const digi_t * digi, const digi_cache_t * cache, const digi_node_table_t * nodes);
+
+/**
+ * @brief Restore a digi module's state from a snapshot. Nothing is changed unless the whole snapshot is
+ * valid. Restored values and nodes should be treated as a starting point and revalidated with the digi
+ * module and the mesh.
+ * 
+ * @param buffer - the snapshot
+ * @param size - number of bytes in buffer
+ * @param digi - the digi module to restore the serial number of
+ * @param cache - an initialized cache to fill. May be NULL to skip the parameter values.
+ * @param nodes - an initialized node table to add the nodes to. May be NULL to skip the nodes.
+ * 
+ * @return digi_status_t - DIGI_ERROR if the snapshot is truncated, corrupt or a different version, or the
+ * node table is too small
+ */
+digi_status_t digi_snapshot_load(const uint8_t * buffer, size_t size, digi_t * digi, digi_cache_t * cache, digi_node_table_t * nodes);
+
+#endif
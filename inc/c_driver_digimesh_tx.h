@@ -0,0 +1,151 @@
+#ifndef DIGIMESH_TX_H
+#define DIGIMESH_TX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+#include "c_driver_digimesh_pool.h"
+
+/**********************/
+/* PUBLIC DEFINITIONS */
+/**********************/
+
+/**
+ * @brief Most frames a TX queue holds. A full queue is flushed in one write. See the readme for changing it.
+ */
+#ifndef DIGI_TX_MAXIMUM_FRAMES
+#define DIGI_TX_MAXIMUM_FRAMES 16
+#endif
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief Writes a batch of encoded frames to the digi module in one go, e.g. with writev. Writing only part
+ * of the batch is fine, whatever is left stays queued.
+ * 
+ * @param context - the context pointer given to digi_tx_init
+ * @param frames - the frames, in the order they're to be sent. The first may be the tail of a frame that was
+ * partly written before.
+ * @param count - number of frames
+ * @param written - populated with the number of bytes written
+ * 
+ * @return digi_status_t - DIGI_ERROR if the write failed
+ */
+typedef digi_status_t (*digi_tx_write_t)(void * context, const digi_payload_t * frames, size_t count, size_t * written);
+
+/**
+ * @brief Collects encoded frames and hands them to the writer in batches. Allocate one per digi module and
+ * initialize it with digi_tx_init. The contents are private to the driver.
+ */
+typedef struct{
+    digi_payload_t frames[DIGI_TX_MAXIMUM_FRAMES];      // Queued frames, oldest first
+    size_t count;                                       // Number of frames queued
+    size_t bytes;                                       // Number of bytes queued
+    size_t byte_threshold;                              // Flush once this many bytes are queued
+    uint32_t deadline;                                  // Flush once the oldest frame has waited this long
+    uint32_t oldest;                                    // When the oldest queued frame was queued
+    digi_tx_write_t write;                              // Sends a batch
+    void * context;                                     // Passed to write
+    digi_pool_t * pool;                                 // Frames are given back to this pool once sent. May be NULL.
+    uint32_t batches[DIGI_TX_MAXIMUM_FRAMES + 1];       // Number of writes that got bytes out, indexed by frames completed
+    uint32_t frames_sent;                               // Number of frames written in full
+}digi_tx_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Initialize an empty TX queue.
+ * 
+ * @param tx - the TX queue
+ * @param maximum_frames - DIGI_TX_MAXIMUM_FRAMES, so a caller built with a different value is caught before
+ * the queue is touched
+ * @param write - sends a batch of frames
+ * @param context - passed to write
+ * @param byte_threshold - flush once this many bytes are queued
+ * @param deadline - flush once the oldest frame has waited this long, in the caller's time units
+ * 
+ * @return digi_status_t - DIGI_ERROR if maximum_frames isn't the value the driver was built with
+ */
+digi_status_t digi_tx_init(digi_tx_t * tx, size_t maximum_frames, digi_tx_write_t write, void * context, size_t byte_threshold, uint32_t deadline);
+
+/**
+ * @brief Give every frame back to a pool once it has been written in full, so frames can be built straight
+ * into blocks from digi_pool_alloc and forgotten once queued.
+ * 
+ * @param tx - the TX queue
+ * @param pool - the pool the queued frames come from. NULL to stop giving frames back.
+ */
+void digi_tx_set_pool(digi_tx_t * tx, digi_pool_t * pool);
+
+/**
+ * @brief Queue an encoded frame. The queue is flushed when it fills up or crosses its byte threshold. Frames
+ * aren't copied so the frame must stay untouched until digi_tx_pending shows it has been sent.
+ * 
+ * @param tx - the TX queue
+ * @param frame - the encoded frame
+ * @param size - size of the frame in bytes
+ * @param now - the current time, in the caller's time units
+ * 
+ * @return digi_status_t - DIGI_OK once the frame is queued, even if the flush it set off failed. The frame
+ * stays queued and goes out with the next flush, so it must not be queued again. DIGI_ERROR if the queue is
+ * full and couldn't be flushed, in which case the frame wasn't queued.
+ */
+digi_status_t digi_tx_queue(digi_tx_t * tx, const uint8_t * frame, size_t size, uint32_t now);
+
+/**
+ * @brief Flush the queue if its oldest frame has passed the deadline. Call this periodically, e.g. whenever
+ * the event loop wakes up.
+ * 
+ * @param tx - the TX queue
+ * @param now - the current time, in the caller's time units
+ * 
+ * @return digi_status_t - DIGI_ERROR if the write failed
+ */
+digi_status_t digi_tx_poll(digi_tx_t * tx, uint32_t now);
+
+/**
+ * @brief Hand every queued frame to the writer in one write. Frames the writer doesn't take stay queued.
+ * 
+ * @param tx - the TX queue
+ * 
+ * @return digi_status_t - DIGI_ERROR if the write failed
+ */
+digi_status_t digi_tx_flush(digi_tx_t * tx);
+
+/**
+ * @brief Number of frames queued, including one that has been partly written.
+ * 
+ * @param tx - the TX queue
+ * 
+ * @return size_t 
+ */
+size_t digi_tx_pending(const digi_tx_t * tx);
+
+/**
+ * @brief Number of writes that got bytes out and completed a given number of frames. Writes that got nothing
+ * out, e.g. on a congested port, aren't counted.
+ * 
+ * @param tx - the TX queue
+ * @param frames - the number of frames completed, from 0 for writes that only got part of a frame out, to
+ * DIGI_TX_MAXIMUM_FRAMES
+ * 
+ * @return uint32_t - 0 if frames is out of range
+ */
+uint32_t digi_tx_batches(const digi_tx_t * tx, size_t frames);
+
+/**
+ * @brief Number of frames written in full.
+ * 
+ * @param tx - the TX queue
+ * 
+ * @return uint32_t 
+ */
+uint32_t digi_tx_frames_sent(const digi_tx_t * tx);
+
+#endif
@@ -0,0 +1,262 @@
+#include "c_driver_digimesh_aggregate.h"
+
+#include <string.h>
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Send a destination's messages and free its slot. The slot keeps its messages if the send fails.
+ * 
+ * @param aggregate - the aggregator
+ * @param slot - the destination's slot
+ * 
+ * @return digi_status_t - the send's status
+ */
+static digi_status_t digi_aggregate_send(digi_aggregate_t * aggregate, digi_aggregate_slot_t * slot);
+
+/**
+ * @brief Find the slot for a destination, taking a free one or sending the most urgent destination if it
+ * has none.
+ * 
+ * @param aggregate - the aggregator
+ * @param destination - the destination
+ * 
+ * @return digi_aggregate_slot_t* - NULL if every slot is in use and sending one failed
+ */
+static digi_aggregate_slot_t * digi_aggregate_claim(digi_aggregate_t * aggregate, const digi_serial_t * destination);
+
+/**
+ * @brief Check whether one time comes before another.
+ * 
+ * @param first - a time
+ * @param second - another time
+ * 
+ * @return true - first is before second
+ * @return false - first is at or after second
+ */
+static bool digi_aggregate_before(uint32_t first, uint32_t second);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static digi_status_t digi_aggregate_send(digi_aggregate_t * aggregate, digi_aggregate_slot_t * slot)
+{
+    if(aggregate->send(aggregate->context, &slot->destination, slot->buffer, slot->length) != DIGI_OK)
+    {
+        return DIGI_ERROR;
+    }
+
+    slot->active = false;
+    aggregate->payloads++;
+
+    return DIGI_OK;
+}
+
+static digi_aggregate_slot_t * digi_aggregate_claim(digi_aggregate_t * aggregate, const digi_serial_t * destination)
+{
+    digi_aggregate_slot_t * free_slot = NULL;
+    digi_aggregate_slot_t * earliest = NULL;
+
+    for(uint32_t idx = 0; idx < aggregate->slot_count; idx++)
+    {
+        digi_aggregate_slot_t * slot = &aggregate->slots[idx];
+
+        if(!slot->active)
+        {
+            if(free_slot == NULL)
+            {
+                free_slot = slot;
+            }
+            continue;
+        }
+
+        if(memcmp(slot->destination.serial, destination->serial, DIGI_SERIAL_LENGTH) == 0)
+        {
+            return slot;
+        }
+
+        if(earliest == NULL || digi_aggregate_before(slot->deadline, earliest->deadline))
+        {
+            earliest = slot;
+        }
+    }
+
+    // The most urgent destination loses least by going out early, the others keep gathering messages
+    if(free_slot == NULL)
+    {
+        if(digi_aggregate_send(aggregate, earliest) != DIGI_OK)
+        {
+            return NULL;
+        }
+        free_slot = earliest;
+    }
+
+    return free_slot;
+}
+
+static bool digi_aggregate_before(uint32_t first, uint32_t second)
+{
+    // Unsigned subtraction keeps working when the caller's clock wraps
+    return (uint32_t)(second - first) - 1 < UINT32_MAX / 2;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+digi_status_t digi_aggregate_init(digi_aggregate_t * aggregate, digi_aggregate_slot_t * slots, uint32_t slot_count, uint8_t * buffers, size_t maximum_payload, digi_aggregate_send_t send, void * context)
+{
+    // Every slot needs room for at least an empty message, and the buffers must be addressable
+    if(slots == NULL || buffers == NULL || slot_count == 0 || maximum_payload < DIGI_AGGREGATE_HEADER_SIZE || maximum_payload > SIZE_MAX / slot_count)
+    {
+        return DIGI_ERROR;
+    }
+
+    memset(aggregate, 0, sizeof(*aggregate));
+    aggregate->slots = slots;
+    aggregate->slot_count = slot_count;
+    aggregate->maximum_payload = maximum_payload;
+    aggregate->send = send;
+    aggregate->context = context;
+
+    for(uint32_t idx = 0; idx < slot_count; idx++)
+    {
+        memset(&slots[idx], 0, sizeof(slots[idx]));
+        slots[idx].buffer = &buffers[idx * maximum_payload];
+    }
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_aggregate_queue(digi_aggregate_t * aggregate, const digi_serial_t * destination, const uint8_t * data, size_t length, uint32_t latency, uint32_t now)
+{
+    size_t packed = DIGI_AGGREGATE_HEADER_SIZE + length;
+
+    if(length > DIGI_AGGREGATE_MAXIMUM_MESSAGE || packed > aggregate->maximum_payload)
+    {
+        return DIGI_ERROR;
+    }
+
+    digi_aggregate_slot_t * slot = digi_aggregate_claim(aggregate, destination);
+    uint32_t deadline = now + latency;
+
+    if(slot == NULL)
+    {
+        return DIGI_ERROR;
+    }
+
+    if(slot->active && slot->length + packed > aggregate->maximum_payload)
+    {
+        if(digi_aggregate_send(aggregate, slot) != DIGI_OK)
+        {
+            return DIGI_ERROR;
+        }
+    }
+
+    if(!slot->active)
+    {
+        slot->destination = *destination;
+        slot->length = 0;
+        slot->deadline = deadline;
+        slot->active = true;
+    }
+    else if(digi_aggregate_before(deadline, slot->deadline))
+    {
+        slot->deadline = deadline;
+    }
+
+    slot->buffer[slot->length] = (uint8_t)length;
+    if(length > 0)
+    {
+        memcpy(&slot->buffer[slot->length + DIGI_AGGREGATE_HEADER_SIZE], data, length);
+    }
+    slot->length += packed;
+    aggregate->messages++;
+
+    // Send straight away once not even an empty message fits after these. If that fails the message is still
+    // queued, and goes out with the next poll or the next message for this destination.
+    if(slot->length + DIGI_AGGREGATE_HEADER_SIZE > aggregate->maximum_payload)
+    {
+        (void)digi_aggregate_send(aggregate, slot);
+    }
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_aggregate_poll(digi_aggregate_t * aggregate, uint32_t now)
+{
+    digi_status_t status = DIGI_OK;
+
+    for(uint32_t idx = 0; idx < aggregate->slot_count; idx++)
+    {
+        digi_aggregate_slot_t * slot = &aggregate->slots[idx];
+
+        if(slot->active && !digi_aggregate_before(now, slot->deadline))
+        {
+            if(digi_aggregate_send(aggregate, slot) != DIGI_OK)
+            {
+                status = DIGI_ERROR;
+            }
+        }
+    }
+
+    return status;
+}
+
+digi_status_t digi_aggregate_flush(digi_aggregate_t * aggregate)
+{
+    digi_status_t status = DIGI_OK;
+
+    for(uint32_t idx = 0; idx < aggregate->slot_count; idx++)
+    {
+        if(aggregate->slots[idx].active)
+        {
+            if(digi_aggregate_send(aggregate, &aggregate->slots[idx]) != DIGI_OK)
+            {
+                status = DIGI_ERROR;
+            }
+        }
+    }
+
+    return status;
+}
+
+digi_status_t digi_aggregate_split(const digi_receive_packet_t * packet, digi_aggregate_receive_t receive, void * context)
+{
+    size_t offset = 0;
+
+    // Check every length before delivering anything so a damaged payload isn't half delivered
+    while(offset < packet->length)
+    {
+        offset += DIGI_AGGREGATE_HEADER_SIZE + packet->payload[offset];
+    }
+
+    if(offset != packet->length)
+    {
+        return DIGI_ERROR;
+    }
+
+    offset = 0;
+    while(offset < packet->length)
+    {
+        size_t length = packet->payload[offset];
+
+        receive(context, &packet->source, &packet->payload[offset + DIGI_AGGREGATE_HEADER_SIZE], length);
+        offset += DIGI_AGGREGATE_HEADER_SIZE + length;
+    }
+
+    return DIGI_OK;
+}
+
+uint32_t digi_aggregate_messages(const digi_aggregate_t * aggregate)
+{
+    return aggregate->messages;
+}
+
+uint32_t digi_aggregate_payloads(const digi_aggregate_t * aggregate)
+{
+    return aggregate->payloads;
+}
@@ -0,0 +1,187 @@
+#include "c_driver_digimesh_cache.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Widest value that is cached, the width of a uint32_t.
+ */
+#define DIGI_CACHE_MAXIMUM_WIDTH 4
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Check whether a command may change every field.
+ * 
+ * @param field - the command
+ * 
+ * @return true - AC, RE or FR
+ * @return false - anything else
+ */
+static bool digi_cache_changes_everything(digi_field_t field);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static bool digi_cache_changes_everything(digi_field_t field)
+{
+    return field == DIGI_FIELD_AC || field == DIGI_FIELD_RE || field == DIGI_FIELD_FR;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+void digi_cache_init(digi_cache_t * cache)
+{
+    memset(cache, 0, sizeof(*cache));
+    cache->generation = 1;
+
+    return;
+}
+
+digi_status_t digi_cache_get(digi_cache_t * cache, digi_field_t field, uint32_t * value)
+{
+    if(field >= DIGI_FIELD_END || cache->generations[field] != cache->generation)
+    {
+        cache->misses++;
+        return DIGI_ERROR;
+    }
+
+    cache->hits++;
+    *value = cache->values[field];
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_cache_read(digi_cache_t * cache, digi_field_t field, uint32_t * value, uint8_t * message, size_t size, uint8_t frame_id, size_t * written)
+{
+    *written = 0;
+
+    if(digi_cache_get(cache, field, value) == DIGI_OK)
+    {
+        return DIGI_OK;
+    }
+
+    // Asking for a field that is never cached would miss again on every read
+    if(field < DIGI_FIELD_END && digi_field_info(field)->width <= DIGI_CACHE_MAXIMUM_WIDTH)
+    {
+        *written = digi_generate_get_field_message(message, size, frame_id, field);
+    }
+
+    return DIGI_ERROR;
+}
+
+void digi_cache_frame(void * context, const digi_frame_view_t * frame)
+{
+    digi_cache_t * cache = context;
+    digi_at_response_t response;
+
+    if(frame->type == DIGI_FRAME_MODEM_STATUS)
+    {
+        if(frame->length > 0 && (frame->data[0] == DIGI_MODEM_STATUS_HARDWARE_RESET || frame->data[0] == DIGI_MODEM_STATUS_WATCHDOG_RESET))
+        {
+            digi_cache_invalidate_all(cache);
+        }
+        return;
+    }
+
+    if(digi_decode_at_response(frame, &response) != DIGI_OK || response.status != 0 || response.field == DIGI_FIELD_END)
+    {
+        return;
+    }
+
+    if(digi_cache_changes_everything(response.field))
+    {
+        digi_cache_invalidate_all(cache);
+        return;
+    }
+
+    // Responses to sets carry no value. Strings and other wide fields aren't cached, even when short.
+    if(response.length == 0 || response.length > DIGI_CACHE_MAXIMUM_WIDTH || digi_field_info(response.field)->width > DIGI_CACHE_MAXIMUM_WIDTH)
+    {
+        return;
+    }
+
+    uint32_t value = 0;
+    for(uint16_t idx = 0; idx < response.length; idx++)
+    {
+        value = (value << 8) | response.value[idx];
+    }
+
+    cache->values[response.field] = value;
+    cache->generations[response.field] = cache->generation;
+
+    return;
+}
+
+void digi_cache_sent(digi_cache_t * cache, const uint8_t * message, size_t size)
+{
+    size_t offset = 0;
+
+    while(offset + DIGI_FRAME_HEADER_SIZE + DIGI_LOCAL_AT_SIZE < size)
+    {
+        const uint8_t * data = &message[offset + DIGI_FRAME_HEADER_SIZE];
+        uint16_t length = (uint16_t)((message[offset + 1] << 8) | message[offset + 2]);
+
+        if((data[0] == DIGI_FRAME_LOCAL_AT || data[0] == DIGI_FRAME_LOCAL_AT_QUEUE) && length >= DIGI_LOCAL_AT_SIZE)
+        {
+            digi_field_t field = digi_field_from_code(&data[2]);
+
+            if(digi_cache_changes_everything(field))
+            {
+                digi_cache_invalidate_all(cache);
+            }
+            else if(length > DIGI_LOCAL_AT_SIZE)
+            {
+                // A command with a value sets the field
+                digi_cache_invalidate(cache, field);
+            }
+        }
+
+        // Step over the header, frame data and checksum
+        offset += DIGI_FRAME_OVERHEAD + (size_t)length;
+    }
+
+    return;
+}
+
+void digi_cache_invalidate(digi_cache_t * cache, digi_field_t field)
+{
+    if(field < DIGI_FIELD_END)
+    {
+        cache->generations[field] = 0;
+    }
+
+    return;
+}
+
+void digi_cache_invalidate_all(digi_cache_t * cache)
+{
+    // Moving to a new generation makes every value stale at once. Only when the generation wraps do the
+    // old ones need clearing so none of them come back to life.
+    cache->generation++;
+    if(cache->generation == 0)
+    {
+        memset(cache->generations, 0, sizeof(cache->generations));
+        cache->generation = 1;
+    }
+
+    return;
+}
+
+uint32_t digi_cache_hits(const digi_cache_t * cache)
+{
+    return cache->hits;
+}
+
+uint32_t digi_cache_misses(const digi_cache_t * cache)
+{
+    return cache->misses;
+}
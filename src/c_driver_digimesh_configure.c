@@ -0,0 +1,98 @@
+#include "c_driver_digimesh_configure.h"
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Status while there is no response to report.
+ */
+#define DIGI_CONFIGURE_NO_STATUS 0xFF
+
+/**
+ * @brief Status reported when the response doesn't decode, the digi module's generic error.
+ */
+#define DIGI_CONFIGURE_MALFORMED 0x01
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Handle the AC's response. Matches digi_pending_callback_t.
+ * 
+ * @param context - the batch
+ * @param frame - the response
+ */
+static void digi_configure_response(void * context, const digi_frame_view_t * frame);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static void digi_configure_response(void * context, const digi_frame_view_t * frame)
+{
+    digi_configure_t * configure = context;
+    digi_at_response_t response;
+
+    // The pending table has already freed the frame id so the batch is over either way
+    configure->waiting = false;
+
+    if(digi_decode_at_response(frame, &response) != DIGI_OK)
+    {
+        configure->status = DIGI_CONFIGURE_MALFORMED;
+        return;
+    }
+
+    configure->status = response.status;
+
+    return;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+size_t digi_configure_start(digi_configure_t * configure, digi_pending_t * pending, uint8_t * message, size_t size, const digi_setting_t * settings, size_t count)
+{
+    configure->pending = pending;
+    configure->status = DIGI_CONFIGURE_NO_STATUS;
+    configure->waiting = false;
+
+    if(digi_pending_add(pending, digi_configure_response, configure, &configure->frame_id) != DIGI_OK)
+    {
+        return 0;
+    }
+
+    size_t written = digi_generate_configuration(message, size, configure->frame_id, settings, count);
+    if(written == 0)
+    {
+        digi_pending_cancel(pending, configure->frame_id);
+        return 0;
+    }
+
+    configure->waiting = true;
+
+    return written;
+}
+
+bool digi_configure_done(const digi_configure_t * configure)
+{
+    return !configure->waiting;
+}
+
+uint8_t digi_configure_status(const digi_configure_t * configure)
+{
+    return configure->status;
+}
+
+void digi_configure_cancel(digi_configure_t * configure)
+{
+    if(configure->waiting)
+    {
+        digi_pending_cancel(configure->pending, configure->frame_id);
+        configure->waiting = false;
+    }
+
+    return;
+}
@@ -0,0 +1,320 @@
+#include "c_driver_digimesh_delivery.h"
+#include "c_driver_digimesh_nodes.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Marks a request whose destination didn't fit in the node table.
+ */
+#define DIGI_DELIVERY_NO_LINK UINT32_MAX
+
+/**
+ * @brief Discovery status reported for extended timeout discovery.
+ */
+#define DIGI_DELIVERY_EXTENDED_TIMEOUT 0x40
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Stop waiting on a request and take it off its destination's count of pending transmissions.
+ * 
+ * @param delivery - the tracker
+ * @param request - the request
+ * 
+ * @return digi_delivery_link_t* - the destination's link, NULL if it isn't tracked
+ */
+static digi_delivery_link_t * digi_delivery_release(digi_delivery_t * delivery, digi_delivery_request_t * request);
+
+/**
+ * @brief Record a transmit status against its request. Matches digi_pending_callback_t.
+ * 
+ * @param context - the tracker
+ * @param frame - the transmit status
+ */
+static void digi_delivery_status(void * context, const digi_frame_view_t * frame);
+
+/**
+ * @brief Which histogram bucket a value goes in, by its number of significant bits.
+ * 
+ * @param value - the value
+ * 
+ * @return uint8_t 
+ */
+static uint8_t digi_delivery_bucket(uint32_t value);
+
+/**
+ * @brief Which discovery histogram bucket a discovery status goes in.
+ * 
+ * @param discovery - the discovery status from a transmit status
+ * 
+ * @return digi_delivery_discovery_t 
+ */
+static digi_delivery_discovery_t digi_delivery_discovery(uint8_t discovery);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static digi_delivery_link_t * digi_delivery_release(digi_delivery_t * delivery, digi_delivery_request_t * request)
+{
+    request->active = false;
+
+    if(request->link == DIGI_DELIVERY_NO_LINK)
+    {
+        return NULL;
+    }
+
+    digi_node_t * node = &delivery->nodes.nodes[request->link];
+
+    if(node->pending_tx > 0)
+    {
+        node->pending_tx--;
+    }
+
+    return &delivery->links[request->link];
+}
+
+static void digi_delivery_status(void * context, const digi_frame_view_t * frame)
+{
+    digi_delivery_t * delivery = context;
+    digi_transmit_status_t status;
+
+    // The pending table has matched the frame id so it's there even if the rest doesn't decode
+    digi_delivery_request_t * request = &delivery->requests[frame->data[0]];
+    digi_delivery_link_t * link = digi_delivery_release(delivery, request);
+
+    if(link == NULL)
+    {
+        delivery->untracked++;
+        return;
+    }
+
+    if(digi_decode_transmit_status(frame, &status) != DIGI_OK)
+    {
+        link->failed++;
+        return;
+    }
+
+    link->latency[digi_delivery_bucket(delivery->now - request->sent)]++;
+    link->retries[status.retries < DIGI_DELIVERY_RETRY_BUCKETS ? status.retries : DIGI_DELIVERY_RETRY_BUCKETS - 1]++;
+    link->discovery[digi_delivery_discovery(status.discovery)]++;
+
+    if(status.delivery == 0)
+    {
+        link->delivered++;
+    }
+    else
+    {
+        link->failed++;
+    }
+
+    return;
+}
+
+static uint8_t digi_delivery_bucket(uint32_t value)
+{
+    uint8_t bucket = 0;
+
+    while(value != 0 && bucket < DIGI_DELIVERY_LATENCY_BUCKETS - 1)
+    {
+        value >>= 1;
+        bucket++;
+    }
+
+    return bucket;
+}
+
+static digi_delivery_discovery_t digi_delivery_discovery(uint8_t discovery)
+{
+    switch(discovery)
+    {
+        case 0x00:
+            return DIGI_DELIVERY_DISCOVERY_NONE;
+
+        case 0x01:
+            return DIGI_DELIVERY_DISCOVERY_ADDRESS;
+
+        case 0x02:
+            return DIGI_DELIVERY_DISCOVERY_ROUTE;
+
+        case 0x03:
+            return DIGI_DELIVERY_DISCOVERY_ADDRESS_AND_ROUTE;
+
+        case DIGI_DELIVERY_EXTENDED_TIMEOUT:
+            return DIGI_DELIVERY_DISCOVERY_EXTENDED_TIMEOUT;
+
+        default:
+            return DIGI_DELIVERY_DISCOVERY_OTHER;
+    }
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+digi_status_t digi_delivery_init(digi_delivery_t * delivery, digi_pending_t * pending, digi_node_t * nodes, digi_delivery_link_t * links, uint32_t capacity)
+{
+    if(digi_nodes_init(&delivery->nodes, nodes, capacity) != DIGI_OK)
+    {
+        return DIGI_ERROR;
+    }
+
+    memset(links, 0, capacity * sizeof(links[0]));
+    memset(delivery->requests, 0, sizeof(delivery->requests));
+    delivery->pending = pending;
+    delivery->links = links;
+    delivery->now = 0;
+    delivery->untracked = 0;
+
+    return DIGI_OK;
+}
+
+size_t digi_delivery_generate(digi_delivery_t * delivery, uint8_t * message, size_t size, const digi_serial_t * destination, uint8_t options, const digi_payload_t * payload, size_t count, uint32_t now, uint8_t * frame_id)
+{
+    if(digi_pending_add(delivery->pending, digi_delivery_status, delivery, frame_id) != DIGI_OK)
+    {
+        return 0;
+    }
+
+    size_t written = digi_generate_transmit_request(message, size, *frame_id, destination, options, payload, count);
+    if(written == 0)
+    {
+        digi_pending_cancel(delivery->pending, *frame_id);
+        return 0;
+    }
+
+    uint64_t key = digi_serial_to_key(destination);
+    digi_node_t * node = digi_nodes_insert(&delivery->nodes, key);
+    digi_delivery_request_t * request = &delivery->requests[*frame_id];
+
+    request->sent = now;
+    request->link = DIGI_DELIVERY_NO_LINK;
+    request->active = true;
+
+    // Nodes are never evicted from this table so a slot index stays with its destination
+    if(node != NULL)
+    {
+        request->link = (uint32_t)(node - delivery->nodes.nodes);
+        delivery->links[request->link].key = key;
+        node->pending_tx++;
+    }
+
+    return written;
+}
+
+digi_status_t digi_delivery_complete(digi_delivery_t * delivery, const digi_frame_view_t * frame, uint32_t now)
+{
+    if(frame->type != DIGI_FRAME_TRANSMIT_STATUS)
+    {
+        return DIGI_ERROR;
+    }
+
+    delivery->now = now;
+
+    return digi_pending_complete(delivery->pending, frame);
+}
+
+digi_status_t digi_delivery_cancel(digi_delivery_t * delivery, uint8_t frame_id)
+{
+    if(!delivery->requests[frame_id].active)
+    {
+        return DIGI_ERROR;
+    }
+
+    digi_pending_cancel(delivery->pending, frame_id);
+    digi_delivery_release(delivery, &delivery->requests[frame_id]);
+
+    return DIGI_OK;
+}
+
+void digi_delivery_poll(digi_delivery_t * delivery, uint32_t now, uint32_t timeout)
+{
+    for(uint16_t frame_id = 1; frame_id < DIGI_PENDING_SLOTS; frame_id++)
+    {
+        digi_delivery_request_t * request = &delivery->requests[frame_id];
+
+        if(!request->active || (uint32_t)(now - request->sent) < timeout)
+        {
+            continue;
+        }
+
+        digi_pending_cancel(delivery->pending, (uint8_t)frame_id);
+
+        // A transmit status that never came is as good as a failed delivery
+        digi_delivery_link_t * link = digi_delivery_release(delivery, request);
+        if(link != NULL)
+        {
+            link->failed++;
+        }
+        else
+        {
+            delivery->untracked++;
+        }
+    }
+
+    return;
+}
+
+const digi_delivery_link_t * digi_delivery_link(digi_delivery_t * delivery, const digi_serial_t * destination)
+{
+    const digi_node_t * node = digi_nodes_find(&delivery->nodes, digi_serial_to_key(destination));
+
+    return (node != NULL) ? &delivery->links[node - delivery->nodes.nodes] : NULL;
+}
+
+const digi_delivery_link_t * digi_delivery_next(const digi_delivery_t * delivery, uint32_t * cursor)
+{
+    while(*cursor <= delivery->nodes.mask)
+    {
+        uint32_t slot = (*cursor)++;
+
+        if(delivery->nodes.nodes[slot].used)
+        {
+            return &delivery->links[slot];
+        }
+    }
+
+    return NULL;
+}
+
+uint32_t digi_delivery_latency_percentile(const digi_delivery_link_t * link, uint8_t percent)
+{
+    uint64_t total = 0;
+
+    for(uint8_t bucket = 0; bucket < DIGI_DELIVERY_LATENCY_BUCKETS; bucket++)
+    {
+        total += link->latency[bucket];
+    }
+
+    if(total == 0)
+    {
+        return 0;
+    }
+
+    // The first bucket whose running count reaches the wanted share of the total
+    uint64_t wanted = (total * percent + 99) / 100;
+    uint64_t seen = 0;
+
+    for(uint8_t bucket = 0; bucket < DIGI_DELIVERY_LATENCY_BUCKETS - 1; bucket++)
+    {
+        seen += link->latency[bucket];
+
+        if(seen >= wanted)
+        {
+            return (bucket == 0) ? 0 : (uint32_t)((1ull << bucket) - 1);
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+uint32_t digi_delivery_untracked(const digi_delivery_t * delivery)
+{
+    return delivery->untracked;
+}
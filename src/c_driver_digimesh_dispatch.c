@@ -0,0 +1,98 @@
+#include "c_driver_digimesh_dispatch.h"
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Sits in every slot with no registered handler so dispatching never has to check for one. The
+ * frame is counted as unhandled by digi_dispatch_frame.
+ * 
+ * @param context - unused
+ * @param frame - the frame being dropped
+ */
+static void digi_dispatch_drop(void * context, const digi_frame_view_t * frame);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static void digi_dispatch_drop(void * context, const digi_frame_view_t * frame)
+{
+    return;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+void digi_dispatch_init(digi_dispatch_t * dispatch)
+{
+    for(uint16_t type = 0; type < DIGI_DISPATCH_SLOTS; type++)
+    {
+        digi_dispatch_unregister(dispatch, (uint8_t)type);
+    }
+    dispatch->unhandled = 0;
+
+    return;
+}
+
+digi_status_t digi_dispatch_register(digi_dispatch_t * dispatch, uint8_t type, digi_frame_handler_t handler, void * context)
+{
+    if(handler == NULL)
+    {
+        return DIGI_ERROR;
+    }
+
+    dispatch->entries[type].handler = handler;
+    dispatch->entries[type].context = context;
+
+    return DIGI_OK;
+}
+
+void digi_dispatch_unregister(digi_dispatch_t * dispatch, uint8_t type)
+{
+    dispatch->entries[type].handler = digi_dispatch_drop;
+    dispatch->entries[type].context = NULL;
+
+    return;
+}
+
+void digi_dispatch_frame(digi_dispatch_t * dispatch, const digi_frame_view_t * frame)
+{
+    const digi_dispatch_entry_t * entry = &dispatch->entries[frame->type];
+
+    // Counted here rather than through the drop handler's context so a copied table counts into itself
+    dispatch->unhandled += (entry->handler == digi_dispatch_drop);
+    entry->handler(entry->context, frame);
+
+    return;
+}
+
+size_t digi_dispatch_receive(digi_dispatch_t * dispatch, digi_parser_t * parser, const uint8_t * bytes, size_t size)
+{
+    size_t frames = 0;
+    size_t consumed = 0;
+    digi_frame_view_t frame;
+    digi_parse_result_t result;
+
+    do
+    {
+        result = digi_parser_feed(parser, bytes, size, &consumed, &frame);
+        bytes += consumed;
+        size -= consumed;
+
+        if(result == DIGI_PARSE_FRAME)
+        {
+            digi_dispatch_frame(dispatch, &frame);
+            frames++;
+        }
+    }while(result != DIGI_PARSE_NEED_MORE);
+
+    return frames;
+}
+
+uint32_t digi_dispatch_unhandled(const digi_dispatch_t * dispatch)
+{
+    return dispatch->unhandled;
+}
@@ -0,0 +1,253 @@
+#include "c_driver_digimesh_escape.h"
+#include "c_driver_digimesh_parser.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief XON flow control byte
+ */
+#define DIGI_XON 0x11
+
+/**
+ * @brief XOFF flow control byte
+ */
+#define DIGI_XOFF 0x13
+
+/**
+ * @brief Number of bytes checked at a time when looking for bytes that need work
+ */
+#define WORD_SIZE sizeof(uint64_t)
+
+/**
+ * @brief A word with every byte set to the given value
+ */
+#define WORD_REPEAT(byte) ((uint64_t)(byte) * 0x0101010101010101ull)
+
+/**
+ * @brief Non zero if any byte in the word is zero. Works on all eight bytes at once.
+ */
+#define WORD_HAS_ZERO(word) (((word) - WORD_REPEAT(0x01)) & ~(word) & WORD_REPEAT(0x80))
+
+/**
+ * @brief Non zero if any byte in the word equals the given value.
+ */
+#define WORD_HAS_BYTE(word, byte) WORD_HAS_ZERO((word) ^ WORD_REPEAT(byte))
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Check whether a byte has to be escaped.
+ * 
+ * @param byte - the byte
+ * 
+ * @return true - the byte has to be escaped
+ * @return false - the byte can be sent as is
+ */
+static bool digi_needs_escape(uint8_t byte);
+
+/**
+ * @brief Check eight bytes at once for any byte that has to be escaped.
+ * 
+ * @param word - eight bytes
+ * 
+ * @return true - at least one of the bytes has to be escaped
+ * @return false - none of the bytes have to be escaped
+ */
+static bool digi_word_needs_escape(uint64_t word);
+
+/**
+ * @brief Escape one frame, leaving its start delimiter as is.
+ * 
+ * @param frame - the unescaped frame
+ * @param size - number of bytes in frame, at least 1
+ * @param escaped - buffer to write the escaped frame into
+ * @param capacity - number of bytes available in escaped
+ * 
+ * @return size_t - number of bytes written to escaped or 0 if it doesn't fit
+ */
+static size_t digi_escape_frame(const uint8_t * frame, size_t size, uint8_t * escaped, size_t capacity);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static bool digi_needs_escape(uint8_t byte)
+{
+    return byte == DIGI_START_DELIMITER || byte == DIGI_ESCAPE || byte == DIGI_XON || byte == DIGI_XOFF;
+}
+
+static bool digi_word_needs_escape(uint64_t word)
+{
+    return (WORD_HAS_BYTE(word, DIGI_START_DELIMITER) | WORD_HAS_BYTE(word, DIGI_ESCAPE) |
+            WORD_HAS_BYTE(word, DIGI_XON) | WORD_HAS_BYTE(word, DIGI_XOFF)) != 0;
+}
+
+static size_t digi_escape_frame(const uint8_t * frame, size_t size, uint8_t * escaped, size_t capacity)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    if(capacity == 0)
+    {
+        return 0;
+    }
+
+    // The start delimiter is the one byte that is never escaped
+    escaped[out++] = frame[in++];
+
+    while(in < size)
+    {
+        // Copy eight bytes at a time while none of them need escaping
+        if(size - in >= WORD_SIZE && capacity - out >= WORD_SIZE)
+        {
+            uint64_t word;
+            memcpy(&word, &frame[in], WORD_SIZE);
+
+            if(!digi_word_needs_escape(word))
+            {
+                memcpy(&escaped[out], &word, WORD_SIZE);
+                in += WORD_SIZE;
+                out += WORD_SIZE;
+                continue;
+            }
+        }
+
+        // Near a byte that needs escaping, or at the end, go one at a time until the next word boundary
+        size_t stop = (size - in >= WORD_SIZE) ? in + WORD_SIZE : size;
+        for(; in < stop; in++)
+        {
+            uint8_t byte = frame[in];
+
+            if(digi_needs_escape(byte))
+            {
+                if(capacity - out < 2)
+                {
+                    return 0;
+                }
+                escaped[out++] = DIGI_ESCAPE;
+                escaped[out++] = byte ^ DIGI_ESCAPE_XOR;
+            }
+            else
+            {
+                if(capacity - out < 1)
+                {
+                    return 0;
+                }
+                escaped[out++] = byte;
+            }
+        }
+    }
+
+    return out;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+size_t digi_escape(const uint8_t * frames, size_t size, uint8_t * escaped, size_t capacity)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    if(size == 0)
+    {
+        return 0;
+    }
+
+    // Each frame's start delimiter has to go out as is, so escape the frames of a batch one at a time using
+    // their unescaped length fields to find where the next one starts
+    while(in < size)
+    {
+        size_t end = size;
+
+        if(size - in >= DIGI_FRAME_HEADER_SIZE)
+        {
+            size_t length = ((size_t)frames[in + 1] << 8) | frames[in + 2];
+
+            if(size - in > DIGI_FRAME_OVERHEAD + length)
+            {
+                end = in + DIGI_FRAME_OVERHEAD + length;
+            }
+        }
+
+        size_t written = digi_escape_frame(&frames[in], end - in, &escaped[out], capacity - out);
+        if(written == 0)
+        {
+            return 0;
+        }
+
+        in = end;
+        out += written;
+    }
+
+    return out;
+}
+
+void digi_unescaper_init(digi_unescaper_t * unescaper)
+{
+    unescaper->escape_pending = false;
+
+    return;
+}
+
+size_t digi_unescape(digi_unescaper_t * unescaper, const uint8_t * input, size_t size, uint8_t * output)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    // An escape at the end of the last chunk applies to the first byte of this one. A start delimiter can't
+    // be escaped so one here means the frame was cut short. Pass it through so the parser resynchronizes.
+    if(unescaper->escape_pending && size > 0)
+    {
+        unescaper->escape_pending = false;
+        output[out++] = (input[0] == DIGI_START_DELIMITER) ? input[0] : input[0] ^ DIGI_ESCAPE_XOR;
+        in++;
+    }
+
+    while(in < size)
+    {
+        // Move eight bytes at a time while none of them are escapes. Output never gets ahead of input so
+        // this is safe in place.
+        if(size - in >= WORD_SIZE)
+        {
+            uint64_t word;
+            memcpy(&word, &input[in], WORD_SIZE);
+
+            if(!WORD_HAS_BYTE(word, DIGI_ESCAPE))
+            {
+                memcpy(&output[out], &word, WORD_SIZE);
+                in += WORD_SIZE;
+                out += WORD_SIZE;
+                continue;
+            }
+        }
+
+        uint8_t byte = input[in++];
+
+        if(byte != DIGI_ESCAPE)
+        {
+            output[out++] = byte;
+        }
+        else if(in == size)
+        {
+            unescaper->escape_pending = true;
+        }
+        else if(input[in] == DIGI_START_DELIMITER)
+        {
+            output[out++] = input[in++];
+        }
+        else
+        {
+            output[out++] = input[in++] ^ DIGI_ESCAPE_XOR;
+        }
+    }
+
+    return out;
+}
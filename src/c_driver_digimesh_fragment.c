@@ -0,0 +1,313 @@
+#include "c_driver_digimesh_fragment.h"
+#include "c_driver_digimesh_nodes.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Most message bytes one fragment can carry, limited by the width of the size in the header.
+ */
+#define DIGI_FRAGMENT_MAXIMUM_SIZE UINT8_MAX
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Message bytes in every fragment but the last.
+ * 
+ * @param maximum_payload - most payload bytes in one transmit request
+ * 
+ * @return size_t - 0 if there isn't room for any
+ */
+static size_t digi_fragment_size(uint16_t maximum_payload);
+
+/**
+ * @brief Find the slot of a message already being put back together.
+ * 
+ * @param reassembly - the reassembler
+ * @param source - key of the sender
+ * @param message_id - the sender's id for the message
+ * 
+ * @return digi_reassembly_slot_t* - NULL if it isn't found
+ */
+static digi_reassembly_slot_t * digi_reassembly_find(digi_reassembly_t * reassembly, uint64_t source, uint8_t message_id);
+
+/**
+ * @brief Take a slot for a new message. If every slot is in use the oldest message already handed over gives
+ * up its slot, and failing that the oldest message still arriving is dropped.
+ * 
+ * @param reassembly - the reassembler
+ * @param now - the current time
+ * @param evict - whether a message still arriving may be dropped
+ * 
+ * @return digi_reassembly_slot_t* - NULL if every slot holds a message still arriving and evict is false
+ */
+static digi_reassembly_slot_t * digi_reassembly_claim(digi_reassembly_t * reassembly, uint32_t now, bool evict);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static size_t digi_fragment_size(uint16_t maximum_payload)
+{
+    if(maximum_payload <= DIGI_FRAGMENT_HEADER_SIZE)
+    {
+        return 0;
+    }
+
+    size_t size = (size_t)maximum_payload - DIGI_FRAGMENT_HEADER_SIZE;
+
+    return (size < DIGI_FRAGMENT_MAXIMUM_SIZE) ? size : DIGI_FRAGMENT_MAXIMUM_SIZE;
+}
+
+static digi_reassembly_slot_t * digi_reassembly_find(digi_reassembly_t * reassembly, uint64_t source, uint8_t message_id)
+{
+    for(uint32_t idx = 0; idx < reassembly->slot_count; idx++)
+    {
+        digi_reassembly_slot_t * slot = &reassembly->slots[idx];
+
+        if(slot->active && slot->source == source && slot->message_id == message_id)
+        {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+static digi_reassembly_slot_t * digi_reassembly_claim(digi_reassembly_t * reassembly, uint32_t now, bool evict)
+{
+    digi_reassembly_slot_t * oldest = NULL;
+    digi_reassembly_slot_t * oldest_complete = NULL;
+
+    for(uint32_t idx = 0; idx < reassembly->slot_count; idx++)
+    {
+        digi_reassembly_slot_t * slot = &reassembly->slots[idx];
+
+        if(!slot->active)
+        {
+            return slot;
+        }
+
+        digi_reassembly_slot_t ** candidate = slot->complete ? &oldest_complete : &oldest;
+
+        if(*candidate == NULL || (uint32_t)(now - slot->started) > (uint32_t)(now - (*candidate)->started))
+        {
+            *candidate = slot;
+        }
+    }
+
+    if(oldest_complete != NULL || !evict)
+    {
+        return oldest_complete;
+    }
+
+    reassembly->evictions++;
+
+    return oldest;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+uint8_t digi_fragment_count(size_t length, uint16_t maximum_payload)
+{
+    size_t size = digi_fragment_size(maximum_payload);
+
+    if(size == 0)
+    {
+        return 0;
+    }
+
+    // An empty message still takes one fragment
+    size_t count = (length == 0) ? 1 : (length + size - 1) / size;
+
+    return (count <= DIGI_FRAGMENT_MAXIMUM_COUNT) ? (uint8_t)count : 0;
+}
+
+size_t digi_generate_fragment(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, uint8_t options, uint8_t message_id, const uint8_t * data, size_t length, uint16_t maximum_payload, uint8_t index)
+{
+    uint8_t count = digi_fragment_count(length, maximum_payload);
+    size_t fragment_size = digi_fragment_size(maximum_payload);
+
+    if(index >= count)
+    {
+        return 0;
+    }
+
+    size_t offset = (size_t)index * fragment_size;
+    size_t slice = (length - offset < fragment_size) ? length - offset : fragment_size;
+    uint8_t header[DIGI_FRAGMENT_HEADER_SIZE] = {message_id, index, count, (uint8_t)fragment_size};
+    digi_payload_t payload[] = {{header, sizeof(header)}, {(slice > 0) ? &data[offset] : NULL, slice}};
+
+    return digi_generate_transmit_request(message, size, frame_id, destination, options, payload, 2);
+}
+
+digi_status_t digi_reassembly_init(digi_reassembly_t * reassembly, digi_reassembly_slot_t * slots, uint32_t slot_count, uint8_t * buffers, size_t buffer_size, uint32_t timeout, digi_reassembly_callback_t callback, void * context)
+{
+    if(slot_count == 0)
+    {
+        return DIGI_ERROR;
+    }
+
+    memset(slots, 0, slot_count * sizeof(slots[0]));
+    for(uint32_t idx = 0; idx < slot_count; idx++)
+    {
+        slots[idx].buffer = &buffers[idx * buffer_size];
+    }
+
+    reassembly->slots = slots;
+    reassembly->slot_count = slot_count;
+    reassembly->buffer_size = buffer_size;
+    reassembly->timeout = timeout;
+    reassembly->callback = callback;
+    reassembly->context = context;
+    reassembly->completed = 0;
+    reassembly->timeouts = 0;
+    reassembly->dropped = 0;
+    reassembly->evictions = 0;
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_reassembly_receive(digi_reassembly_t * reassembly, const digi_receive_packet_t * packet, uint32_t now)
+{
+    if(packet->length < DIGI_FRAGMENT_HEADER_SIZE)
+    {
+        reassembly->dropped++;
+        return DIGI_ERROR;
+    }
+
+    uint8_t message_id = packet->payload[0];
+    uint8_t index = packet->payload[1];
+    uint8_t count = packet->payload[2];
+    uint8_t fragment_size = packet->payload[3];
+    const uint8_t * data = &packet->payload[DIGI_FRAGMENT_HEADER_SIZE];
+    size_t length = packet->length - DIGI_FRAGMENT_HEADER_SIZE;
+    size_t offset = (size_t)index * fragment_size;
+    bool last = (index + 1 == count);
+
+    // Every fragment but the last is full and the last is no bigger
+    if(count == 0 || index >= count || fragment_size == 0 || length > fragment_size || (!last && length != fragment_size) || offset + length > reassembly->buffer_size)
+    {
+        reassembly->dropped++;
+        return DIGI_ERROR;
+    }
+
+    uint64_t source = digi_serial_to_key(&packet->source);
+    digi_reassembly_slot_t * slot = digi_reassembly_find(reassembly, source, message_id);
+
+    if(slot != NULL && (slot->count != count || slot->fragment_size != fragment_size))
+    {
+        reassembly->dropped++;
+        return DIGI_ERROR;
+    }
+
+    // A repeated fragment changes nothing once its message has been handed over
+    if(slot != NULL && slot->complete)
+    {
+        return DIGI_OK;
+    }
+
+    // A message that fits in one fragment needs no copying. It's remembered to catch repeats, but only in a
+    // slot no message is still arriving in.
+    if(count == 1)
+    {
+        slot = digi_reassembly_claim(reassembly, now, false);
+        if(slot != NULL)
+        {
+            slot->source = source;
+            slot->message_id = message_id;
+            slot->count = count;
+            slot->fragment_size = fragment_size;
+            slot->remaining = 0;
+            slot->started = now;
+            slot->active = true;
+            slot->complete = true;
+        }
+
+        reassembly->completed++;
+        reassembly->callback(reassembly->context, &packet->source, data, length);
+        return DIGI_OK;
+    }
+
+    if(slot == NULL)
+    {
+        slot = digi_reassembly_claim(reassembly, now, true);
+        memset(slot->received, 0, sizeof(slot->received));
+        slot->source = source;
+        slot->message_id = message_id;
+        slot->count = count;
+        slot->fragment_size = fragment_size;
+        slot->remaining = count;
+        slot->started = now;
+        slot->active = true;
+        slot->complete = false;
+    }
+
+    uint8_t bit = (uint8_t)(1u << (index % 8));
+
+    // A repeated fragment changes nothing
+    if(slot->received[index / 8] & bit)
+    {
+        return DIGI_OK;
+    }
+
+    memcpy(&slot->buffer[offset], data, length);
+    slot->received[index / 8] |= bit;
+    slot->remaining--;
+
+    if(last)
+    {
+        slot->length = offset + length;
+    }
+
+    if(slot->remaining == 0)
+    {
+        slot->complete = true;
+        reassembly->completed++;
+        reassembly->callback(reassembly->context, &packet->source, slot->buffer, slot->length);
+    }
+
+    return DIGI_OK;
+}
+
+void digi_reassembly_poll(digi_reassembly_t * reassembly, uint32_t now)
+{
+    for(uint32_t idx = 0; idx < reassembly->slot_count; idx++)
+    {
+        digi_reassembly_slot_t * slot = &reassembly->slots[idx];
+
+        if(slot->active && (uint32_t)(now - slot->started) >= reassembly->timeout)
+        {
+            slot->active = false;
+
+            if(!slot->complete)
+            {
+                reassembly->timeouts++;
+            }
+        }
+    }
+
+    return;
+}
+
+uint32_t digi_reassembly_completed(const digi_reassembly_t * reassembly)
+{
+    return reassembly->completed;
+}
+
+uint32_t digi_reassembly_failures(const digi_reassembly_t * reassembly)
+{
+    return reassembly->timeouts + reassembly->evictions;
+}
+
+uint32_t digi_reassembly_dropped(const digi_reassembly_t * reassembly)
+{
+    return reassembly->dropped;
+}
@@ -0,0 +1,184 @@
+#include "c_driver_digimesh_identify.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Bytes of a serial number carried by each of SH and SL.
+ */
+#define DIGI_IDENTIFY_SERIAL_HALF (DIGI_SERIAL_LENGTH / 2)
+
+/**
+ * @brief Bits of the queries for the two halves of the serial number.
+ */
+#define DIGI_IDENTIFY_SERIAL_BITS 0x03
+
+/**
+ * @brief The fields queried, serial number first so it can land as early as possible.
+ */
+static const digi_field_t digi_identify_fields[DIGI_IDENTIFY_FIELDS] = 
+{
+    DIGI_FIELD_SH, DIGI_FIELD_SL, DIGI_FIELD_NI, DIGI_FIELD_ID, DIGI_FIELD_CH, DIGI_FIELD_NP, DIGI_FIELD_VR, DIGI_FIELD_HV
+};
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Handle the response to one query. Matches digi_pending_callback_t.
+ * 
+ * @param context - the identification
+ * @param frame - the response
+ */
+static void digi_identify_response(void * context, const digi_frame_view_t * frame);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static void digi_identify_response(void * context, const digi_frame_view_t * frame)
+{
+    digi_identify_t * identify = context;
+    digi_at_response_t response;
+    uint8_t query = 0;
+
+    // The pending table has matched the frame id so it's there even if the rest doesn't decode
+    while(query < DIGI_IDENTIFY_FIELDS && identify->frame_ids[query] != frame->data[0])
+    {
+        query++;
+    }
+
+    if(query == DIGI_IDENTIFY_FIELDS || !(identify->outstanding & (1u << query)))
+    {
+        return;
+    }
+
+    identify->outstanding &= (uint8_t)~(1u << query);
+
+    if(digi_decode_at_response(frame, &response) != DIGI_OK || response.status != 0)
+    {
+        identify->failed |= (uint8_t)(1u << query);
+        return;
+    }
+
+    switch(digi_identify_fields[query])
+    {
+        case DIGI_FIELD_SH:
+        case DIGI_FIELD_SL:
+        {
+            // Leading zero bytes may be left off so line the value up on the right
+            uint16_t length = response.length < DIGI_IDENTIFY_SERIAL_HALF ? response.length : DIGI_IDENTIFY_SERIAL_HALF;
+            uint8_t * half = &identify->serial[query * DIGI_IDENTIFY_SERIAL_HALF];
+
+            memset(half, 0, DIGI_IDENTIFY_SERIAL_HALF);
+            memcpy(&half[DIGI_IDENTIFY_SERIAL_HALF - length], &response.value[response.length - length], length);
+
+            if(!(identify->outstanding & DIGI_IDENTIFY_SERIAL_BITS) && !(identify->failed & DIGI_IDENTIFY_SERIAL_BITS))
+            {
+                digi_serial_t serial;
+                memcpy(serial.serial, identify->serial, DIGI_SERIAL_LENGTH);
+                digi_register(identify->digi, &serial);
+            }
+            break;
+        }
+
+        case DIGI_FIELD_NI:
+        {
+            uint16_t length = response.length < DIGI_IDENTIFY_NODE_IDENTIFIER_SIZE ? response.length : DIGI_IDENTIFY_NODE_IDENTIFIER_SIZE;
+
+            memcpy(identify->node_identifier, response.value, length);
+            identify->node_identifier[length] = '\0';
+            break;
+        }
+
+        default:
+            if(identify->cache != NULL)
+            {
+                digi_cache_frame(identify->cache, frame);
+            }
+            break;
+    }
+
+    return;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+size_t digi_identify_start(digi_identify_t * identify, digi_t * digi, digi_pending_t * pending, digi_cache_t * cache, uint8_t * message, size_t size)
+{
+    size_t total = 0;
+    uint8_t query = 0;
+
+    memset(identify, 0, sizeof(*identify));
+    identify->digi = digi;
+    identify->cache = cache;
+    identify->pending = pending;
+
+    for(; query < DIGI_IDENTIFY_FIELDS; query++)
+    {
+        if(digi_pending_add(pending, digi_identify_response, identify, &identify->frame_ids[query]) != DIGI_OK)
+        {
+            break;
+        }
+
+        size_t written = digi_generate_get_field_message(&message[total], size - total, identify->frame_ids[query], digi_identify_fields[query]);
+        if(written == 0)
+        {
+            digi_pending_cancel(pending, identify->frame_ids[query]);
+            break;
+        }
+
+        total += written;
+    }
+
+    // Give back the frame ids of a partly built batch
+    if(query < DIGI_IDENTIFY_FIELDS)
+    {
+        while(query > 0)
+        {
+            digi_pending_cancel(pending, identify->frame_ids[--query]);
+        }
+        return 0;
+    }
+
+    identify->outstanding = (uint8_t)((1u << DIGI_IDENTIFY_FIELDS) - 1);
+
+    return total;
+}
+
+bool digi_identify_done(const digi_identify_t * identify)
+{
+    return identify->outstanding == 0;
+}
+
+void digi_identify_cancel(digi_identify_t * identify)
+{
+    for(uint8_t query = 0; query < DIGI_IDENTIFY_FIELDS; query++)
+    {
+        if(identify->outstanding & (1u << query))
+        {
+            digi_pending_cancel(identify->pending, identify->frame_ids[query]);
+            identify->failed |= (uint8_t)(1u << query);
+        }
+    }
+
+    identify->outstanding = 0;
+
+    return;
+}
+
+bool digi_identify_failed(const digi_identify_t * identify)
+{
+    return identify->failed != 0;
+}
+
+const char * digi_identify_node_identifier(const digi_identify_t * identify)
+{
+    return identify->node_identifier;
+}
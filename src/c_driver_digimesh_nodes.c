@@ -0,0 +1,183 @@
+#include "c_driver_digimesh_nodes.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief 2^64 divided by the golden ratio. Multiplying by it spreads keys that only differ in a few bits,
+ * like serial numbers from one manufacturing batch, over the whole table.
+ */
+#define DIGI_NODES_HASH_MULTIPLIER 0x9E3779B97F4A7C15ull
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Find the slot a key is in or the empty slot where it would go.
+ * 
+ * @param table - the table
+ * @param key - the key
+ * 
+ * @return uint32_t - the slot index
+ */
+static uint32_t digi_nodes_probe(const digi_node_table_t * table, uint64_t key);
+
+/**
+ * @brief The slot a key would be in if nothing had collided with it.
+ * 
+ * @param table - the table
+ * @param key - the key
+ * 
+ * @return uint32_t - the slot index
+ */
+static uint32_t digi_nodes_home(const digi_node_table_t * table, uint64_t key);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static uint32_t digi_nodes_home(const digi_node_table_t * table, uint64_t key)
+{
+    return (uint32_t)((key * DIGI_NODES_HASH_MULTIPLIER) >> table->shift);
+}
+
+static uint32_t digi_nodes_probe(const digi_node_table_t * table, uint64_t key)
+{
+    uint32_t slot = digi_nodes_home(table, key);
+
+    // The load limit guarantees an empty slot so this always ends
+    while(table->nodes[slot].used && table->nodes[slot].key != key)
+    {
+        slot = (slot + 1) & table->mask;
+    }
+
+    return slot;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+uint64_t digi_serial_to_key(const digi_serial_t * serial)
+{
+    uint64_t key = 0;
+
+    for(uint8_t idx = 0; idx < DIGI_SERIAL_LENGTH; idx++)
+    {
+        key = (key << 8) | serial->serial[idx];
+    }
+
+    return key;
+}
+
+void digi_key_to_serial(uint64_t key, digi_serial_t * serial)
+{
+    for(uint8_t idx = 0; idx < DIGI_SERIAL_LENGTH; idx++)
+    {
+        serial->serial[DIGI_SERIAL_LENGTH - 1 - idx] = (uint8_t)(key >> (8 * idx));
+    }
+
+    return;
+}
+
+digi_status_t digi_nodes_init(digi_node_table_t * table, digi_node_t * nodes, uint32_t capacity)
+{
+    if(capacity < 2 || (capacity & (capacity - 1)) != 0)
+    {
+        return DIGI_ERROR;
+    }
+
+    uint8_t bits = 0;
+    while((1ul << bits) < capacity)
+    {
+        bits++;
+    }
+
+    memset(nodes, 0, capacity * sizeof(digi_node_t));
+    table->nodes = nodes;
+    table->mask = capacity - 1;
+    table->count = 0;
+    table->shift = 64 - bits;
+
+    // Always leave at least one slot empty so every probe ends
+    table->limit = (uint32_t)(((uint64_t)capacity * DIGI_NODES_MAXIMUM_LOAD) / 100);
+    if(table->limit >= capacity)
+    {
+        table->limit = capacity - 1;
+    }
+
+    return DIGI_OK;
+}
+
+digi_node_t * digi_nodes_find(digi_node_table_t * table, uint64_t key)
+{
+    digi_node_t * node = &table->nodes[digi_nodes_probe(table, key)];
+
+    return node->used ? node : NULL;
+}
+
+digi_node_t * digi_nodes_insert(digi_node_table_t * table, uint64_t key)
+{
+    digi_node_t * node = &table->nodes[digi_nodes_probe(table, key)];
+
+    if(node->used)
+    {
+        return node;
+    }
+    if(table->count >= table->limit)
+    {
+        return NULL;
+    }
+
+    memset(node, 0, sizeof(*node));
+    node->key = key;
+    node->used = true;
+    table->count++;
+
+    return node;
+}
+
+digi_status_t digi_nodes_evict(digi_node_table_t * table, uint64_t key)
+{
+    uint32_t hole = digi_nodes_probe(table, key);
+
+    if(!table->nodes[hole].used)
+    {
+        return DIGI_ERROR;
+    }
+
+    // Shift later members of the probe run back into the hole so no tombstones are needed and lookups
+    // stay as short as they were before the node was added.
+    uint32_t slot = hole;
+    while(true)
+    {
+        slot = (slot + 1) & table->mask;
+
+        if(!table->nodes[slot].used)
+        {
+            break;
+        }
+
+        // A node can only move back if the hole is between its home slot and where it is now
+        uint32_t home = digi_nodes_home(table, table->nodes[slot].key);
+        if(((slot - home) & table->mask) >= ((slot - hole) & table->mask))
+        {
+            table->nodes[hole] = table->nodes[slot];
+            hole = slot;
+        }
+    }
+
+    table->nodes[hole].used = false;
+    table->count--;
+
+    return DIGI_OK;
+}
+
+uint32_t digi_nodes_count(const digi_node_table_t * table)
+{
+    return table->count;
+}
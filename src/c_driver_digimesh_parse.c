@@ -12,6 +12,156 @@
  */
 #define EMPTY_SERIAL 0xFF
 
+/**
+ * @brief Bytes of the length field
+ */
+#define DIGI_LENGTH_SIZE 2
+
+/**
+ * @brief Bytes of frame data in a transmit request before the payload. Frame type, frame id, 64 bit
+ * destination, 16 bit destination, broadcast radius and options.
+ */
+#define DIGI_TRANSMIT_REQUEST_SIZE 14
+
+/**
+ * @brief 16 bit address to use when it isn't known. The digi module routes on the 64 bit address.
+ */
+#define DIGI_UNKNOWN_ADDRESS 0xFFFE
+
+/**
+ * @brief Bytes of frame data in a receive packet after the frame type and before the payload. 64 bit
+ * source, 16 bit source and options.
+ */
+#define DIGI_RECEIVE_PACKET_SIZE 11
+
+/**
+ * @brief Bytes of frame data in a local AT command response after the frame type and before the value.
+ * Frame id, command and status.
+ */
+#define DIGI_AT_RESPONSE_SIZE 4
+
+/**
+ * @brief Bytes of frame data in a transmit status after the frame type. Frame id, 16 bit destination, retry
+ * count, delivery status and discovery status.
+ */
+#define DIGI_TRANSMIT_STATUS_SIZE 6
+
+/**
+ * @brief Bytes of frame data in a remote AT command before the value. Frame type, frame id, 64 bit
+ * destination, 16 bit destination, options and command.
+ */
+#define DIGI_REMOTE_AT_SIZE 15
+
+/**
+ * @brief Bytes of frame data in a remote AT command response after the frame type and before the value.
+ * Frame id, 64 bit source, 16 bit source, command and status.
+ */
+#define DIGI_REMOTE_AT_RESPONSE_SIZE 14
+
+/**
+ * @brief Widest field value that can be set from an integer.
+ */
+#define DIGI_FIELD_MAXIMUM_INTEGER_WIDTH 4
+
+/**
+ * @brief Number of slots in the table that maps AT command codes to fields.
+ */
+#define DIGI_FIELD_HASH_SIZE 256
+
+/**
+ * @brief Multiplier that makes DIGI_FIELD_HASH collision free for every code in DIGI_FIELDS. If a field is
+ * added and the round trip test fails, search for a new one.
+ */
+#define DIGI_FIELD_HASH_MULTIPLIER 0x16F59E49u
+
+/**
+ * @brief Perfect hash of an AT command code. The 2 characters are packed into a 16 bit key and multiplied,
+ * the top 8 bits of the product select the slot.
+ */
+#define DIGI_FIELD_HASH(first, second) \
+    ((uint8_t)(((((uint32_t)(uint8_t)(first) << 8) | (uint8_t)(second)) * DIGI_FIELD_HASH_MULTIPLIER) >> 24))
+
+/**
+ * @brief Every known field. X(field, first character, second character, width, writable, apply)
+ */
+#define DIGI_FIELDS(X) \
+    X(DIGI_FIELD_ID,      'I', 'D',  2, true,  true ) \
+    X(DIGI_FIELD_CH,      'C', 'H',  1, true,  true ) \
+    X(DIGI_FIELD_HP,      'H', 'P',  1, true,  true ) \
+    X(DIGI_FIELD_CE,      'C', 'E',  1, true,  true ) \
+    X(DIGI_FIELD_MT,      'M', 'T',  1, true,  true ) \
+    X(DIGI_FIELD_RR,      'R', 'R',  1, true,  true ) \
+    X(DIGI_FIELD_MR,      'M', 'R',  1, true,  true ) \
+    X(DIGI_FIELD_NH,      'N', 'H',  1, true,  true ) \
+    X(DIGI_FIELD_BH,      'B', 'H',  1, true,  true ) \
+    X(DIGI_FIELD_NN,      'N', 'N',  1, true,  true ) \
+    X(DIGI_FIELD_NT,      'N', 'T',  1, true,  true ) \
+    X(DIGI_FIELD_NO,      'N', 'O',  1, true,  true ) \
+    X(DIGI_FIELD_DH,      'D', 'H',  4, true,  true ) \
+    X(DIGI_FIELD_DL,      'D', 'L',  4, true,  true ) \
+    X(DIGI_FIELD_TO,      'T', 'O',  1, true,  true ) \
+    X(DIGI_FIELD_NI,      'N', 'I', 20, true,  true ) \
+    X(DIGI_FIELD_SH,      'S', 'H',  4, false, false) \
+    X(DIGI_FIELD_SL,      'S', 'L',  4, false, false) \
+    X(DIGI_FIELD_MY,      'M', 'Y',  2, false, false) \
+    X(DIGI_FIELD_NP,      'N', 'P',  2, false, false) \
+    X(DIGI_FIELD_DD,      'D', 'D',  4, true,  true ) \
+    X(DIGI_FIELD_CI,      'C', 'I',  2, true,  true ) \
+    X(DIGI_FIELD_EE,      'E', 'E',  1, true,  true ) \
+    X(DIGI_FIELD_KY,      'K', 'Y', 16, true,  true ) \
+    X(DIGI_FIELD_PL,      'P', 'L',  1, true,  true ) \
+    X(DIGI_FIELD_BD,      'B', 'D',  4, true,  true ) \
+    X(DIGI_FIELD_NB,      'N', 'B',  1, true,  true ) \
+    X(DIGI_FIELD_SB,      'S', 'B',  1, true,  true ) \
+    X(DIGI_FIELD_RO,      'R', 'O',  1, true,  true ) \
+    X(DIGI_FIELD_FT,      'F', 'T',  2, true,  true ) \
+    X(DIGI_FIELD_AP,      'A', 'P',  1, true,  true ) \
+    X(DIGI_FIELD_AO,      'A', 'O',  1, true,  true ) \
+    X(DIGI_FIELD_SM,      'S', 'M',  1, true,  true ) \
+    X(DIGI_FIELD_SO,      'S', 'O',  1, true,  true ) \
+    X(DIGI_FIELD_SN,      'S', 'N',  2, true,  true ) \
+    X(DIGI_FIELD_SP,      'S', 'P',  4, true,  true ) \
+    X(DIGI_FIELD_ST,      'S', 'T',  4, true,  true ) \
+    X(DIGI_FIELD_WH,      'W', 'H',  2, true,  true ) \
+    X(DIGI_FIELD_D0,      'D', '0',  1, true,  true ) \
+    X(DIGI_FIELD_D1,      'D', '1',  1, true,  true ) \
+    X(DIGI_FIELD_D2,      'D', '2',  1, true,  true ) \
+    X(DIGI_FIELD_D3,      'D', '3',  1, true,  true ) \
+    X(DIGI_FIELD_D4,      'D', '4',  1, true,  true ) \
+    X(DIGI_FIELD_D5,      'D', '5',  1, true,  true ) \
+    X(DIGI_FIELD_D6,      'D', '6',  1, true,  true ) \
+    X(DIGI_FIELD_D7,      'D', '7',  1, true,  true ) \
+    X(DIGI_FIELD_D8,      'D', '8',  1, true,  true ) \
+    X(DIGI_FIELD_D9,      'D', '9',  1, true,  true ) \
+    X(DIGI_FIELD_P0,      'P', '0',  1, true,  true ) \
+    X(DIGI_FIELD_P1,      'P', '1',  1, true,  true ) \
+    X(DIGI_FIELD_P2,      'P', '2',  1, true,  true ) \
+    X(DIGI_FIELD_PR,      'P', 'R',  2, true,  true ) \
+    X(DIGI_FIELD_IR,      'I', 'R',  2, true,  true ) \
+    X(DIGI_FIELD_IC,      'I', 'C',  2, true,  true ) \
+    X(DIGI_FIELD_VR,      'V', 'R',  4, false, false) \
+    X(DIGI_FIELD_HV,      'H', 'V',  2, false, false) \
+    X(DIGI_FIELD_VOLTAGE, '%', 'V',  2, false, false) \
+    X(DIGI_FIELD_DB,      'D', 'B',  1, false, false) \
+    X(DIGI_FIELD_TP,      'T', 'P',  2, false, false) \
+    X(DIGI_FIELD_ER,      'E', 'R',  2, false, false) \
+    X(DIGI_FIELD_GD,      'G', 'D',  2, false, false) \
+    X(DIGI_FIELD_EA,      'E', 'A',  2, false, false) \
+    X(DIGI_FIELD_TR,      'T', 'R',  2, false, false) \
+    X(DIGI_FIELD_UA,      'U', 'A',  2, false, false) \
+    X(DIGI_FIELD_AI,      'A', 'I',  1, false, false) \
+    X(DIGI_FIELD_AC,      'A', 'C',  0, false, false) \
+    X(DIGI_FIELD_WR,      'W', 'R',  0, false, false) \
+    X(DIGI_FIELD_RE,      'R', 'E',  0, false, false) \
+    X(DIGI_FIELD_FR,      'F', 'R',  0, false, false) \
+    X(DIGI_FIELD_ND,      'N', 'D',  0, false, false) \
+    X(DIGI_FIELD_CN,      'C', 'N',  0, false, false)
+
+/**
+ * @brief Adds one for each field in DIGI_FIELDS, for checking it against digi_field_t.
+ */
+#define DIGI_FIELD_COUNT(field, first, second, width, writable, apply) + 1
+
 /*****************/
 /* PRIVATE TYPES */
 /*****************/
@@ -25,6 +175,8 @@ struct digi_t{
     uint8_t serial[DIGI_SERIAL_LENGTH];
 };
 
+_Static_assert(sizeof(struct digi_t) <= DIGI_CONTEXT_SIZE, "DIGI_CONTEXT_SIZE is too small to hold a digi_t");
+
 /**
  * @brief Frame structure of a message that can be used to SET a field on a local digi device.
  */
@@ -51,54 +203,471 @@ typedef struct{
 }digi_at_command_get_t;
 
 /**
- * @brief Identifies what type of frame you want to build.
+ * @brief The part of a frame a parser is waiting for.
  */
 typedef enum{
-    DIGI_FRAME_LOCAL_AT = 0x08,
-    DIGI_FRAME_TRANSMIT_REQUEST = 0x10,
-    DIGI_FRAME_END
-}digi_frame_t;
+    DIGI_PARSER_HUNT,           // Discarding bytes until a start delimiter is seen
+    DIGI_PARSER_LENGTH,         // Gathering the two length bytes into the parser buffer
+    DIGI_PARSER_DATA,           // Gathering frame data into the parser buffer
+    DIGI_PARSER_CHECKSUM        // Waiting for the checksum byte
+}digi_parser_state_t;
 
 /*********************/
 /* PRIVATE VARIABLES */
 /*********************/
 
-// The local digimodule instance
-digi_t digi = {0};
+// Description of every field. Can be indexed by digi_field_t.
+static const digi_field_info_t digi_fields[DIGI_FIELD_END] = 
+{
+#define DIGI_FIELD_INFO(field, first, second, width, writable, apply) [field] = {{first, second}, width, writable, apply},
+    DIGI_FIELDS(DIGI_FIELD_INFO)
+#undef DIGI_FIELD_INFO
+};
+
+_Static_assert((0 DIGI_FIELDS(DIGI_FIELD_COUNT)) == DIGI_FIELD_END, "DIGI_FIELDS and digi_field_t don't match");
 
-// List of ascii strings representing differenct fields. Can be
-// indexed by digi_field_t.
-char digi_field_strings[DIGI_FIELD_END][2] = 
+// Maps the hash of an AT command code to its field plus one. 0 marks an empty slot.
+static const uint8_t digi_field_hash[DIGI_FIELD_HASH_SIZE] = 
 {
-    {'I','D'}  // The network ID of the digi module
+#define DIGI_FIELD_SLOT(field, first, second, width, writable, apply) [DIGI_FIELD_HASH(first, second)] = field + 1,
+    DIGI_FIELDS(DIGI_FIELD_SLOT)
+#undef DIGI_FIELD_SLOT
 };
 
 /*********************************/
 /* PRIVATE FUNCTION DECLARATIONS */
 /*********************************/
 
+/**
+ * @brief Add up an array of bytes into an 8 bit sum.
+ * 
+ * @param sum - the sum so far
+ * @param bytes - the bytes to add
+ * @param size - number of bytes to add
+ * 
+ * @return uint8_t - the new sum
+ */
+static uint8_t digi_sum(uint8_t sum, const uint8_t * bytes, size_t size);
+
+/**
+ * @brief Copy bytes and add them to an 8 bit sum in the same pass.
+ * 
+ * @param sum - the sum so far
+ * @param destination - where to copy to
+ * @param source - where to copy from
+ * @param size - number of bytes to copy
+ * 
+ * @return uint8_t - the new sum
+ */
+static uint8_t digi_copy_sum(uint8_t sum, uint8_t * destination, const uint8_t * source, size_t size);
+
+/**
+ * @brief Check whether a length field could belong to a real frame.
+ * 
+ * @param length - the value of the length field
+ * 
+ * @return true - the length is plausible
+ * @return false - the length is zero or too big for a message
+ */
+static bool digi_length_is_valid(uint16_t length);
+
+/**
+ * @brief Fill in a frame view.
+ * 
+ * @param frame - the view to fill in
+ * @param data - the frame data including the frame type byte
+ * @param length - number of bytes of frame data
+ * 
+ * @return digi_parse_result_t - always DIGI_PARSE_FRAME
+ */
+static digi_parse_result_t digi_frame_view(digi_frame_view_t * frame, const uint8_t * data, uint16_t length);
+
+/**
+ * @brief Drop a frame that was gathered in the parser buffer. The next start delimiter inside the dropped
+ * bytes, if there is one, is kept back to be parsed again.
+ * 
+ * @param parser - the parser
+ * @param result - why the frame was dropped
+ * 
+ * @return digi_parse_result_t - result
+ */
+static digi_parse_result_t digi_parser_resync(digi_parser_t * parser, digi_parse_result_t result);
+
+/**
+ * @brief Run the parser state machine over some bytes until a frame is finished or dropped.
+ * 
+ * @param parser - the parser
+ * @param bytes - the bytes to parse. Either new input or bytes kept back in the parser buffer.
+ * @param size - number of bytes
+ * @param consumed - populated with the number of bytes used
+ * @param frame - populated with the frame when DIGI_PARSE_FRAME is returned
+ * 
+ * @return digi_parse_result_t 
+ */
+static digi_parse_result_t digi_parser_run(digi_parser_t * parser, const uint8_t * bytes, size_t size, size_t * consumed, digi_frame_view_t * frame);
+
+/**
+ * @brief Write the start delimiter and length of a frame.
+ * 
+ * @param message - the start of the frame
+ * @param length - the number of bytes of frame data
+ */
+static void digi_write_header(uint8_t * message, uint16_t length);
+
+/**
+ * @brief Write the checksum after the frame data.
+ * 
+ * @param message - the start of the frame, with the header and frame data written
+ * @param length - the number of bytes of frame data
+ * 
+ * @return size_t - the total size of the frame
+ */
+static size_t digi_write_checksum(uint8_t * message, uint16_t length);
+
+/**
+ * @brief Write the start of a local AT command frame, everything up to the value.
+ * 
+ * @param message - buffer to write into
+ * @param size - bytes available in message
+ * @param type - DIGI_FRAME_LOCAL_AT to apply the command straight away or DIGI_FRAME_LOCAL_AT_QUEUE to hold
+ * it until changes are applied
+ * @param frame_id - id for the response
+ * @param field - the field the command is for
+ * @param value_length - the number of value bytes that will follow
+ * 
+ * @return uint16_t - length of the frame data or 0 if it doesn't fit or the field is unknown
+ */
+static uint16_t digi_write_local_at(uint8_t * message, size_t size, uint8_t type, uint8_t frame_id, digi_field_t field, uint8_t value_length);
+
+/**
+ * @brief Write a whole local AT command frame that sets an integer field.
+ * 
+ * @param message - buffer to write into
+ * @param size - bytes available in message
+ * @param type - DIGI_FRAME_LOCAL_AT or DIGI_FRAME_LOCAL_AT_QUEUE
+ * @param frame_id - id for the response
+ * @param field - the field to set
+ * @param value - the value to set the field to
+ * 
+ * @return size_t - the total size of the frame or 0 if it doesn't fit or the field can't be set this way
+ */
+static size_t digi_write_set_field(uint8_t * message, size_t size, uint8_t type, uint8_t frame_id, digi_field_t field, uint32_t value);
+
+/**
+ * @brief Write the start of a remote AT command frame, everything up to the value.
+ * 
+ * @param message - buffer to write into
+ * @param size - bytes available in message
+ * @param frame_id - id for the response
+ * @param destination - the digi module the command is for
+ * @param options - remote command options
+ * @param field - the field the command is for
+ * @param value_length - the number of value bytes that will follow
+ * 
+ * @return uint16_t - length of the frame data or 0 if it doesn't fit or the field is unknown
+ */
+static uint16_t digi_write_remote_at(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, uint8_t options, digi_field_t field, uint8_t value_length);
+
+/**
+ * @brief Write a value most significant byte first.
+ * 
+ * @param bytes - where to write
+ * @param value - the value
+ * @param width - bytes to write
+ */
+static void digi_write_value(uint8_t * bytes, uint32_t value, uint8_t width);
+
 /********************************/
 /* PRIVATE FUNCTION DEFINITIONS */
 /********************************/
 
+static uint8_t digi_sum(uint8_t sum, const uint8_t * bytes, size_t size)
+{
+    for(size_t idx = 0; idx < size; idx++)
+    {
+        sum += bytes[idx];
+    }
+
+    return sum;
+}
+
+static uint8_t digi_copy_sum(uint8_t sum, uint8_t * destination, const uint8_t * source, size_t size)
+{
+    for(size_t idx = 0; idx < size; idx++)
+    {
+        destination[idx] = source[idx];
+        sum += source[idx];
+    }
+
+    return sum;
+}
+
+static bool digi_length_is_valid(uint16_t length)
+{
+    return length != 0 && length <= MAXIMUM_MESSAGE_SIZE;
+}
+
+static digi_parse_result_t digi_frame_view(digi_frame_view_t * frame, const uint8_t * data, uint16_t length)
+{
+    frame->type = data[0];
+    frame->data = &data[1];
+    frame->length = length - 1;
+
+    return DIGI_PARSE_FRAME;
+}
+
+static digi_parse_result_t digi_parser_resync(digi_parser_t * parser, digi_parse_result_t result)
+{
+    const uint8_t * next = memchr(parser->buffer, DIGI_START_DELIMITER, parser->stored);
+    uint16_t kept = 0;
+
+    if(next != NULL)
+    {
+        parser->replay_start = (uint16_t)(next - parser->buffer);
+        kept = parser->stored - parser->replay_start;
+    }
+    else
+    {
+        parser->replay_start = parser->stored;
+    }
+
+    parser->replay_length = kept;
+    parser->discarded += 1 + parser->stored - kept;
+    parser->resyncs++;
+    parser->state = DIGI_PARSER_HUNT;
+
+    return result;
+}
+
+static digi_parse_result_t digi_parser_run(digi_parser_t * parser, const uint8_t * bytes, size_t size, size_t * consumed, digi_frame_view_t * frame)
+{
+    size_t idx = 0;
+
+    while(idx < size)
+    {
+        switch(parser->state)
+        {
+            case DIGI_PARSER_HUNT:
+            {
+                const uint8_t * start = memchr(&bytes[idx], DIGI_START_DELIMITER, size - idx);
+
+                if(start == NULL)
+                {
+                    parser->discarded += size - idx;
+                    idx = size;
+                    break;
+                }
+
+                parser->discarded += (size_t)(start - &bytes[idx]);
+                idx = (size_t)(start - bytes) + 1;
+
+                // If the whole frame is in these bytes then check it where it lies rather than gathering it.
+                // A bad frame is dropped by leaving the bytes after its start delimiter unconsumed so the next
+                // search for a start delimiter begins inside it.
+                if(size - idx >= DIGI_LENGTH_SIZE)
+                {
+                    uint16_t length = (uint16_t)((bytes[idx] << 8) | bytes[idx + 1]);
+
+                    if(!digi_length_is_valid(length))
+                    {
+                        parser->discarded++;
+                        parser->resyncs++;
+                        *consumed = idx;
+                        return DIGI_PARSE_BAD_LENGTH;
+                    }
+
+                    if(size - idx > DIGI_LENGTH_SIZE + (size_t)length)
+                    {
+                        const uint8_t * data = &bytes[idx + DIGI_LENGTH_SIZE];
+
+                        if((uint8_t)(digi_sum(0, data, length) + data[length]) != 0xFF)
+                        {
+                            parser->discarded++;
+                            parser->resyncs++;
+                            *consumed = idx;
+                            return DIGI_PARSE_BAD_CHECKSUM;
+                        }
+
+                        *consumed = idx + DIGI_LENGTH_SIZE + length + 1;
+                        return digi_frame_view(frame, data, length);
+                    }
+                }
+
+                parser->stored = 0;
+                parser->sum = 0;
+                parser->state = DIGI_PARSER_LENGTH;
+                break;
+            }
+
+            case DIGI_PARSER_LENGTH:
+                parser->buffer[parser->stored++] = bytes[idx++];
+
+                if(parser->stored == DIGI_LENGTH_SIZE)
+                {
+                    parser->length = (uint16_t)((parser->buffer[0] << 8) | parser->buffer[1]);
+
+                    if(!digi_length_is_valid(parser->length))
+                    {
+                        *consumed = idx;
+                        return digi_parser_resync(parser, DIGI_PARSE_BAD_LENGTH);
+                    }
+
+                    parser->state = DIGI_PARSER_DATA;
+                }
+                break;
+
+            case DIGI_PARSER_DATA:
+            {
+                size_t count = DIGI_LENGTH_SIZE + parser->length - parser->stored;
+
+                if(count > size - idx)
+                {
+                    count = size - idx;
+                }
+
+                // Gather and sum in the same pass
+                parser->sum = digi_copy_sum(parser->sum, &parser->buffer[parser->stored], &bytes[idx], count);
+                parser->stored += count;
+                idx += count;
+
+                if(parser->stored == DIGI_LENGTH_SIZE + parser->length)
+                {
+                    parser->state = DIGI_PARSER_CHECKSUM;
+                }
+                break;
+            }
+
+            case DIGI_PARSER_CHECKSUM:
+                parser->buffer[parser->stored++] = bytes[idx++];
+                *consumed = idx;
+
+                if((uint8_t)(parser->sum + bytes[idx - 1]) != 0xFF)
+                {
+                    return digi_parser_resync(parser, DIGI_PARSE_BAD_CHECKSUM);
+                }
+
+                parser->state = DIGI_PARSER_HUNT;
+                return digi_frame_view(frame, &parser->buffer[DIGI_LENGTH_SIZE], parser->length);
+
+            default:
+                digi_parser_init(parser);
+                break;
+        }
+    }
+
+    *consumed = idx;
+    return DIGI_PARSE_NEED_MORE;
+}
+
+static void digi_write_header(uint8_t * message, uint16_t length)
+{
+    message[0] = DIGI_START_DELIMITER;
+    message[1] = (uint8_t)(length >> 8);
+    message[2] = (uint8_t)length;
+
+    return;
+}
+
+static size_t digi_write_checksum(uint8_t * message, uint16_t length)
+{
+    message[DIGI_FRAME_HEADER_SIZE + length] = 0xFF - digi_sum(0, &message[DIGI_FRAME_HEADER_SIZE], length);
+
+    return DIGI_FRAME_OVERHEAD + length;
+}
+
+static uint16_t digi_write_local_at(uint8_t * message, size_t size, uint8_t type, uint8_t frame_id, digi_field_t field, uint8_t value_length)
+{
+    uint16_t length = DIGI_LOCAL_AT_SIZE + value_length;
+
+    if(field >= DIGI_FIELD_END || size < (size_t)DIGI_FRAME_OVERHEAD + length)
+    {
+        return 0;
+    }
+
+    digi_write_header(message, length);
+    message[3] = type;
+    message[4] = frame_id;
+    message[5] = (uint8_t)digi_fields[field].code[0];
+    message[6] = (uint8_t)digi_fields[field].code[1];
+
+    return length;
+}
+
+static size_t digi_write_set_field(uint8_t * message, size_t size, uint8_t type, uint8_t frame_id, digi_field_t field, uint32_t value)
+{
+    if(field >= DIGI_FIELD_END || !digi_fields[field].writable || digi_fields[field].width > DIGI_FIELD_MAXIMUM_INTEGER_WIDTH)
+    {
+        return 0;
+    }
+
+    uint8_t width = digi_fields[field].width;
+    uint16_t length = digi_write_local_at(message, size, type, frame_id, field, width);
+
+    if(length == 0)
+    {
+        return 0;
+    }
+
+    digi_write_value(&message[7], value, width);
+
+    return digi_write_checksum(message, length);
+}
+
+static uint16_t digi_write_remote_at(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, uint8_t options, digi_field_t field, uint8_t value_length)
+{
+    uint16_t length = DIGI_REMOTE_AT_SIZE + value_length;
+
+    if(field >= DIGI_FIELD_END || size < (size_t)DIGI_FRAME_OVERHEAD + length)
+    {
+        return 0;
+    }
+
+    digi_write_header(message, length);
+
+    uint8_t * data = &message[DIGI_FRAME_HEADER_SIZE];
+    data[0] = DIGI_FRAME_REMOTE_AT;
+    data[1] = frame_id;
+    memcpy(&data[2], destination->serial, DIGI_SERIAL_LENGTH);
+    data[10] = (uint8_t)(DIGI_UNKNOWN_ADDRESS >> 8);
+    data[11] = (uint8_t)DIGI_UNKNOWN_ADDRESS;
+    data[12] = options;
+    data[13] = (uint8_t)digi_fields[field].code[0];
+    data[14] = (uint8_t)digi_fields[field].code[1];
+
+    return length;
+}
+
+static void digi_write_value(uint8_t * bytes, uint32_t value, uint8_t width)
+{
+    // Values go out most significant byte first
+    for(uint8_t idx = 0; idx < width; idx++)
+    {
+        bytes[idx] = (uint8_t)(value >> (8 * (width - 1 - idx)));
+    }
+
+    return;
+}
+
 /*******************************/
 /* PUBLIC FUNCTION DEFINITIONS */
 /*******************************/
 
-void digi_init(void)
+digi_t * digi_init(digi_context_storage_t * storage)
 {
-    memset(digi.serial, EMPTY_SERIAL, DIGI_SERIAL_LENGTH);
+    digi_t * digi = (digi_t *)storage;
+
+    memset(digi->serial, EMPTY_SERIAL, DIGI_SERIAL_LENGTH);
 
-    return;   
+    return digi;
 }
 
-bool digi_is_initialized()
+bool digi_is_initialized(const digi_t * digi)
 {
     // Check what the value of the digi state is to see if it's empty.
     // It's deemed empty if its serial is all empty values.
     for(uint8_t idx = 0; idx < DIGI_SERIAL_LENGTH; idx++)
     {
-        if(digi.serial[idx] == EMPTY_SERIAL){
+        if(digi->serial[idx] == EMPTY_SERIAL){
             continue;
         }
         else
@@ -111,16 +680,314 @@ bool digi_is_initialized()
     return false;
 }
 
-digi_status_t digi_get_serial(digi_serial_t * serial)
+digi_status_t digi_get_serial(const digi_t * digi, digi_serial_t * serial)
 {
-    memcpy(serial->serial, digi.serial, DIGI_SERIAL_LENGTH);
+    memcpy(serial->serial, digi->serial, DIGI_SERIAL_LENGTH);
 
     return DIGI_OK;
 }
 
-digi_status_t digi_register(digi_serial_t * serial)
+digi_status_t digi_register(digi_t * digi, digi_serial_t * serial)
 {
-    memcpy(digi.serial, &(serial->serial[0]), DIGI_SERIAL_LENGTH);
+    memcpy(digi->serial, &(serial->serial[0]), DIGI_SERIAL_LENGTH);
 
     return DIGI_OK;
-}
\ No newline at end of file
+}
+
+void digi_parser_init(digi_parser_t * parser)
+{
+    parser->state = DIGI_PARSER_HUNT;
+    parser->sum = 0;
+    parser->length = 0;
+    parser->stored = 0;
+    parser->replay_start = 0;
+    parser->replay_length = 0;
+    parser->discarded = 0;
+    parser->resyncs = 0;
+
+    return;
+}
+
+digi_parse_result_t digi_parser_feed(digi_parser_t * parser, const uint8_t * bytes, size_t size, size_t * consumed, digi_frame_view_t * frame)
+{
+    // Bytes kept back from a dropped frame come before any new input
+    while(parser->replay_length > 0)
+    {
+        uint16_t start = parser->replay_start;
+        uint16_t length = parser->replay_length;
+        size_t used = 0;
+
+        parser->replay_length = 0;
+        digi_parse_result_t result = digi_parser_run(parser, &parser->buffer[start], length, &used, frame);
+
+        // Gathering only ever writes to the buffer behind where it's reading so the unread bytes are intact.
+        // If another frame was dropped they follow whatever it kept back, otherwise they are all that's left.
+        size_t unread = length - used;
+        if(parser->replay_length == 0)
+        {
+            parser->replay_start = start + (uint16_t)used;
+            parser->replay_length = (uint16_t)unread;
+        }
+        else if(unread > 0)
+        {
+            memmove(&parser->buffer[parser->replay_start + parser->replay_length], &parser->buffer[start + used], unread);
+            parser->replay_length += (uint16_t)unread;
+        }
+
+        if(result != DIGI_PARSE_NEED_MORE)
+        {
+            *consumed = 0;
+            return result;
+        }
+    }
+
+    if(size == 0)
+    {
+        *consumed = 0;
+        return DIGI_PARSE_NEED_MORE;
+    }
+
+    return digi_parser_run(parser, bytes, size, consumed, frame);
+}
+
+uint32_t digi_parser_discarded(const digi_parser_t * parser)
+{
+    return parser->discarded;
+}
+
+uint32_t digi_parser_resyncs(const digi_parser_t * parser)
+{
+    return parser->resyncs;
+}
+
+const digi_field_info_t * digi_field_info(digi_field_t field)
+{
+    if(field >= DIGI_FIELD_END)
+    {
+        return NULL;
+    }
+
+    return &digi_fields[field];
+}
+
+digi_field_t digi_field_from_code(const uint8_t * code)
+{
+    uint8_t slot = digi_field_hash[DIGI_FIELD_HASH(code[0], code[1])];
+
+    if(slot == 0)
+    {
+        return DIGI_FIELD_END;
+    }
+
+    // Codes that aren't known can land on a used slot so check it really is this one
+    digi_field_t field = (digi_field_t)(slot - 1);
+    if(digi_fields[field].code[0] != (char)code[0] || digi_fields[field].code[1] != (char)code[1])
+    {
+        return DIGI_FIELD_END;
+    }
+
+    return field;
+}
+
+size_t digi_generate_set_field_message(uint8_t * message, size_t size, uint8_t frame_id, digi_field_t field, uint32_t value)
+{
+    return digi_write_set_field(message, size, DIGI_FRAME_LOCAL_AT, frame_id, field, value);
+}
+
+size_t digi_generate_get_field_message(uint8_t * message, size_t size, uint8_t frame_id, digi_field_t field)
+{
+    uint16_t length = digi_write_local_at(message, size, DIGI_FRAME_LOCAL_AT, frame_id, field, 0);
+
+    if(length == 0)
+    {
+        return 0;
+    }
+
+    return digi_write_checksum(message, length);
+}
+
+size_t digi_generate_configuration(uint8_t * message, size_t size, uint8_t frame_id, const digi_setting_t * settings, size_t count)
+{
+    size_t total = 0;
+
+    // Queued values don't take effect until AC so they need no response of their own
+    for(size_t idx = 0; idx < count; idx++)
+    {
+        size_t written = digi_write_set_field(&message[total], size - total, DIGI_FRAME_LOCAL_AT_QUEUE, 0, settings[idx].field, settings[idx].value);
+
+        if(written == 0)
+        {
+            return 0;
+        }
+
+        total += written;
+    }
+
+    uint16_t length = digi_write_local_at(&message[total], size - total, DIGI_FRAME_LOCAL_AT, frame_id, DIGI_FIELD_AC, 0);
+
+    if(length == 0)
+    {
+        return 0;
+    }
+
+    return total + digi_write_checksum(&message[total], length);
+}
+
+size_t digi_generate_remote_set_field_message(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, uint8_t options, digi_field_t field, uint32_t value)
+{
+    if(field >= DIGI_FIELD_END || !digi_fields[field].writable || digi_fields[field].width > DIGI_FIELD_MAXIMUM_INTEGER_WIDTH)
+    {
+        return 0;
+    }
+
+    uint8_t width = digi_fields[field].width;
+    uint16_t length = digi_write_remote_at(message, size, frame_id, destination, options, field, width);
+
+    if(length == 0)
+    {
+        return 0;
+    }
+
+    digi_write_value(&message[DIGI_FRAME_HEADER_SIZE + DIGI_REMOTE_AT_SIZE], value, width);
+
+    return digi_write_checksum(message, length);
+}
+
+size_t digi_generate_remote_get_field_message(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, digi_field_t field)
+{
+    uint16_t length = digi_write_remote_at(message, size, frame_id, destination, 0, field, 0);
+
+    if(length == 0)
+    {
+        return 0;
+    }
+
+    return digi_write_checksum(message, length);
+}
+
+size_t digi_generate_transmit_request(uint8_t * message, size_t size, uint8_t frame_id, const digi_serial_t * destination, uint8_t options, const digi_payload_t * payload, size_t count)
+{
+    size_t length = DIGI_TRANSMIT_REQUEST_SIZE;
+
+    for(size_t idx = 0; idx < count; idx++)
+    {
+        length += payload[idx].length;
+    }
+
+    if(length > UINT16_MAX || size < DIGI_FRAME_OVERHEAD + length)
+    {
+        return 0;
+    }
+
+    digi_write_header(message, (uint16_t)length);
+
+    uint8_t * data = &message[DIGI_FRAME_HEADER_SIZE];
+    data[0] = DIGI_FRAME_TRANSMIT_REQUEST;
+    data[1] = frame_id;
+    memcpy(&data[2], destination->serial, DIGI_SERIAL_LENGTH);
+    data[10] = (uint8_t)(DIGI_UNKNOWN_ADDRESS >> 8);
+    data[11] = (uint8_t)DIGI_UNKNOWN_ADDRESS;
+    data[12] = 0;   // Broadcast radius, 0 is the maximum number of hops
+    data[13] = options;
+
+    uint8_t sum = digi_sum(0, data, DIGI_TRANSMIT_REQUEST_SIZE);
+    uint8_t * cursor = &data[DIGI_TRANSMIT_REQUEST_SIZE];
+    for(size_t idx = 0; idx < count; idx++)
+    {
+        sum = digi_copy_sum(sum, cursor, payload[idx].data, payload[idx].length);
+        cursor += payload[idx].length;
+    }
+    *cursor = 0xFF - sum;
+
+    return DIGI_FRAME_OVERHEAD + length;
+}
+
+digi_status_t digi_retarget_transmit_request(uint8_t * message, size_t length, uint8_t frame_id, const digi_serial_t * destination)
+{
+    if(length < DIGI_FRAME_OVERHEAD + DIGI_TRANSMIT_REQUEST_SIZE || message[0] != DIGI_START_DELIMITER ||
+       (((size_t)message[1] << 8) | message[2]) != length - DIGI_FRAME_OVERHEAD ||
+       message[DIGI_FRAME_HEADER_SIZE] != DIGI_FRAME_TRANSMIT_REQUEST)
+    {
+        return DIGI_ERROR;
+    }
+
+    // The frame id and destination sit next to each other after the frame type
+    uint8_t * patched = &message[DIGI_FRAME_HEADER_SIZE + 1];
+    uint8_t removed = digi_sum(0, patched, 1 + DIGI_SERIAL_LENGTH);
+
+    patched[0] = frame_id;
+    memcpy(&patched[1], destination->serial, DIGI_SERIAL_LENGTH);
+
+    // The checksum is 0xFF less the sum so it moves against the change in the sum
+    uint8_t added = digi_sum(0, patched, 1 + DIGI_SERIAL_LENGTH);
+    message[length - 1] = (uint8_t)(message[length - 1] + removed - added);
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_decode_receive_packet(const digi_frame_view_t * frame, digi_receive_packet_t * packet)
+{
+    if(frame->type != DIGI_FRAME_RECEIVE_PACKET || frame->length < DIGI_RECEIVE_PACKET_SIZE)
+    {
+        return DIGI_ERROR;
+    }
+
+    memcpy(packet->source.serial, frame->data, DIGI_SERIAL_LENGTH);
+    packet->options = frame->data[10];
+    packet->payload = &frame->data[DIGI_RECEIVE_PACKET_SIZE];
+    packet->length = frame->length - DIGI_RECEIVE_PACKET_SIZE;
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_decode_at_response(const digi_frame_view_t * frame, digi_at_response_t * response)
+{
+    if(frame->type != DIGI_FRAME_LOCAL_AT_RESPONSE || frame->length < DIGI_AT_RESPONSE_SIZE)
+    {
+        return DIGI_ERROR;
+    }
+
+    response->frame_id = frame->data[0];
+    response->code[0] = frame->data[1];
+    response->code[1] = frame->data[2];
+    response->field = digi_field_from_code(&frame->data[1]);
+    response->status = frame->data[3];
+    response->value = &frame->data[DIGI_AT_RESPONSE_SIZE];
+    response->length = frame->length - DIGI_AT_RESPONSE_SIZE;
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_decode_transmit_status(const digi_frame_view_t * frame, digi_transmit_status_t * status)
+{
+    if(frame->type != DIGI_FRAME_TRANSMIT_STATUS || frame->length < DIGI_TRANSMIT_STATUS_SIZE)
+    {
+        return DIGI_ERROR;
+    }
+
+    status->frame_id = frame->data[0];
+    status->retries = frame->data[3];
+    status->delivery = frame->data[4];
+    status->discovery = frame->data[5];
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_decode_remote_at_response(const digi_frame_view_t * frame, digi_remote_at_response_t * response)
+{
+    if(frame->type != DIGI_FRAME_REMOTE_AT_RESPONSE || frame->length < DIGI_REMOTE_AT_RESPONSE_SIZE)
+    {
+        return DIGI_ERROR;
+    }
+
+    memcpy(response->source.serial, &frame->data[1], DIGI_SERIAL_LENGTH);
+    response->response.frame_id = frame->data[0];
+    response->response.code[0] = frame->data[11];
+    response->response.code[1] = frame->data[12];
+    response->response.field = digi_field_from_code(&frame->data[11]);
+    response->response.status = frame->data[13];
+    response->response.value = &frame->data[DIGI_REMOTE_AT_RESPONSE_SIZE];
+    response->response.length = frame->length - DIGI_REMOTE_AT_RESPONSE_SIZE;
+
+    return DIGI_OK;
+}
@@ -0,0 +1,133 @@
+#include "c_driver_digimesh_pending.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Number of frame ids that can be handed out, every value but 0.
+ */
+#define DIGI_PENDING_IDS (DIGI_PENDING_SLOTS - 1)
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Mark a frame id unused and put it at the back of the free queue.
+ * 
+ * @param pending - the pending table
+ * @param frame_id - the frame id to free
+ */
+static void digi_pending_free(digi_pending_t * pending, uint8_t frame_id);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static void digi_pending_free(digi_pending_t * pending, uint8_t frame_id)
+{
+    pending->entries[frame_id].active = false;
+    pending->free_ids[(uint8_t)(pending->free_head + pending->free_count)] = frame_id;
+    pending->free_count++;
+
+    return;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+void digi_pending_init(digi_pending_t * pending)
+{
+    memset(pending->entries, 0, sizeof(pending->entries));
+
+    for(uint16_t idx = 0; idx < DIGI_PENDING_IDS; idx++)
+    {
+        pending->free_ids[idx] = (uint8_t)(idx + 1);
+    }
+    pending->free_head = 0;
+    pending->free_count = DIGI_PENDING_IDS;
+
+    return;
+}
+
+digi_status_t digi_pending_add(digi_pending_t * pending, digi_pending_callback_t callback, void * context, uint8_t * frame_id)
+{
+    if(pending->free_count == 0)
+    {
+        return DIGI_ERROR;
+    }
+
+    uint8_t id = pending->free_ids[pending->free_head++];
+    pending->free_count--;
+
+    pending->entries[id].callback = callback;
+    pending->entries[id].context = context;
+    pending->entries[id].active = true;
+
+    *frame_id = id;
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_pending_complete(digi_pending_t * pending, const digi_frame_view_t * frame)
+{
+    switch(frame->type)
+    {
+        case DIGI_FRAME_LOCAL_AT_RESPONSE:
+        case DIGI_FRAME_TRANSMIT_STATUS:
+        case DIGI_FRAME_REMOTE_AT_RESPONSE:
+            break;
+
+        default:
+            return DIGI_ERROR;
+    }
+
+    if(frame->length == 0)
+    {
+        return DIGI_ERROR;
+    }
+
+    uint8_t id = frame->data[0];
+    digi_pending_entry_t entry = pending->entries[id];
+
+    if(id == 0 || !entry.active)
+    {
+        return DIGI_ERROR;
+    }
+
+    // Free the id first so the callback can reuse it for a follow up request
+    digi_pending_free(pending, id);
+
+    if(entry.callback != NULL)
+    {
+        entry.callback(entry.context, frame);
+    }
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_pending_cancel(digi_pending_t * pending, uint8_t frame_id)
+{
+    if(frame_id == 0 || !pending->entries[frame_id].active)
+    {
+        return DIGI_ERROR;
+    }
+
+    digi_pending_free(pending, frame_id);
+
+    return DIGI_OK;
+}
+
+bool digi_pending_is_active(const digi_pending_t * pending, uint8_t frame_id)
+{
+    return pending->entries[frame_id].active;
+}
+
+uint16_t digi_pending_count(const digi_pending_t * pending)
+{
+    return DIGI_PENDING_IDS - pending->free_count;
+}
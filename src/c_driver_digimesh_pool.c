@@ -0,0 +1,297 @@
+#include "c_driver_digimesh_pool.h"
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+#ifdef DIGI_POOL_THREADS
+
+/**
+ * @brief Spin until the pool is ours. Pool operations are a handful of pointer moves so a spin lock is cheaper
+ * than sleeping.
+ */
+#define POOL_LOCK(pool) while(__atomic_test_and_set(&(pool)->lock, __ATOMIC_ACQUIRE)) {}
+
+/**
+ * @brief Let other threads at the pool.
+ */
+#define POOL_UNLOCK(pool) __atomic_clear(&(pool)->lock, __ATOMIC_RELEASE)
+
+#else
+
+#define POOL_LOCK(pool)
+#define POOL_UNLOCK(pool)
+
+#endif
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Find the block a pointer points into.
+ * 
+ * @param pool - the pool
+ * @param pointer - a pointer into a block
+ * 
+ * @return digi_pool_block_t* - the block or NULL if the pointer isn't into this pool
+ */
+static digi_pool_block_t * digi_pool_block(const digi_pool_t * pool, const uint8_t * pointer);
+
+/**
+ * @brief Check whether a block is on a free list, to catch a block given back twice.
+ * 
+ * @param list - first block of the list
+ * @param block - the block
+ * 
+ * @return true - the block is already free
+ * @return false - the block is in use
+ */
+static bool digi_pool_listed(const digi_pool_block_t * list, const digi_pool_block_t * block);
+
+/**
+ * @brief Take up to count blocks off the free list in one go.
+ * 
+ * @param pool - the pool
+ * @param count - most blocks to take
+ * @param taken - populated with the number of blocks taken
+ * 
+ * @return digi_pool_block_t* - the blocks, linked through next, or NULL if none were free
+ */
+static digi_pool_block_t * digi_pool_take(digi_pool_t * pool, uint32_t count, uint32_t * taken);
+
+/**
+ * @brief Put a linked chain of blocks back on the free list in one go.
+ * 
+ * @param pool - the pool
+ * @param first - first block of the chain
+ * @param last - last block of the chain
+ * @param count - number of blocks in the chain
+ */
+static void digi_pool_give(digi_pool_t * pool, digi_pool_block_t * first, digi_pool_block_t * last, uint32_t count);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static digi_pool_block_t * digi_pool_block(const digi_pool_t * pool, const uint8_t * pointer)
+{
+    uintptr_t start = (uintptr_t)pool->blocks;
+    uintptr_t address = (uintptr_t)pointer;
+
+    if(address < start || address >= start + (uintptr_t)pool->count * sizeof(digi_pool_block_t))
+    {
+        return NULL;
+    }
+
+    return &pool->blocks[(address - start) / sizeof(digi_pool_block_t)];
+}
+
+static bool digi_pool_listed(const digi_pool_block_t * list, const digi_pool_block_t * block)
+{
+    while(list != NULL)
+    {
+        if(list == block)
+        {
+            return true;
+        }
+        list = list->next;
+    }
+
+    return false;
+}
+
+static digi_pool_block_t * digi_pool_take(digi_pool_t * pool, uint32_t count, uint32_t * taken)
+{
+    POOL_LOCK(pool);
+
+    digi_pool_block_t * first = pool->free;
+    digi_pool_block_t * last = NULL;
+    uint32_t idx = 0;
+
+    while(idx < count && pool->free != NULL)
+    {
+        last = pool->free;
+        pool->free = last->next;
+        idx++;
+    }
+
+    if(last != NULL)
+    {
+        last->next = NULL;
+    }
+    else
+    {
+        first = NULL;
+        pool->failures++;
+    }
+
+    pool->used += idx;
+    if(pool->used > pool->high_water)
+    {
+        pool->high_water = pool->used;
+    }
+
+    POOL_UNLOCK(pool);
+
+    *taken = idx;
+    return first;
+}
+
+static void digi_pool_give(digi_pool_t * pool, digi_pool_block_t * first, digi_pool_block_t * last, uint32_t count)
+{
+    POOL_LOCK(pool);
+
+    last->next = pool->free;
+    pool->free = first;
+    pool->used -= count;
+
+    POOL_UNLOCK(pool);
+
+    return;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+digi_status_t digi_pool_init(digi_pool_t * pool, digi_pool_block_t * blocks, uint32_t count, size_t block_size)
+{
+    // A caller built with a different DIGI_POOL_BLOCK_SIZE lays its blocks out at a different stride
+    if(count == 0 || block_size != DIGI_POOL_BLOCK_SIZE)
+    {
+        return DIGI_ERROR;
+    }
+
+    for(uint32_t idx = 0; idx + 1 < count; idx++)
+    {
+        blocks[idx].next = &blocks[idx + 1];
+    }
+    blocks[count - 1].next = NULL;
+
+    pool->blocks = blocks;
+    pool->free = blocks;
+    pool->count = count;
+    pool->used = 0;
+    pool->high_water = 0;
+    pool->failures = 0;
+    pool->lock = 0;
+
+    return DIGI_OK;
+}
+
+uint8_t * digi_pool_alloc(digi_pool_t * pool)
+{
+    uint32_t taken;
+    digi_pool_block_t * block = digi_pool_take(pool, 1, &taken);
+
+    return (block != NULL) ? block->data : NULL;
+}
+
+digi_status_t digi_pool_free(digi_pool_t * pool, const uint8_t * block)
+{
+    digi_pool_block_t * found = digi_pool_block(pool, block);
+
+    if(found == NULL)
+    {
+        return DIGI_ERROR;
+    }
+
+    // Linking a free block in again would loop the free list
+    POOL_LOCK(pool);
+    bool listed = (pool->used == 0) || digi_pool_listed(pool->free, found);
+    if(!listed)
+    {
+        found->next = pool->free;
+        pool->free = found;
+        pool->used--;
+    }
+    POOL_UNLOCK(pool);
+
+    return listed ? DIGI_ERROR : DIGI_OK;
+}
+
+uint8_t * digi_pool_cache_alloc(digi_pool_cache_t * cache, digi_pool_t * pool)
+{
+    if(cache->free == NULL)
+    {
+        cache->free = digi_pool_take(pool, DIGI_POOL_CACHE_BATCH, &cache->count);
+
+        if(cache->free == NULL)
+        {
+            return NULL;
+        }
+    }
+
+    digi_pool_block_t * block = cache->free;
+    cache->free = block->next;
+    cache->count--;
+
+    return block->data;
+}
+
+digi_status_t digi_pool_cache_free(digi_pool_cache_t * cache, digi_pool_t * pool, const uint8_t * block)
+{
+    digi_pool_block_t * found = digi_pool_block(pool, block);
+
+    if(found == NULL || digi_pool_listed(cache->free, found))
+    {
+        return DIGI_ERROR;
+    }
+
+    found->next = cache->free;
+    cache->free = found;
+    cache->count++;
+
+    // Keep one batch for the next allocations and hand the rest back
+    if(cache->count >= 2 * DIGI_POOL_CACHE_BATCH)
+    {
+        digi_pool_block_t * last = cache->free;
+        for(uint32_t idx = 1; idx < DIGI_POOL_CACHE_BATCH; idx++)
+        {
+            last = last->next;
+        }
+
+        digi_pool_block_t * kept = last->next;
+        digi_pool_give(pool, cache->free, last, DIGI_POOL_CACHE_BATCH);
+        cache->free = kept;
+        cache->count -= DIGI_POOL_CACHE_BATCH;
+    }
+
+    return DIGI_OK;
+}
+
+void digi_pool_cache_drain(digi_pool_cache_t * cache, digi_pool_t * pool)
+{
+    if(cache->free == NULL)
+    {
+        return;
+    }
+
+    digi_pool_block_t * last = cache->free;
+    while(last->next != NULL)
+    {
+        last = last->next;
+    }
+
+    digi_pool_give(pool, cache->free, last, cache->count);
+    cache->free = NULL;
+    cache->count = 0;
+
+    return;
+}
+
+uint32_t digi_pool_used(const digi_pool_t * pool)
+{
+    return pool->used;
+}
+
+uint32_t digi_pool_high_water(const digi_pool_t * pool)
+{
+    return pool->high_water;
+}
+
+uint32_t digi_pool_failures(const digi_pool_t * pool)
+{
+    return pool->failures;
+}
@@ -0,0 +1,268 @@
+#include "c_driver_digimesh_remote.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Response status meaning the command never reached the remote digi module, which is worth retrying.
+ */
+#define DIGI_REMOTE_TRANSMISSION_FAILED 0x04
+
+/**
+ * @brief Most times the backoff is doubled.
+ */
+#define DIGI_REMOTE_MAXIMUM_BACKOFF_SHIFT 16
+
+/**
+ * @brief Longest wait before a retry, the furthest ahead digi_remote_reached can tell apart from the past.
+ */
+#define DIGI_REMOTE_MAXIMUM_BACKOFF (UINT32_MAX / 2)
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Schedule a request to be sent again after its backoff, or give up on it once it has used every
+ * attempt.
+ * 
+ * @param remote - the engine
+ * @param slot - the request's slot
+ */
+static void digi_remote_retry(digi_remote_t * remote, digi_remote_slot_t * slot);
+
+/**
+ * @brief Handle a remote AT command response. Matches digi_pending_callback_t.
+ * 
+ * @param context - the engine
+ * @param frame - the response
+ */
+static void digi_remote_response(void * context, const digi_frame_view_t * frame);
+
+/**
+ * @brief Check whether a time has been reached.
+ * 
+ * @param now - the current time
+ * @param when - the time
+ * 
+ * @return true - now is at or after when
+ * @return false - when is still to come
+ */
+static bool digi_remote_reached(uint32_t now, uint32_t when);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static void digi_remote_retry(digi_remote_t * remote, digi_remote_slot_t * slot)
+{
+    slot->waiting = false;
+
+    if(slot->attempts >= remote->attempts)
+    {
+        slot->active = false;
+        remote->failures++;
+        remote->callback(remote->context, &slot->request, NULL);
+        return;
+    }
+
+    uint8_t shift = slot->attempts - 1;
+    if(shift > DIGI_REMOTE_MAXIMUM_BACKOFF_SHIFT)
+    {
+        shift = DIGI_REMOTE_MAXIMUM_BACKOFF_SHIFT;
+    }
+
+    // Saturate rather than let a large backoff overflow
+    uint32_t backoff = (remote->backoff > (DIGI_REMOTE_MAXIMUM_BACKOFF >> shift)) ? DIGI_REMOTE_MAXIMUM_BACKOFF : remote->backoff << shift;
+
+    slot->due = remote->now + backoff;
+    remote->retries++;
+
+    return;
+}
+
+static void digi_remote_response(void * context, const digi_frame_view_t * frame)
+{
+    digi_remote_t * remote = context;
+    digi_remote_at_response_t response;
+
+    if(digi_decode_remote_at_response(frame, &response) != DIGI_OK)
+    {
+        return;
+    }
+
+    for(uint8_t idx = 0; idx < remote->window; idx++)
+    {
+        digi_remote_slot_t * slot = &remote->slots[idx];
+
+        if(!slot->active || !slot->waiting || slot->frame_id != response.response.frame_id)
+        {
+            continue;
+        }
+
+        if(response.response.status == DIGI_REMOTE_TRANSMISSION_FAILED)
+        {
+            digi_remote_retry(remote, slot);
+        }
+        else
+        {
+            slot->active = false;
+            slot->waiting = false;
+            remote->callback(remote->context, &slot->request, &response);
+        }
+        return;
+    }
+
+    return;
+}
+
+static bool digi_remote_reached(uint32_t now, uint32_t when)
+{
+    // Unsigned subtraction keeps working when the caller's clock wraps
+    return (uint32_t)(now - when) < UINT32_MAX / 2;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+digi_status_t digi_remote_init(digi_remote_t * remote, digi_pending_t * pending, uint8_t window, uint8_t attempts, uint32_t timeout, uint32_t backoff, digi_remote_callback_t callback, void * context)
+{
+    if(window == 0 || window > DIGI_REMOTE_MAXIMUM_WINDOW || attempts == 0)
+    {
+        return DIGI_ERROR;
+    }
+
+    memset(remote, 0, sizeof(*remote));
+    remote->pending = pending;
+    remote->window = window;
+    remote->attempts = attempts;
+    remote->timeout = timeout;
+    remote->backoff = backoff;
+    remote->callback = callback;
+    remote->context = context;
+
+    return DIGI_OK;
+}
+
+void digi_remote_start(digi_remote_t * remote, const digi_remote_request_t * requests, size_t count)
+{
+    remote->requests = requests;
+    remote->count = count;
+    remote->next = 0;
+
+    return;
+}
+
+size_t digi_remote_poll(digi_remote_t * remote, uint8_t * message, size_t size, uint32_t now)
+{
+    size_t total = 0;
+
+    remote->now = now;
+
+    // Give up waiting on every overdue response and free its frame id before sending stops early below
+    for(uint8_t idx = 0; idx < remote->window; idx++)
+    {
+        digi_remote_slot_t * slot = &remote->slots[idx];
+
+        if(slot->active && slot->waiting && digi_remote_reached(now, slot->due))
+        {
+            digi_pending_cancel(remote->pending, slot->frame_id);
+            digi_remote_retry(remote, slot);
+        }
+    }
+
+    for(uint8_t idx = 0; idx < remote->window; idx++)
+    {
+        digi_remote_slot_t * slot = &remote->slots[idx];
+
+        // Fill the window with new requests
+        if(!slot->active && remote->next < remote->count)
+        {
+            slot->request = remote->requests[remote->next++];
+            slot->attempts = 0;
+            slot->due = now;
+            slot->waiting = false;
+            slot->active = true;
+        }
+
+        if(!slot->active || slot->waiting || !digi_remote_reached(now, slot->due))
+        {
+            continue;
+        }
+
+        const digi_remote_request_t * request = &slot->request;
+        uint8_t frame_id;
+        size_t written;
+
+        if(digi_pending_add(remote->pending, digi_remote_response, remote, &frame_id) != DIGI_OK)
+        {
+            break;
+        }
+
+        if(request->set)
+        {
+            written = digi_generate_remote_set_field_message(&message[total], size - total, frame_id, &request->destination, request->options, request->field, request->value);
+        }
+        else
+        {
+            written = digi_generate_remote_get_field_message(&message[total], size - total, frame_id, &request->destination, request->field);
+        }
+
+        if(written == 0)
+        {
+            digi_pending_cancel(remote->pending, frame_id);
+
+            // Out of room, the rest go out on the next poll
+            if(total > 0)
+            {
+                break;
+            }
+
+            // Doesn't fit in an empty buffer, so it never will. Give up rather than block the window.
+            slot->active = false;
+            remote->failures++;
+            remote->callback(remote->context, request, NULL);
+            continue;
+        }
+
+        total += written;
+        slot->frame_id = frame_id;
+        slot->attempts++;
+        slot->due = now + remote->timeout;
+        slot->waiting = true;
+    }
+
+    return total;
+}
+
+bool digi_remote_done(const digi_remote_t * remote)
+{
+    if(remote->next < remote->count)
+    {
+        return false;
+    }
+
+    for(uint8_t idx = 0; idx < remote->window; idx++)
+    {
+        if(remote->slots[idx].active)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+uint32_t digi_remote_retries(const digi_remote_t * remote)
+{
+    return remote->retries;
+}
+
+uint32_t digi_remote_failures(const digi_remote_t * remote)
+{
+    return remote->failures;
+}
@@ -0,0 +1,131 @@
+#include "c_driver_digimesh_ring.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Read an index written by the other side. Acquire ordering makes the bytes it covers visible.
+ */
+#define RING_LOAD_ACQUIRE(index) __atomic_load_n(&(index), __ATOMIC_ACQUIRE)
+
+/**
+ * @brief Read an index only this side writes.
+ */
+#define RING_LOAD_RELAXED(index) __atomic_load_n(&(index), __ATOMIC_RELAXED)
+
+/**
+ * @brief Publish an index. Release ordering makes the bytes written before it visible to the other side.
+ */
+#define RING_STORE_RELEASE(index, value) __atomic_store_n(&(index), (value), __ATOMIC_RELEASE)
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+digi_status_t digi_ring_init(digi_ring_t * ring, uint8_t * buffer, size_t size)
+{
+    if(size == 0 || (size & (size - 1)) != 0)
+    {
+        return DIGI_ERROR;
+    }
+
+    ring->buffer = buffer;
+    ring->mask = size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->overruns = 0;
+
+    return DIGI_OK;
+}
+
+size_t digi_ring_push(digi_ring_t * ring, const uint8_t * bytes, size_t size)
+{
+    size_t stored = 0;
+
+    // At most two regions, before and after the wrap
+    while(stored < size)
+    {
+        uint8_t * region;
+        size_t count = digi_ring_write_peek(ring, &region);
+
+        if(count == 0)
+        {
+            break;
+        }
+        if(count > size - stored)
+        {
+            count = size - stored;
+        }
+
+        memcpy(region, &bytes[stored], count);
+        digi_ring_write_commit(ring, count);
+        stored += count;
+    }
+
+    if(stored < size)
+    {
+        digi_ring_record_overrun(ring, size - stored);
+    }
+
+    return stored;
+}
+
+size_t digi_ring_write_peek(digi_ring_t * ring, uint8_t ** region)
+{
+    size_t head = RING_LOAD_RELAXED(ring->head);
+    size_t tail = RING_LOAD_ACQUIRE(ring->tail);
+    size_t offset = head & ring->mask;
+    size_t free = (ring->mask + 1) - (head - tail);
+    size_t until_wrap = (ring->mask + 1) - offset;
+
+    *region = &ring->buffer[offset];
+
+    return (free < until_wrap) ? free : until_wrap;
+}
+
+void digi_ring_write_commit(digi_ring_t * ring, size_t size)
+{
+    RING_STORE_RELEASE(ring->head, RING_LOAD_RELAXED(ring->head) + size);
+
+    return;
+}
+
+void digi_ring_record_overrun(digi_ring_t * ring, size_t size)
+{
+    RING_STORE_RELEASE(ring->overruns, RING_LOAD_RELAXED(ring->overruns) + (uint32_t)size);
+
+    return;
+}
+
+size_t digi_ring_read_peek(const digi_ring_t * ring, const uint8_t ** region)
+{
+    size_t tail = RING_LOAD_RELAXED(ring->tail);
+    size_t head = RING_LOAD_ACQUIRE(ring->head);
+    size_t offset = tail & ring->mask;
+    size_t used = head - tail;
+    size_t until_wrap = (ring->mask + 1) - offset;
+
+    *region = &ring->buffer[offset];
+
+    return (used < until_wrap) ? used : until_wrap;
+}
+
+void digi_ring_read_commit(digi_ring_t * ring, size_t size)
+{
+    RING_STORE_RELEASE(ring->tail, RING_LOAD_RELAXED(ring->tail) + size);
+
+    return;
+}
+
+size_t digi_ring_used(const digi_ring_t * ring)
+{
+    return RING_LOAD_ACQUIRE(ring->head) - RING_LOAD_ACQUIRE(ring->tail);
+}
+
+uint32_t digi_ring_overruns(const digi_ring_t * ring)
+{
+    return RING_LOAD_ACQUIRE(ring->overruns);
+}
@@ -0,0 +1,262 @@
+#include "c_driver_digimesh_snapshot.h"
+
+#include <string.h>
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief First bytes of every snapshot.
+ */
+static const uint8_t digi_snapshot_magic[4] = {'D', 'G', 'S', 'N'};
+
+/**
+ * @brief Where each header value sits in a snapshot.
+ */
+#define DIGI_SNAPSHOT_VERSION_OFFSET 4
+#define DIGI_SNAPSHOT_SIZE_OFFSET 8
+#define DIGI_SNAPSHOT_CHECKSUM_OFFSET 12
+#define DIGI_SNAPSHOT_FIELDS_OFFSET 16
+#define DIGI_SNAPSHOT_NODES_OFFSET 20
+#define DIGI_SNAPSHOT_SERIAL_OFFSET 24
+
+/**
+ * @brief FNV-1a parameters for the checksum.
+ */
+#define DIGI_SNAPSHOT_FNV_OFFSET 0x811C9DC5u
+#define DIGI_SNAPSHOT_FNV_PRIME 0x01000193u
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Write a number little endian.
+ * 
+ * @param bytes - where to write
+ * @param value - the number
+ * @param width - bytes to write
+ */
+static void digi_snapshot_put(uint8_t * bytes, uint64_t value, uint8_t width);
+
+/**
+ * @brief Read a little endian number.
+ * 
+ * @param bytes - where to read
+ * @param width - bytes to read
+ * 
+ * @return uint64_t 
+ */
+static uint64_t digi_snapshot_get(const uint8_t * bytes, uint8_t width);
+
+/**
+ * @brief Checksum of everything after the checksum in the header.
+ * 
+ * @param buffer - the snapshot
+ * @param size - total size of the snapshot
+ * 
+ * @return uint32_t 
+ */
+static uint32_t digi_snapshot_checksum(const uint8_t * buffer, size_t size);
+
+/**
+ * @brief Check whether a field has a value in a cache.
+ * 
+ * @param cache - the cache
+ * @param field - the field
+ * 
+ * @return true - the field's value is known
+ * @return false - the field's value isn't known
+ */
+static bool digi_snapshot_is_cached(const digi_cache_t * cache, digi_field_t field);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static void digi_snapshot_put(uint8_t * bytes, uint64_t value, uint8_t width)
+{
+    for(uint8_t idx = 0; idx < width; idx++)
+    {
+        bytes[idx] = (uint8_t)(value >> (8 * idx));
+    }
+
+    return;
+}
+
+static uint64_t digi_snapshot_get(const uint8_t * bytes, uint8_t width)
+{
+    uint64_t value = 0;
+
+    for(uint8_t idx = width; idx > 0; idx--)
+    {
+        value = (value << 8) | bytes[idx - 1];
+    }
+
+    return value;
+}
+
+static uint32_t digi_snapshot_checksum(const uint8_t * buffer, size_t size)
+{
+    uint32_t hash = DIGI_SNAPSHOT_FNV_OFFSET;
+
+    for(size_t idx = DIGI_SNAPSHOT_FIELDS_OFFSET; idx < size; idx++)
+    {
+        hash = (hash ^ buffer[idx]) * DIGI_SNAPSHOT_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+static bool digi_snapshot_is_cached(const digi_cache_t * cache, digi_field_t field)
+{
+    return cache->generations[field] == cache->generation;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+size_t digi_snapshot_size(const digi_cache_t * cache, const digi_node_table_t * nodes)
+{
+    size_t size = DIGI_SNAPSHOT_HEADER_SIZE;
+
+    if(cache != NULL)
+    {
+        for(digi_field_t field = 0; field < DIGI_FIELD_END; field++)
+        {
+            size += digi_snapshot_is_cached(cache, field) ? DIGI_SNAPSHOT_FIELD_SIZE : 0;
+        }
+    }
+
+    if(nodes != NULL)
+    {
+        size += (size_t)digi_nodes_count(nodes) * DIGI_SNAPSHOT_NODE_SIZE;
+    }
+
+    return size;
+}
+
+size_t digi_snapshot_save(uint8_t * buffer, size_t size, const digi_t * digi, const digi_cache_t * cache, const digi_node_table_t * nodes)
+{
+    size_t total = digi_snapshot_size(cache, nodes);
+    digi_serial_t serial;
+    uint32_t field_count = 0;
+    uint32_t node_count = 0;
+
+    if(size < total || total > UINT32_MAX)
+    {
+        return 0;
+    }
+
+    memset(buffer, 0, total);
+    uint8_t * cursor = &buffer[DIGI_SNAPSHOT_HEADER_SIZE];
+
+    if(cache != NULL)
+    {
+        for(digi_field_t field = 0; field < DIGI_FIELD_END; field++)
+        {
+            if(!digi_snapshot_is_cached(cache, field))
+            {
+                continue;
+            }
+
+            const digi_field_info_t * info = digi_field_info(field);
+            cursor[0] = (uint8_t)info->code[0];
+            cursor[1] = (uint8_t)info->code[1];
+            digi_snapshot_put(&cursor[4], cache->values[field], 4);
+            cursor += DIGI_SNAPSHOT_FIELD_SIZE;
+            field_count++;
+        }
+    }
+
+    if(nodes != NULL)
+    {
+        for(uint32_t idx = 0; idx <= nodes->mask; idx++)
+        {
+            const digi_node_t * node = &nodes->nodes[idx];
+
+            if(!node->used)
+            {
+                continue;
+            }
+
+            digi_snapshot_put(&cursor[0], node->key, 8);
+            digi_snapshot_put(&cursor[8], node->last_seen, 4);
+            cursor[12] = node->link_quality;
+            cursor[13] = node->sleep;
+            cursor += DIGI_SNAPSHOT_NODE_SIZE;
+            node_count++;
+        }
+    }
+
+    digi_get_serial(digi, &serial);
+
+    memcpy(buffer, digi_snapshot_magic, sizeof(digi_snapshot_magic));
+    digi_snapshot_put(&buffer[DIGI_SNAPSHOT_VERSION_OFFSET], DIGI_SNAPSHOT_VERSION, 2);
+    digi_snapshot_put(&buffer[DIGI_SNAPSHOT_SIZE_OFFSET], total, 4);
+    digi_snapshot_put(&buffer[DIGI_SNAPSHOT_FIELDS_OFFSET], field_count, 4);
+    digi_snapshot_put(&buffer[DIGI_SNAPSHOT_NODES_OFFSET], node_count, 4);
+    memcpy(&buffer[DIGI_SNAPSHOT_SERIAL_OFFSET], serial.serial, DIGI_SERIAL_LENGTH);
+    digi_snapshot_put(&buffer[DIGI_SNAPSHOT_CHECKSUM_OFFSET], digi_snapshot_checksum(buffer, total), 4);
+
+    return total;
+}
+
+digi_status_t digi_snapshot_load(const uint8_t * buffer, size_t size, digi_t * digi, digi_cache_t * cache, digi_node_table_t * nodes)
+{
+    if(size < DIGI_SNAPSHOT_HEADER_SIZE || memcmp(buffer, digi_snapshot_magic, sizeof(digi_snapshot_magic)) != 0)
+    {
+        return DIGI_ERROR;
+    }
+
+    uint64_t total = digi_snapshot_get(&buffer[DIGI_SNAPSHOT_SIZE_OFFSET], 4);
+    uint64_t field_count = digi_snapshot_get(&buffer[DIGI_SNAPSHOT_FIELDS_OFFSET], 4);
+    uint64_t node_count = digi_snapshot_get(&buffer[DIGI_SNAPSHOT_NODES_OFFSET], 4);
+
+    if(digi_snapshot_get(&buffer[DIGI_SNAPSHOT_VERSION_OFFSET], 2) != DIGI_SNAPSHOT_VERSION
+       || total > size
+       || total != DIGI_SNAPSHOT_HEADER_SIZE + field_count * DIGI_SNAPSHOT_FIELD_SIZE + node_count * DIGI_SNAPSHOT_NODE_SIZE
+       || digi_snapshot_get(&buffer[DIGI_SNAPSHOT_CHECKSUM_OFFSET], 4) != digi_snapshot_checksum(buffer, (size_t)total))
+    {
+        return DIGI_ERROR;
+    }
+
+    // Make sure every node fits before changing anything
+    if(nodes != NULL && node_count > nodes->limit - nodes->count)
+    {
+        return DIGI_ERROR;
+    }
+
+    digi_serial_t serial;
+    memcpy(serial.serial, &buffer[DIGI_SNAPSHOT_SERIAL_OFFSET], DIGI_SERIAL_LENGTH);
+    digi_register(digi, &serial);
+
+    const uint8_t * cursor = &buffer[DIGI_SNAPSHOT_HEADER_SIZE];
+
+    for(uint64_t idx = 0; idx < field_count; idx++)
+    {
+        digi_field_t field = digi_field_from_code(cursor);
+
+        // Fields this build doesn't know about are skipped
+        if(cache != NULL && field != DIGI_FIELD_END)
+        {
+            cache->values[field] = (uint32_t)digi_snapshot_get(&cursor[4], 4);
+            cache->generations[field] = cache->generation;
+        }
+        cursor += DIGI_SNAPSHOT_FIELD_SIZE;
+    }
+
+    for(uint64_t idx = 0; idx < node_count && nodes != NULL; idx++)
+    {
+        digi_node_t * node = digi_nodes_insert(nodes, digi_snapshot_get(&cursor[0], 8));
+
+        node->last_seen = (uint32_t)digi_snapshot_get(&cursor[8], 4);
+        node->link_quality = cursor[12];
+        node->sleep = cursor[13];
+        cursor += DIGI_SNAPSHOT_NODE_SIZE;
+    }
+
+    return DIGI_OK;
+}
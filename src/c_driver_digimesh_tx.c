@@ -0,0 +1,141 @@
+#include "c_driver_digimesh_tx.h"
+
+#include <string.h>
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+digi_status_t digi_tx_init(digi_tx_t * tx, size_t maximum_frames, digi_tx_write_t write, void * context, size_t byte_threshold, uint32_t deadline)
+{
+    // A caller built with a different DIGI_TX_MAXIMUM_FRAMES has a different sized digi_tx_t
+    if(maximum_frames != DIGI_TX_MAXIMUM_FRAMES)
+    {
+        return DIGI_ERROR;
+    }
+
+    memset(tx, 0, sizeof(*tx));
+    tx->write = write;
+    tx->context = context;
+    tx->byte_threshold = byte_threshold;
+    tx->deadline = deadline;
+
+    return DIGI_OK;
+}
+
+void digi_tx_set_pool(digi_tx_t * tx, digi_pool_t * pool)
+{
+    tx->pool = pool;
+
+    return;
+}
+
+digi_status_t digi_tx_queue(digi_tx_t * tx, const uint8_t * frame, size_t size, uint32_t now)
+{
+    if(tx->count == DIGI_TX_MAXIMUM_FRAMES)
+    {
+        if(digi_tx_flush(tx) != DIGI_OK || tx->count == DIGI_TX_MAXIMUM_FRAMES)
+        {
+            return DIGI_ERROR;
+        }
+    }
+
+    if(tx->count == 0)
+    {
+        tx->oldest = now;
+    }
+
+    tx->frames[tx->count].data = frame;
+    tx->frames[tx->count].length = size;
+    tx->count++;
+    tx->bytes += size;
+
+    // The frame is queued whatever the flush does, a failed write leaves it for the next one
+    if(tx->count == DIGI_TX_MAXIMUM_FRAMES || tx->bytes >= tx->byte_threshold)
+    {
+        digi_tx_flush(tx);
+    }
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_tx_poll(digi_tx_t * tx, uint32_t now)
+{
+    // Unsigned subtraction keeps working when the caller's clock wraps
+    if(tx->count > 0 && (uint32_t)(now - tx->oldest) >= tx->deadline)
+    {
+        return digi_tx_flush(tx);
+    }
+
+    return DIGI_OK;
+}
+
+digi_status_t digi_tx_flush(digi_tx_t * tx)
+{
+    size_t written = 0;
+
+    if(tx->count == 0)
+    {
+        return DIGI_OK;
+    }
+
+    digi_status_t status = tx->write(tx->context, tx->frames, tx->count, &written);
+
+    if(written > tx->bytes)
+    {
+        written = tx->bytes;
+    }
+    tx->bytes -= written;
+
+    bool wrote = (written > 0);
+
+    // Drop the frames written in full and trim the one written in part
+    size_t sent = 0;
+    while(sent < tx->count && written >= tx->frames[sent].length)
+    {
+        written -= tx->frames[sent].length;
+        if(tx->pool != NULL)
+        {
+            digi_pool_free(tx->pool, tx->frames[sent].data);
+        }
+        sent++;
+    }
+
+    if(sent < tx->count)
+    {
+        tx->frames[sent].data += written;
+        tx->frames[sent].length -= written;
+    }
+
+    memmove(tx->frames, tx->frames + sent, (tx->count - sent) * sizeof(tx->frames[0]));
+    tx->count -= sent;
+    tx->frames_sent += (uint32_t)sent;
+
+    // A write that got nothing out, failed or not, isn't a batch
+    if(wrote)
+    {
+        tx->batches[sent]++;
+    }
+
+    return status;
+}
+
+size_t digi_tx_pending(const digi_tx_t * tx)
+{
+    return tx->count;
+}
+
+uint32_t digi_tx_batches(const digi_tx_t * tx, size_t frames)
+{
+    if(frames > DIGI_TX_MAXIMUM_FRAMES)
+    {
+        return 0;
+    }
+
+    return tx->batches[frames];
+}
+
+uint32_t digi_tx_frames_sent(const digi_tx_t * tx)
+{
+    return tx->frames_sent;
+}
@@ -0,0 +1,1137 @@
+/**
+ * @file bench.c
+ * @brief Microbenchmarks for the digimesh driver. Run with "make bench" from test-harness.
+ * 
+ * Every benchmark reports operations per second, nanoseconds per payload byte where it carries one, heap
+ * allocations made by the driver while it ran and the peak stack the operation used. Results are printed as
+ * one JSON object per line. The serial benchmarks talk to the port through a pty, so they need one to be
+ * available.
+ * 
+ * Options
+ *   --save FILE        also write the results to FILE to use as a baseline
+ *   --compare FILE     fail if any benchmark is slower than the baseline in FILE by more than the threshold
+ *   --threshold PCT    allowed slowdown for --compare in percent, default 10
+ *   --filter TEXT      only run benchmarks whose name contains TEXT
+ *   --time MS          how long to run each benchmark for, default 200
+ */
+#define _GNU_SOURCE
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+
+#include "c_driver_digimesh_parser.h"
+#include "c_driver_digimesh_ring.h"
+#include "c_driver_digimesh_pending.h"
+#include "c_driver_digimesh_escape.h"
+#include "c_driver_digimesh_nodes.h"
+#include "c_driver_digimesh_dispatch.h"
+#include "c_driver_digimesh_tx.h"
+#include "c_driver_digimesh_cache.h"
+#include "c_driver_digimesh_snapshot.h"
+#include "c_driver_digimesh_identify.h"
+#include "c_driver_digimesh_pool.h"
+#include "c_driver_digimesh_delivery.h"
+#include "c_driver_digimesh_fragment.h"
+#include "c_driver_digimesh_remote.h"
+#include "c_driver_digimesh_aggregate.h"
+#include "c_driver_digimesh_configure.h"
+#include "user_serial.h"
+
+/***********************/
+/* PRIVATE DEFINITIONS */
+/***********************/
+
+/**
+ * @brief Size of the stack benchmarks are run on when measuring their stack use
+ */
+#define PROBE_STACK_SIZE (64 * 1024)
+
+/**
+ * @brief Value the probe stack is painted with before a run
+ */
+#define PROBE_PAINT 0xA5
+
+/**
+ * @brief Most benchmarks that can be compared against a baseline
+ */
+#define MAXIMUM_BENCHMARKS 64
+
+/**
+ * @brief Bytes of payload used by the benchmarks that carry data
+ */
+#define PAYLOAD_SIZE 64
+
+/**
+ * @brief Bytes of line noise in front of a good frame in the resynchronization benchmark
+ */
+#define NOISE_SIZE 48
+
+/**
+ * @brief Number of remote nodes in the node table benchmarks
+ */
+#define NODE_COUNT 10000
+
+/**
+ * @brief Slots in the node table benchmarks, the smallest power of two that holds NODE_COUNT under the load limit
+ */
+#define NODE_CAPACITY 16384
+
+// A message long enough to need fragmenting, and the fragments it takes at FRAGMENT_PAYLOAD bytes a frame
+#define LARGE_MESSAGE_SIZE 4096
+#define FRAGMENT_PAYLOAD 73
+#define LARGE_MESSAGE_FRAGMENTS 60
+
+// Bytes in a remote AT query frame, and in a window's worth of them
+#define REMOTE_QUERY_SIZE 19
+#define REMOTE_MESSAGE_SIZE (DIGI_REMOTE_MAXIMUM_WINDOW * REMOTE_QUERY_SIZE)
+
+// Small readings packed into transmit requests of FRAGMENT_PAYLOAD bytes
+#define READING_SIZE 8
+#define READING_COUNT 20
+
+// Destinations a payload is fanned out to
+#define FANOUT_COUNT 100
+
+// Bytes in a snapshot of NODE_COUNT nodes and nothing cached
+#define SNAPSHOT_SIZE (DIGI_SNAPSHOT_HEADER_SIZE + NODE_COUNT * DIGI_SNAPSHOT_NODE_SIZE)
+
+/*****************/
+/* PRIVATE TYPES */
+/*****************/
+
+/**
+ * @brief One benchmark.
+ */
+typedef struct{
+    const char * name;      // Name reported in the results
+    size_t bytes;           // Payload bytes carried by one run, 0 if it doesn't carry a payload
+    void (*setup)(void);    // Prepares the state run works on. May be NULL.
+    void (*run)(void);      // The operation being measured
+}bench_t;
+
+/**
+ * @brief Results of one benchmark.
+ */
+typedef struct{
+    char name[64];
+    double ops_per_second;
+    double ns_per_byte;
+    unsigned long allocations;
+    size_t stack_bytes;
+}bench_result_t;
+
+/*********************/
+/* PRIVATE VARIABLES */
+/*********************/
+
+// Heap allocations made since the counter was last cleared
+static unsigned long allocations = 0;
+
+// Stops the compiler from optimizing away results
+static volatile size_t sink = 0;
+
+// State the benchmarks work on
+static digi_parser_t parser;
+static digi_frame_view_t frame;
+static uint8_t payload[PAYLOAD_SIZE];
+static uint8_t message[2 * MAXIMUM_MESSAGE_SIZE];
+static uint8_t received[MAXIMUM_MESSAGE_SIZE];
+static size_t received_size;
+static uint8_t noise[NOISE_SIZE + MAXIMUM_MESSAGE_SIZE];
+static size_t noise_size;
+static size_t message_size;
+static uint8_t escaped[2 * MAXIMUM_MESSAGE_SIZE];
+static size_t escaped_size;
+static uint8_t scratch[2 * MAXIMUM_MESSAGE_SIZE];
+static digi_unescaper_t unescaper;
+static digi_ring_t ring;
+static uint8_t ring_storage[1024];
+static digi_pending_t pending;
+static digi_dispatch_t dispatch;
+static digi_node_table_t node_table;
+static digi_node_t node_storage[NODE_CAPACITY];
+static uint32_t node_cursor;
+static digi_tx_t tx;
+static digi_cache_t cache;
+static digi_context_storage_t digi_storage;
+static digi_t * digi;
+static uint8_t snapshot[SNAPSHOT_SIZE];
+static digi_node_table_t restored_table;
+static digi_node_t restored_storage[NODE_CAPACITY];
+static digi_identify_t identify;
+static digi_pool_t pool;
+static digi_pool_block_t pool_blocks[2 * DIGI_TX_MAXIMUM_FRAMES];
+static digi_pool_cache_t pool_cache;
+static digi_delivery_t delivery;
+static digi_node_t delivery_nodes[64];
+static digi_delivery_link_t delivery_links[64];
+static digi_reassembly_t reassembly;
+static digi_reassembly_slot_t reassembly_slots[4];
+static uint8_t reassembly_buffers[4 * LARGE_MESSAGE_SIZE];
+static uint8_t large_message[LARGE_MESSAGE_SIZE];
+static uint8_t fragments[LARGE_MESSAGE_FRAGMENTS][MAXIMUM_MESSAGE_SIZE];
+static digi_receive_packet_t fragment_packets[LARGE_MESSAGE_FRAGMENTS];
+static digi_remote_t remote;
+static digi_remote_request_t remote_requests[DIGI_REMOTE_MAXIMUM_WINDOW];
+static uint8_t remote_message[REMOTE_MESSAGE_SIZE];
+static digi_aggregate_t aggregate;
+static digi_aggregate_slot_t aggregate_slots[4];
+static uint8_t aggregate_buffers[4 * FRAGMENT_PAYLOAD];
+static uint8_t packed[FRAGMENT_PAYLOAD];
+static digi_receive_packet_t packed_packet;
+static int serial_master = -1;
+static user_serial_t serial_port = {-1};
+static digi_serial_t fanout_destinations[FANOUT_COUNT];
+static uint8_t fanout_frame[MAXIMUM_MESSAGE_SIZE];
+static size_t fanout_size;
+static const digi_serial_t destination = {{0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x11}};
+
+// For running a benchmark on the probe stack
+static uint8_t probe_stack[PROBE_STACK_SIZE];
+static ucontext_t main_context;
+static ucontext_t probe_context;
+static const bench_t * probe_bench;
+
+/***********************/
+/* ALLOCATION COUNTING */
+/***********************/
+
+// The driver is linked with --wrap so every allocation it makes comes through here.
+void * __real_malloc(size_t size);
+void * __real_calloc(size_t count, size_t size);
+void * __real_realloc(void * pointer, size_t size);
+
+void * __wrap_malloc(size_t size)
+{
+    allocations++;
+    return __real_malloc(size);
+}
+
+void * __wrap_calloc(size_t count, size_t size)
+{
+    allocations++;
+    return __real_calloc(count, size);
+}
+
+void * __wrap_realloc(void * pointer, size_t size)
+{
+    allocations++;
+    return __real_realloc(pointer, size);
+}
+
+/**************/
+/* BENCHMARKS */
+/**************/
+
+static void setup_received(void)
+{
+    uint16_t length = 12 + PAYLOAD_SIZE;
+    uint8_t sum = 0;
+
+    received[0] = DIGI_START_DELIMITER;
+    received[1] = (uint8_t)(length >> 8);
+    received[2] = (uint8_t)length;
+    received[3] = DIGI_FRAME_RECEIVE_PACKET;
+    memcpy(&received[4], destination.serial, DIGI_SERIAL_LENGTH);
+    received[12] = 0xFF;
+    received[13] = 0xFE;
+    received[14] = 0x01;
+    memcpy(&received[15], payload, PAYLOAD_SIZE);
+    for(size_t idx = 3; idx < 3u + length; idx++)
+    {
+        sum += received[idx];
+    }
+    received[3 + length] = 0xFF - sum;
+    received_size = 4u + length;
+
+    digi_parser_init(&parser);
+}
+
+static void run_parse_whole_frame(void)
+{
+    size_t consumed = 0;
+    sink += digi_parser_feed(&parser, received, received_size, &consumed, &frame);
+}
+
+static void run_parse_bytewise(void)
+{
+    size_t consumed = 0;
+    for(size_t idx = 0; idx < received_size; idx++)
+    {
+        sink += digi_parser_feed(&parser, &received[idx], 1, &consumed, &frame);
+    }
+}
+
+static void setup_corrupted(void)
+{
+    setup_received();
+
+    // A noise burst whose start delimiter claims a length that swallows half of the good frame after it
+    memset(noise, 0x55, sizeof(noise));
+    noise[0] = DIGI_START_DELIMITER;
+    noise[1] = 0x00;
+    noise[2] = 0x40;
+    memcpy(&noise[NOISE_SIZE], received, received_size);
+    noise_size = NOISE_SIZE + received_size;
+}
+
+static void run_parse_corrupted(void)
+{
+    const uint8_t * bytes = noise;
+    size_t size = noise_size;
+    size_t consumed = 0;
+    digi_parse_result_t result;
+
+    do
+    {
+        result = digi_parser_feed(&parser, bytes, size, &consumed, &frame);
+        sink += result;
+        bytes += consumed;
+        size -= consumed;
+    }while(result != DIGI_PARSE_NEED_MORE);
+}
+
+static void count_frame(void * context, const digi_frame_view_t * frame)
+{
+    sink += frame->length;
+}
+
+static void setup_dispatch(void)
+{
+    setup_received();
+    digi_dispatch_init(&dispatch);
+    digi_dispatch_register(&dispatch, DIGI_FRAME_RECEIVE_PACKET, count_frame, NULL);
+}
+
+static void run_dispatch_receive(void)
+{
+    sink += digi_dispatch_receive(&dispatch, &parser, received, received_size);
+}
+
+static void setup_decoded(void)
+{
+    size_t consumed = 0;
+
+    setup_received();
+    digi_parser_feed(&parser, received, received_size, &consumed, &frame);
+}
+
+static void run_decode_receive_packet(void)
+{
+    digi_receive_packet_t packet;
+    sink += digi_decode_receive_packet(&frame, &packet);
+    sink += packet.length;
+}
+
+static void setup_at_response(void)
+{
+    static const uint8_t id_response[] = {0x7E, 0x00, 0x07, 0x88, 0x01, 'I', 'D', 0x00, 0x7F, 0xFF, 0x6B};
+    size_t consumed = 0;
+
+    digi_parser_init(&parser);
+    digi_parser_feed(&parser, id_response, sizeof(id_response), &consumed, &frame);
+}
+
+static void run_decode_at_response(void)
+{
+    digi_at_response_t response;
+    sink += digi_decode_at_response(&frame, &response);
+    sink += response.field;
+}
+
+static void run_field_from_code(void)
+{
+    static const uint8_t codes[][2] = {{'I', 'D'}, {'S', 'H'}, {'%', 'V'}, {'Z', 'Z'}};
+    for(size_t idx = 0; idx < 4; idx++)
+    {
+        sink += digi_field_from_code(codes[idx]);
+    }
+}
+
+static void run_generate_set_field(void)
+{
+    sink += digi_generate_set_field_message(message, sizeof(message), 1, DIGI_FIELD_ID, 0x7FFF);
+}
+
+static void run_generate_get_field(void)
+{
+    sink += digi_generate_get_field_message(message, sizeof(message), 1, DIGI_FIELD_ID);
+}
+
+// A typical provisioning run of 20 settings applied together
+// A radio's worth of provisioning
+static const digi_setting_t configuration[] = 
+{
+    {DIGI_FIELD_ID, 0x7FFF}, {DIGI_FIELD_CH, 0x0C}, {DIGI_FIELD_HP, 0}, {DIGI_FIELD_CE, 0},
+    {DIGI_FIELD_MT, 3}, {DIGI_FIELD_RR, 10}, {DIGI_FIELD_MR, 1}, {DIGI_FIELD_NH, 7},
+    {DIGI_FIELD_BH, 0}, {DIGI_FIELD_NN, 3}, {DIGI_FIELD_NT, 0x82}, {DIGI_FIELD_NO, 0},
+    {DIGI_FIELD_DH, 0x0013A200}, {DIGI_FIELD_DL, 0x41527E11}, {DIGI_FIELD_TO, 0xC0}, {DIGI_FIELD_EE, 1},
+    {DIGI_FIELD_PL, 4}, {DIGI_FIELD_NB, 0}, {DIGI_FIELD_AP, 1}, {DIGI_FIELD_SM, 0},
+};
+
+static void run_generate_configuration(void)
+{
+    sink += digi_generate_configuration(message, sizeof(message), 1, configuration, sizeof(configuration) / sizeof(configuration[0]));
+}
+
+// Build a batch with its frame id from the pending table and take in the AC's response
+static void run_configure_round_trip(void)
+{
+    digi_configure_t configure;
+    uint8_t data[4] = {0, 'A', 'C', 0x00};
+    digi_frame_view_t response = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+
+    sink += digi_configure_start(&configure, &pending, message, sizeof(message), configuration, sizeof(configuration) / sizeof(configuration[0]));
+    data[0] = configure.frame_id;
+    digi_pending_complete(&pending, &response);
+    sink += digi_configure_status(&configure);
+}
+
+static void run_generate_transmit_request(void)
+{
+    digi_payload_t pieces[] = {{payload, 8}, {&payload[8], sizeof(payload) - 8}};
+    sink += digi_generate_transmit_request(message, sizeof(message), 1, &destination, 0, pieces, 2);
+}
+
+static void setup_escape(void)
+{
+    digi_payload_t piece = {payload, sizeof(payload)};
+    message_size = digi_generate_transmit_request(message, sizeof(message), 1, &destination, 0, &piece, 1);
+
+    escaped_size = digi_escape(message, message_size, escaped, sizeof(escaped));
+    digi_unescaper_init(&unescaper);
+}
+
+static void run_escape(void)
+{
+    sink += digi_escape(message, message_size, scratch, sizeof(scratch));
+}
+
+static void run_unescape(void)
+{
+    sink += digi_unescape(&unescaper, escaped, escaped_size, scratch);
+}
+
+static void setup_ring(void)
+{
+    digi_ring_init(&ring, ring_storage, sizeof(ring_storage));
+}
+
+static void run_ring_push_drain(void)
+{
+    const uint8_t * region;
+    size_t size;
+
+    digi_ring_push(&ring, payload, sizeof(payload));
+    while((size = digi_ring_read_peek(&ring, &region)) > 0)
+    {
+        sink += region[0];
+        digi_ring_read_commit(&ring, size);
+    }
+}
+
+static void setup_pending(void)
+{
+    digi_pending_init(&pending);
+}
+
+static void run_pending_add_complete(void)
+{
+    uint8_t data[4] = {0, 'I', 'D', 0};
+    digi_frame_view_t response = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+
+    digi_pending_add(&pending, NULL, NULL, &data[0]);
+    sink += digi_pending_complete(&pending, &response);
+}
+
+// Keys that only differ in their low bits, like serials from one batch of modules
+static uint64_t node_key(uint32_t idx)
+{
+    return 0x0013A20041000000ull + idx * 7919u;
+}
+
+static void setup_nodes(void)
+{
+    digi_nodes_init(&node_table, node_storage, NODE_CAPACITY);
+    for(uint32_t idx = 0; idx < NODE_COUNT; idx++)
+    {
+        digi_nodes_insert(&node_table, node_key(idx));
+    }
+    node_cursor = 0;
+}
+
+static void run_nodes_find(void)
+{
+    sink += (size_t)digi_nodes_find(&node_table, node_key(node_cursor));
+    node_cursor = (node_cursor + 1) % NODE_COUNT;
+}
+
+static void run_nodes_find_missing(void)
+{
+    sink += (size_t)digi_nodes_find(&node_table, node_key(NODE_COUNT + node_cursor));
+    node_cursor = (node_cursor + 1) % NODE_COUNT;
+}
+
+static void run_nodes_evict_insert(void)
+{
+    digi_nodes_evict(&node_table, node_key(node_cursor));
+    sink += (size_t)digi_nodes_insert(&node_table, node_key(node_cursor));
+    node_cursor = (node_cursor + 1) % NODE_COUNT;
+}
+
+// Stands in for writev, taking the whole batch
+static digi_status_t write_all(void * context, const digi_payload_t * frames, size_t count, size_t * written)
+{
+    size_t total = 0;
+
+    for(size_t idx = 0; idx < count; idx++)
+    {
+        total += frames[idx].length;
+    }
+
+    *written = total;
+    return DIGI_OK;
+}
+
+static void setup_tx(void)
+{
+    digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES, write_all, NULL, SIZE_MAX, UINT32_MAX);
+    message_size = digi_generate_get_field_message(message, sizeof(message), 1, DIGI_FIELD_ID);
+}
+
+static void run_tx_queue_batch(void)
+{
+    for(int idx = 0; idx < DIGI_TX_MAXIMUM_FRAMES; idx++)
+    {
+        digi_tx_queue(&tx, message, message_size, 0);
+    }
+    sink += digi_tx_frames_sent(&tx);
+}
+
+static void setup_cache(void)
+{
+    static const uint8_t data[] = {0x01, 'I', 'D', 0x00, 0x7F, 0xFF};
+    digi_frame_view_t response = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+
+    digi_cache_init(&cache);
+    digi_cache_frame(&cache, &response);
+}
+
+static void run_cache_get(void)
+{
+    uint32_t value = 0;
+
+    digi_cache_get(&cache, DIGI_FIELD_ID, &value);
+    sink += value;
+}
+
+// A read of a field the cache doesn't hold, which builds its query
+static void run_cache_read_miss(void)
+{
+    uint32_t value = 0;
+    size_t written = 0;
+
+    digi_cache_read(&cache, DIGI_FIELD_PL, &value, message, sizeof(message), 1, &written);
+    sink += written;
+}
+
+static void run_cache_frame(void)
+{
+    static const uint8_t data[] = {0x01, 'C', 'H', 0x00, 0x0C};
+    digi_frame_view_t response = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+
+    digi_cache_frame(&cache, &response);
+    sink += cache.values[DIGI_FIELD_CH];
+}
+
+static void setup_snapshot(void)
+{
+    setup_nodes();
+    digi = digi_init(&digi_storage);
+    digi_register(digi, (digi_serial_t *)&destination);
+    digi_snapshot_save(snapshot, sizeof(snapshot), digi, NULL, &node_table);
+}
+
+static void run_snapshot_save(void)
+{
+    sink += digi_snapshot_save(snapshot, sizeof(snapshot), digi, NULL, &node_table);
+}
+
+static void run_snapshot_load(void)
+{
+    digi_nodes_init(&restored_table, restored_storage, NODE_CAPACITY);
+    sink += digi_snapshot_load(snapshot, sizeof(snapshot), digi, NULL, &restored_table);
+}
+
+static void setup_identify(void)
+{
+    digi = digi_init(&digi_storage);
+    digi_pending_init(&pending);
+    digi_cache_init(&cache);
+}
+
+static void run_identify_start(void)
+{
+    sink += digi_identify_start(&identify, digi, &pending, &cache, message, sizeof(message));
+
+    // Give the frame ids back so every run starts the same
+    digi_identify_cancel(&identify);
+}
+
+static void setup_pool(void)
+{
+    digi_pool_init(&pool, pool_blocks, sizeof(pool_blocks) / sizeof(pool_blocks[0]), DIGI_POOL_BLOCK_SIZE);
+    memset(&pool_cache, 0, sizeof(pool_cache));
+    digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES, write_all, NULL, SIZE_MAX, UINT32_MAX);
+    digi_tx_set_pool(&tx, &pool);
+}
+
+static void run_pool_alloc_free(void)
+{
+    uint8_t * block = digi_pool_alloc(&pool);
+
+    sink += (size_t)block;
+    digi_pool_free(&pool, block);
+}
+
+static void run_pool_cache_alloc_free(void)
+{
+    uint8_t * block = digi_pool_cache_alloc(&pool_cache, &pool);
+
+    sink += (size_t)block;
+    digi_pool_cache_free(&pool_cache, &pool, block);
+}
+
+// Build a batch of frames in pool blocks and send them, the blocks going back as they're written
+static void run_pool_tx_batch(void)
+{
+    for(int idx = 0; idx < DIGI_TX_MAXIMUM_FRAMES; idx++)
+    {
+        uint8_t * block = digi_pool_alloc(&pool);
+        size_t size = digi_generate_get_field_message(block, DIGI_POOL_BLOCK_SIZE, 1, DIGI_FIELD_ID);
+        digi_tx_queue(&tx, block, size, 0);
+    }
+    sink += digi_pool_used(&pool);
+}
+
+static void setup_delivery(void)
+{
+    digi_pending_init(&pending);
+    digi_delivery_init(&delivery, &pending, delivery_nodes, delivery_links, sizeof(delivery_links) / sizeof(delivery_links[0]));
+}
+
+static void run_delivery_generate_complete(void)
+{
+    uint8_t data[] = {0x00, 0xFF, 0xFE, 0x00, 0x00, 0x00};
+    digi_frame_view_t status = {DIGI_FRAME_TRANSMIT_STATUS, data, sizeof(data)};
+
+    message_size = digi_delivery_generate(&delivery, message, sizeof(message), &destination, 0, NULL, 0, 0, &data[0]);
+    sink += digi_delivery_complete(&delivery, &status, 40);
+}
+
+static void run_generate_fragments(void)
+{
+    uint8_t count = digi_fragment_count(sizeof(large_message), FRAGMENT_PAYLOAD);
+
+    for(uint8_t index = 0; index < count; index++)
+    {
+        sink += digi_generate_fragment(fragments[index], MAXIMUM_MESSAGE_SIZE, 0, &destination, 0, 1, large_message, sizeof(large_message), FRAGMENT_PAYLOAD, index);
+    }
+}
+
+static void count_message(void * context, const digi_serial_t * source, const uint8_t * data, size_t length)
+{
+    sink += length;
+}
+
+// Fragments as the receiving end would see them, payload after the transmit request header
+static void setup_reassembly(void)
+{
+    digi_reassembly_init(&reassembly, reassembly_slots, 4, reassembly_buffers, LARGE_MESSAGE_SIZE, 1, count_message, NULL);
+    run_generate_fragments();
+
+    for(uint8_t index = 0; index < LARGE_MESSAGE_FRAGMENTS; index++)
+    {
+        uint16_t length = (uint16_t)((fragments[index][1] << 8) | fragments[index][2]);
+        memcpy(fragment_packets[index].source.serial, destination.serial, DIGI_SERIAL_LENGTH);
+        fragment_packets[index].payload = &fragments[index][3 + 14];
+        fragment_packets[index].length = (uint16_t)(length - 14);
+    }
+}
+
+// Every fragment of the message but the last, so it is left waiting for the timeout
+static void run_reassemble_timeout(void)
+{
+    for(uint8_t index = 0; index < LARGE_MESSAGE_FRAGMENTS - 1; index++)
+    {
+        digi_reassembly_receive(&reassembly, &fragment_packets[index], 0);
+    }
+
+    digi_reassembly_poll(&reassembly, 1);
+    sink += digi_reassembly_failures(&reassembly);
+}
+
+static void run_reassemble(void)
+{
+    for(uint8_t index = 0; index < LARGE_MESSAGE_FRAGMENTS; index++)
+    {
+        digi_reassembly_receive(&reassembly, &fragment_packets[index], 0);
+    }
+
+    // Free the completed message's slot so the next run isn't taken for a late repeat
+    digi_reassembly_poll(&reassembly, 1);
+}
+
+static void count_remote(void * context, const digi_remote_request_t * request, const digi_remote_at_response_t * response)
+{
+    sink += response->response.status;
+}
+
+static void setup_remote(void)
+{
+    digi_pending_init(&pending);
+    digi_remote_init(&remote, &pending, DIGI_REMOTE_MAXIMUM_WINDOW, 3, 100, 50, count_remote, NULL);
+    for(uint8_t idx = 0; idx < DIGI_REMOTE_MAXIMUM_WINDOW; idx++)
+    {
+        remote_requests[idx] = (digi_remote_request_t){destination, DIGI_FIELD_CH, false, 0, 0};
+    }
+}
+
+// Send a full window of queries in one buffer and answer them all
+static void run_remote_window(void)
+{
+    uint8_t data[15] = {0, 0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x11, 0xFF, 0xFE, 'C', 'H', 0x00, 0x0C};
+    digi_frame_view_t response = {DIGI_FRAME_REMOTE_AT_RESPONSE, data, sizeof(data)};
+
+    digi_remote_start(&remote, remote_requests, DIGI_REMOTE_MAXIMUM_WINDOW);
+    size_t size = digi_remote_poll(&remote, remote_message, sizeof(remote_message), 0);
+
+    for(size_t offset = 0; offset < size; offset += REMOTE_QUERY_SIZE)
+    {
+        // The frame id follows the start byte, length and frame type
+        data[0] = remote_message[offset + 4];
+        digi_pending_complete(&pending, &response);
+    }
+}
+
+static digi_status_t send_packed(void * context, const digi_serial_t * destination, const uint8_t * payload, size_t length)
+{
+    digi_payload_t piece = {payload, length};
+
+    sink += digi_generate_transmit_request(message, sizeof(message), 1, destination, 0, &piece, 1);
+
+    return DIGI_OK;
+}
+
+static void count_reading(void * context, const digi_serial_t * source, const uint8_t * data, size_t length)
+{
+    sink += length;
+}
+
+static void setup_aggregate(void)
+{
+    digi_aggregate_init(&aggregate, aggregate_slots, 4, aggregate_buffers, FRAGMENT_PAYLOAD, send_packed, NULL);
+
+    // A full payload of readings as the receiving end would see it
+    packed_packet.source = destination;
+    packed_packet.payload = packed;
+    packed_packet.length = 0;
+    while(packed_packet.length + 1 + READING_SIZE <= FRAGMENT_PAYLOAD)
+    {
+        packed[packed_packet.length] = READING_SIZE;
+        packed_packet.length += 1 + READING_SIZE;
+    }
+}
+
+// Pack READING_COUNT readings for one destination into transmit requests
+static void run_aggregate_queue(void)
+{
+    for(uint8_t idx = 0; idx < READING_COUNT; idx++)
+    {
+        digi_aggregate_queue(&aggregate, &destination, payload, READING_SIZE, 100, 0);
+    }
+    digi_aggregate_flush(&aggregate);
+}
+
+// Queue READING_COUNT readings over every slot's destination and let poll send them once they are due
+static void run_aggregate_poll(void)
+{
+    digi_serial_t reading_destination = destination;
+
+    for(uint8_t idx = 0; idx < READING_COUNT; idx++)
+    {
+        reading_destination.serial[DIGI_SERIAL_LENGTH - 1] = idx % 4;
+        digi_aggregate_queue(&aggregate, &reading_destination, payload, READING_SIZE, 10, 0);
+    }
+    digi_aggregate_poll(&aggregate, 9);
+    digi_aggregate_poll(&aggregate, 10);
+}
+
+static void run_aggregate_split(void)
+{
+    digi_aggregate_split(&packed_packet, count_reading, NULL);
+}
+
+static void setup_fanout(void)
+{
+    digi_payload_t piece = {payload, PAYLOAD_SIZE};
+
+    for(uint8_t idx = 0; idx < FANOUT_COUNT; idx++)
+    {
+        fanout_destinations[idx] = destination;
+        fanout_destinations[idx].serial[DIGI_SERIAL_LENGTH - 1] = idx;
+    }
+    fanout_size = digi_generate_transmit_request(fanout_frame, sizeof(fanout_frame), 1, &destination, 0, &piece, 1);
+}
+
+// Build the frame for every destination from scratch, the cost retargeting avoids
+static void run_fanout_generate(void)
+{
+    digi_payload_t piece = {payload, PAYLOAD_SIZE};
+
+    for(uint8_t idx = 0; idx < FANOUT_COUNT; idx++)
+    {
+        sink += digi_generate_transmit_request(fanout_frame, sizeof(fanout_frame), idx | 1, &fanout_destinations[idx], 0, &piece, 1);
+    }
+}
+
+static void run_fanout_retarget(void)
+{
+    for(uint8_t idx = 0; idx < FANOUT_COUNT; idx++)
+    {
+        digi_retarget_transmit_request(fanout_frame, fanout_size, idx | 1, &fanout_destinations[idx]);
+        sink += fanout_frame[fanout_size - 1];
+    }
+}
+
+// The master side of a pty pair stands in for the digi module
+static void setup_serial(void)
+{
+    setup_received();
+
+    if(serial_master < 0)
+    {
+        serial_master = posix_openpt(O_RDWR | O_NOCTTY);
+        if(serial_master < 0 || grantpt(serial_master) != 0 || unlockpt(serial_master) != 0
+           || user_serial_open(&serial_port, ptsname(serial_master), 115200, false) != DIGI_OK)
+        {
+            fprintf(stderr, "could not open a pty for the serial benchmarks\n");
+            exit(2);
+        }
+    }
+}
+
+// A frame written by the digi module, read from the port until it has all arrived
+static void run_serial_read(void)
+{
+    size_t total = 0;
+
+    sink += (size_t)write(serial_master, received, received_size);
+    while(total < received_size)
+    {
+        size_t count = 0;
+
+        if(user_serial_read(&serial_port, &scratch[total], sizeof(scratch) - total, &count) != DIGI_OK)
+        {
+            break;
+        }
+        total += count;
+    }
+}
+
+// A frame written to the port and taken off the digi module's side
+static void run_serial_write(void)
+{
+    size_t sent = 0;
+    size_t total = 0;
+
+    user_serial_write(&serial_port, received, received_size, &sent);
+    while(total < sent)
+    {
+        ssize_t count = read(serial_master, &scratch[total], sent - total);
+
+        if(count <= 0)
+        {
+            break;
+        }
+        total += (size_t)count;
+    }
+}
+
+static void run_nothing(void)
+{
+}
+
+// Every benchmark that is run
+static const bench_t benchmarks[] = 
+{
+    {"parse_whole_frame",           PAYLOAD_SIZE,   setup_received,     run_parse_whole_frame},
+    {"parse_bytewise",              PAYLOAD_SIZE,   setup_received,     run_parse_bytewise},
+    {"parse_after_noise",           NOISE_SIZE,     setup_corrupted,    run_parse_corrupted},
+    {"dispatch_receive",            PAYLOAD_SIZE,   setup_dispatch,     run_dispatch_receive},
+    {"decode_receive_packet",       PAYLOAD_SIZE,   setup_decoded,      run_decode_receive_packet},
+    {"decode_at_response",          0,              setup_at_response,  run_decode_at_response},
+    {"field_from_code_x4",          0,              NULL,               run_field_from_code},
+    {"generate_set_field",          0,              NULL,               run_generate_set_field},
+    {"generate_get_field",          0,              NULL,               run_generate_get_field},
+    {"generate_configuration_x20",  0,              NULL,               run_generate_configuration},
+    {"configure_round_trip_x20",    0,              setup_pending,      run_configure_round_trip},
+    {"generate_transmit_request",   PAYLOAD_SIZE,   NULL,               run_generate_transmit_request},
+    {"fanout_generate_x100",        FANOUT_COUNT * PAYLOAD_SIZE, setup_fanout, run_fanout_generate},
+    {"fanout_retarget_x100",        FANOUT_COUNT * PAYLOAD_SIZE, setup_fanout, run_fanout_retarget},
+    {"escape",                      PAYLOAD_SIZE,   setup_escape,       run_escape},
+    {"unescape",                    PAYLOAD_SIZE,   setup_escape,       run_unescape},
+    {"ring_push_drain",             PAYLOAD_SIZE,   setup_ring,         run_ring_push_drain},
+    {"pending_add_complete",        0,              setup_pending,      run_pending_add_complete},
+    {"nodes_find_10k",              0,              setup_nodes,        run_nodes_find},
+    {"nodes_find_missing_10k",      0,              setup_nodes,        run_nodes_find_missing},
+    {"nodes_evict_insert_10k",      0,              setup_nodes,        run_nodes_evict_insert},
+    {"cache_get",                   0,              setup_cache,        run_cache_get},
+    {"cache_read_miss",             0,              setup_cache,        run_cache_read_miss},
+    {"cache_frame",                 0,              setup_cache,        run_cache_frame},
+    {"snapshot_save_10k",           SNAPSHOT_SIZE,  setup_snapshot,     run_snapshot_save},
+    {"snapshot_load_10k",           SNAPSHOT_SIZE,  setup_snapshot,     run_snapshot_load},
+    {"identify_start",              0,              setup_identify,     run_identify_start},
+    {"tx_queue_batch",              0,              setup_tx,           run_tx_queue_batch},
+    {"delivery_generate_complete",  0,              setup_delivery,     run_delivery_generate_complete},
+    {"generate_fragments_4k",       LARGE_MESSAGE_SIZE, NULL,           run_generate_fragments},
+    {"reassemble_4k",               LARGE_MESSAGE_SIZE, setup_reassembly, run_reassemble},
+    {"reassemble_timeout_4k",       LARGE_MESSAGE_SIZE, setup_reassembly, run_reassemble_timeout},
+    {"remote_window_16",            REMOTE_MESSAGE_SIZE, setup_remote,  run_remote_window},
+    {"aggregate_queue_20x8",        READING_COUNT * READING_SIZE, setup_aggregate, run_aggregate_queue},
+    {"aggregate_poll_20x8",         READING_COUNT * READING_SIZE, setup_aggregate, run_aggregate_poll},
+    {"aggregate_split",             FRAGMENT_PAYLOAD, setup_aggregate,  run_aggregate_split},
+    {"pool_alloc_free",             0,              setup_pool,         run_pool_alloc_free},
+    {"pool_cache_alloc_free",       0,              setup_pool,         run_pool_cache_alloc_free},
+    {"pool_tx_batch",               0,              setup_pool,         run_pool_tx_batch},
+    {"serial_read_frame",           PAYLOAD_SIZE,   setup_serial,       run_serial_read},
+    {"serial_write_frame",          PAYLOAD_SIZE,   setup_serial,       run_serial_write},
+};
+
+/***********/
+/* HARNESS */
+/***********/
+
+static double now_ns(void)
+{
+    struct timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (double)time.tv_sec * 1e9 + (double)time.tv_nsec;
+}
+
+static void probe_entry(void)
+{
+    probe_bench->run();
+}
+
+// Run a benchmark once on a painted stack and return how much of it was used
+static size_t probe_stack_use(const bench_t * bench)
+{
+    size_t untouched = 0;
+
+    memset(probe_stack, PROBE_PAINT, sizeof(probe_stack));
+    probe_bench = bench;
+
+    getcontext(&probe_context);
+    probe_context.uc_stack.ss_sp = probe_stack;
+    probe_context.uc_stack.ss_size = sizeof(probe_stack);
+    probe_context.uc_link = &main_context;
+    makecontext(&probe_context, probe_entry, 0);
+    swapcontext(&main_context, &probe_context);
+
+    // The stack grows down so the untouched paint is at the start of the buffer
+    while(untouched < sizeof(probe_stack) && probe_stack[untouched] == PROBE_PAINT)
+    {
+        untouched++;
+    }
+
+    return sizeof(probe_stack) - untouched;
+}
+
+static bench_result_t run_benchmark(const bench_t * bench, double duration_ns, size_t stack_overhead)
+{
+    bench_result_t result = {{0}};
+    unsigned long iterations = 1;
+    double elapsed = 0;
+
+    snprintf(result.name, sizeof(result.name), "%s", bench->name);
+
+    if(bench->setup)
+    {
+        bench->setup();
+    }
+
+    // Grow the iteration count until a batch takes a measurable time, then time for the full duration
+    while(elapsed < duration_ns / 20)
+    {
+        iterations *= 2;
+        double start = now_ns();
+        for(unsigned long idx = 0; idx < iterations; idx++)
+        {
+            bench->run();
+        }
+        elapsed = now_ns() - start;
+    }
+    iterations = (unsigned long)((double)iterations * duration_ns / elapsed) + 1;
+
+    allocations = 0;
+    double start = now_ns();
+    for(unsigned long idx = 0; idx < iterations; idx++)
+    {
+        bench->run();
+    }
+    elapsed = now_ns() - start;
+    result.allocations = allocations;
+
+    result.ops_per_second = (double)iterations * 1e9 / elapsed;
+    result.ns_per_byte = bench->bytes ? elapsed / ((double)iterations * (double)bench->bytes) : 0;
+
+    size_t stack = probe_stack_use(bench);
+    result.stack_bytes = (stack > stack_overhead) ? stack - stack_overhead : 0;
+
+    return result;
+}
+
+static void print_result(FILE * file, const bench_result_t * result)
+{
+    fprintf(file, "{\"name\":\"%s\",\"ops_per_second\":%.0f,\"ns_per_byte\":%.4f,\"allocations\":%lu,\"stack_bytes\":%zu}\n",
+            result->name, result->ops_per_second, result->ns_per_byte, result->allocations, result->stack_bytes);
+}
+
+// Read results written by --save. Returns the number read.
+static size_t load_baseline(const char * path, bench_result_t * results, size_t capacity)
+{
+    FILE * file = fopen(path, "r");
+    char line[256];
+    size_t count = 0;
+
+    if(file == NULL)
+    {
+        fprintf(stderr, "could not open baseline %s\n", path);
+        exit(2);
+    }
+
+    while(count < capacity && fgets(line, sizeof(line), file))
+    {
+        if(sscanf(line, "{\"name\":\"%63[^\"]\",\"ops_per_second\":%lf", results[count].name, &results[count].ops_per_second) == 2)
+        {
+            count++;
+        }
+    }
+    fclose(file);
+
+    return count;
+}
+
+int main(int argc, char ** argv)
+{
+    const char * save_path = NULL;
+    const char * compare_path = NULL;
+    const char * filter = NULL;
+    double threshold = 10;
+    double duration_ms = 200;
+
+    for(int idx = 1; idx < argc; idx++)
+    {
+        if(strcmp(argv[idx], "--save") == 0 && idx + 1 < argc)
+        {
+            save_path = argv[++idx];
+        }
+        else if(strcmp(argv[idx], "--compare") == 0 && idx + 1 < argc)
+        {
+            compare_path = argv[++idx];
+        }
+        else if(strcmp(argv[idx], "--threshold") == 0 && idx + 1 < argc)
+        {
+            threshold = atof(argv[++idx]);
+        }
+        else if(strcmp(argv[idx], "--filter") == 0 && idx + 1 < argc)
+        {
+            filter = argv[++idx];
+        }
+        else if(strcmp(argv[idx], "--time") == 0 && idx + 1 < argc)
+        {
+            duration_ms = atof(argv[++idx]);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--save FILE] [--compare FILE] [--threshold PCT] [--filter TEXT] [--time MS]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    for(size_t idx = 0; idx < sizeof(payload); idx++)
+    {
+        payload[idx] = (uint8_t)(idx * 3);
+    }
+
+    static const bench_t nothing = {"nothing", 0, NULL, run_nothing};
+    size_t stack_overhead = probe_stack_use(&nothing);
+
+    bench_result_t results[MAXIMUM_BENCHMARKS];
+    size_t count = 0;
+
+    for(size_t idx = 0; idx < sizeof(benchmarks) / sizeof(benchmarks[0]) && count < MAXIMUM_BENCHMARKS; idx++)
+    {
+        if(filter && strstr(benchmarks[idx].name, filter) == NULL)
+        {
+            continue;
+        }
+        results[count] = run_benchmark(&benchmarks[idx], duration_ms * 1e6, stack_overhead);
+        print_result(stdout, &results[count]);
+        count++;
+    }
+
+    if(save_path)
+    {
+        FILE * file = fopen(save_path, "w");
+        if(file == NULL)
+        {
+            fprintf(stderr, "could not write baseline %s\n", save_path);
+            return 2;
+        }
+        for(size_t idx = 0; idx < count; idx++)
+        {
+            print_result(file, &results[idx]);
+        }
+        fclose(file);
+    }
+
+    int status = 0;
+
+    if(compare_path)
+    {
+        bench_result_t baseline[MAXIMUM_BENCHMARKS];
+        size_t baseline_count = load_baseline(compare_path, baseline, MAXIMUM_BENCHMARKS);
+
+        for(size_t idx = 0; idx < count; idx++)
+        {
+            for(size_t base = 0; base < baseline_count; base++)
+            {
+                if(strcmp(results[idx].name, baseline[base].name) != 0)
+                {
+                    continue;
+                }
+
+                double change = 100.0 * (results[idx].ops_per_second - baseline[base].ops_per_second) / baseline[base].ops_per_second;
+                if(change < -threshold)
+                {
+                    fprintf(stderr, "REGRESSION %s: %.1f%% slower than baseline\n", results[idx].name, -change);
+                    status = 1;
+                }
+            }
+            if(results[idx].allocations != 0)
+            {
+                fprintf(stderr, "REGRESSION %s: %lu heap allocations\n", results[idx].name, results[idx].allocations);
+                status = 1;
+            }
+        }
+    }
+
+    return status;
+}
@@ -1,5 +1,7 @@
 #include "CppUTest/TestHarness.h"
 
+#include <string.h>
+
 extern "C" 
 {
     #include "c_driver_digimesh_parser.h"
@@ -10,29 +12,65 @@ TEST_GROUP(Test)
 {
     void setup()
     {
-        digi_init();
+        digi = digi_init(&storage);
+        digi_parser_init(&parser);
     }
 
     void teardown()
     {
     }
 
+    digi_context_storage_t storage;
+    digi_t * digi;
+
     digi_serial_t id = {.serial = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08}};
     
     digi_status_t register_digi()
     {
-        return digi_register(&id);
+        return digi_register(digi, &id);
     }
 
     #define IS_DIGI_REGISTERED()\
-        CHECK(digi_is_initialized());
+        CHECK(digi_is_initialized(digi));
 
     #define NO_DIGI_REGISTERED()\
-        CHECK(!digi_is_initialized());
+        CHECK(!digi_is_initialized(digi));
 
     #define IS_OK(status)\
         CHECK(status == DIGI_OK);
 
+    digi_parser_t parser;
+    digi_frame_view_t frame;
+
+    // Local AT command response to an ID query with frame id 1, status OK and value 0x7FFF
+    uint8_t id_response[11] = {0x7E, 0x00, 0x07, 0x88, 0x01, 'I', 'D', 0x00, 0x7F, 0xFF, 0x6B};
+
+    // Feed bytes to the parser in chunks of the given size and count how many frames come out
+    int feed_in_chunks(const uint8_t * bytes, size_t size, size_t chunk)
+    {
+        int frames = 0;
+        size_t offset = 0;
+
+        while(offset < size)
+        {
+            size_t length = (size - offset < chunk) ? size - offset : chunk;
+            size_t consumed = 0;
+            digi_parse_result_t result;
+            do
+            {
+                result = digi_parser_feed(&parser, &bytes[offset], length, &consumed, &frame);
+                if(result == DIGI_PARSE_FRAME)
+                {
+                    frames++;
+                }
+                offset += consumed;
+                length -= consumed;
+            }while(result != DIGI_PARSE_NEED_MORE);
+        }
+
+        return frames;
+    }
+
   
 
 };
@@ -58,17 +96,457 @@ TEST(Test, check_state_is_not_empty_after_initialization)
     IS_DIGI_REGISTERED();
 }
 
+// A frame that arrives in one piece is returned as a view into the input
+TEST(Test, check_parser_decodes_whole_frame_in_place)
+{
+    size_t consumed = 0;
+
+    CHECK(digi_parser_feed(&parser, id_response, sizeof(id_response), &consumed, &frame) == DIGI_PARSE_FRAME);
+    LONGS_EQUAL(sizeof(id_response), consumed);
+    BYTES_EQUAL(DIGI_FRAME_LOCAL_AT_RESPONSE, frame.type);
+    LONGS_EQUAL(6, frame.length);
+    POINTERS_EQUAL(&id_response[4], frame.data);
+}
+
+// A frame that arrives one byte at a time is still decoded
+TEST(Test, check_parser_resumes_across_calls)
+{
+    LONGS_EQUAL(1, feed_in_chunks(id_response, sizeof(id_response), 1));
+    BYTES_EQUAL(DIGI_FRAME_LOCAL_AT_RESPONSE, frame.type);
+    LONGS_EQUAL(6, frame.length);
+    MEMCMP_EQUAL(&id_response[4], frame.data, 6);
+}
+
+// A frame with a bad checksum is dropped
+TEST(Test, check_parser_rejects_bad_checksum)
+{
+    size_t consumed = 0;
+    id_response[10]++;
+
+    CHECK(digi_parser_feed(&parser, id_response, sizeof(id_response), &consumed, &frame) == DIGI_PARSE_BAD_CHECKSUM);
+    LONGS_EQUAL(1, consumed);
+    CHECK(digi_parser_feed(&parser, &id_response[1], sizeof(id_response) - 1, &consumed, &frame) == DIGI_PARSE_NEED_MORE);
+    LONGS_EQUAL(sizeof(id_response), digi_parser_discarded(&parser));
+    LONGS_EQUAL(1, digi_parser_resyncs(&parser));
+}
+
+// A length that can't fit in a message is rejected as soon as it's read
+TEST(Test, check_parser_rejects_oversized_length)
+{
+    uint8_t bytes[] = {0x7E, 0x01, 0x00};
+    size_t consumed = 0;
+
+    CHECK(digi_parser_feed(&parser, bytes, sizeof(bytes), &consumed, &frame) == DIGI_PARSE_BAD_LENGTH);
+    LONGS_EQUAL(1, consumed);
+    LONGS_EQUAL(1, digi_parser_resyncs(&parser));
+}
+
+// A bad length split from its start delimiter is still rejected once both bytes arrive
+TEST(Test, check_parser_rejects_oversized_length_across_calls)
+{
+    uint8_t bytes[] = {0x7E, 0x01, 0x00};
+
+    LONGS_EQUAL(0, feed_in_chunks(bytes, sizeof(bytes), 1));
+    LONGS_EQUAL(3, digi_parser_discarded(&parser));
+    LONGS_EQUAL(1, digi_parser_resyncs(&parser));
+}
+
 // Create a message to set the network ID of a digi module
 TEST(Test, check_message_to_configure_network_id_is_correct)
 {
-    // digi_field_t field = DIGI_FIELD_ID;
-    // uint16_t value = 0x0A0A0;
-    // uint8_t message[128] = {0};
-    // IS_OK(digi_generate_set_field_message(DIGI_FIELD_ID, value));
-    
-    
+    uint8_t expected[] = {0x7E, 0x00, 0x06, 0x08, 0x01, 'I', 'D', 0x0A, 0x0A, 0x55};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    LONGS_EQUAL(sizeof(expected), digi_generate_set_field_message(message, sizeof(message), 1, DIGI_FIELD_ID, 0x0A0A));
+    MEMCMP_EQUAL(expected, message, sizeof(expected));
+}
+
+// Create a message to query the network ID of a digi module
+TEST(Test, check_message_to_query_network_id_is_correct)
+{
+    uint8_t expected[] = {0x7E, 0x00, 0x04, 0x08, 0x01, 'I', 'D', 0x69};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    LONGS_EQUAL(sizeof(expected), digi_generate_get_field_message(message, sizeof(message), 1, DIGI_FIELD_ID));
+    MEMCMP_EQUAL(expected, message, sizeof(expected));
+}
+
+// Nothing is written when the message doesn't fit
+TEST(Test, check_message_is_not_generated_into_small_buffer)
+{
+    uint8_t message[9] = {0};
+
+    LONGS_EQUAL(0, digi_generate_set_field_message(message, sizeof(message), 1, DIGI_FIELD_ID, 0x0A0A));
+    BYTES_EQUAL(0, message[0]);
+}
+
+// An encoded message decodes back to what was asked for
+TEST(Test, check_generated_message_parses)
+{
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+    size_t size = digi_generate_set_field_message(message, sizeof(message), 7, DIGI_FIELD_ID, 0x1234);
+    size_t consumed = 0;
+
+    CHECK(digi_parser_feed(&parser, message, size, &consumed, &frame) == DIGI_PARSE_FRAME);
+    BYTES_EQUAL(DIGI_FRAME_LOCAL_AT, frame.type);
+    BYTES_EQUAL(7, frame.data[0]);
+    BYTES_EQUAL(0x12, frame.data[3]);
+    BYTES_EQUAL(0x34, frame.data[4]);
+}
+
+// Create a transmit request with the payload in one piece
+TEST(Test, check_transmit_request_is_correct)
+{
+    uint8_t payload_bytes[] = {0x11, 0x22};
+    digi_payload_t payload = {payload_bytes, sizeof(payload_bytes)};
+    uint8_t expected[] = {0x7E, 0x00, 0x10, 0x10, 0x01, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xFF, 0xFE, 0x00, 0x00, 0x11, 0x22, 0x9A};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    LONGS_EQUAL(sizeof(expected), digi_generate_transmit_request(message, sizeof(message), 1, &id, 0, &payload, 1));
+    MEMCMP_EQUAL(expected, message, sizeof(expected));
+}
+
+// A transmit request that doesn't fit isn't generated
+TEST(Test, check_transmit_request_is_not_generated_into_small_buffer)
+{
+    uint8_t message[17] = {0};
+
+    LONGS_EQUAL(0, digi_generate_transmit_request(message, sizeof(message), 1, &id, 0, NULL, 0));
+}
+
+// Retargeting a transmit request gives the same bytes as building it for the new destination
+TEST(Test, check_retargeted_transmit_request_matches_fresh_one)
+{
+    uint8_t payload_bytes[] = {0x11, 0x22, 0xFE, 0x7E};
+    digi_payload_t payload = {payload_bytes, sizeof(payload_bytes)};
+    digi_serial_t other = {.serial = {0x00, 0x13, 0xA2, 0x00, 0xFF, 0xEE, 0xDD, 0xCC}};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+    uint8_t expected[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    size_t size = digi_generate_transmit_request(message, sizeof(message), 1, &id, 0, &payload, 1);
+    LONGS_EQUAL(size, digi_generate_transmit_request(expected, sizeof(expected), 0xC3, &other, 0, &payload, 1));
+
+    CHECK(digi_retarget_transmit_request(message, size, 0xC3, &other) == DIGI_OK);
+    MEMCMP_EQUAL(expected, message, size);
+}
+
+// Only a whole transmit request frame is retargeted
+TEST(Test, check_retarget_rejects_other_frames)
+{
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    size_t size = digi_generate_transmit_request(message, sizeof(message), 1, &id, 0, NULL, 0);
+    CHECK(digi_retarget_transmit_request(message, size - 1, 2, &id) == DIGI_ERROR);
+
+    size = digi_generate_set_field_message(message, sizeof(message), 1, DIGI_FIELD_CH, 0x0C);
+    CHECK(digi_retarget_transmit_request(message, size, 2, &id) == DIGI_ERROR);
+    CHECK(digi_retarget_transmit_request(message, 3, 2, &id) == DIGI_ERROR);
+}
+
+// Fields are written with their own width
+TEST(Test, check_message_to_set_channel_uses_one_byte)
+{
+    uint8_t expected[] = {0x7E, 0x00, 0x05, 0x08, 0x02, 'C', 'H', 0x0C, 0x5E};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    LONGS_EQUAL(sizeof(expected), digi_generate_set_field_message(message, sizeof(message), 2, DIGI_FIELD_CH, 0x0C));
+    MEMCMP_EQUAL(expected, message, sizeof(expected));
+}
+
+// Read only fields can't be set
+TEST(Test, check_read_only_field_is_not_set)
+{
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    CHECK(!digi_field_info(DIGI_FIELD_SH)->writable);
+    LONGS_EQUAL(0, digi_generate_set_field_message(message, sizeof(message), 1, DIGI_FIELD_SH, 0));
+}
+
+// A configuration queues each value without a response and ends with an AC that applies them
+TEST(Test, check_configuration_queues_value_then_applies)
+{
+    digi_setting_t settings[] = {{DIGI_FIELD_CH, 0x0C}};
+    uint8_t expected[] = {0x7E, 0x00, 0x05, 0x09, 0x00, 'C', 'H', 0x0C, 0x5F,
+                          0x7E, 0x00, 0x04, 0x08, 0x05, 'A', 'C', 0x6E};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    LONGS_EQUAL(sizeof(expected), digi_generate_configuration(message, sizeof(message), 5, settings, 1));
+    MEMCMP_EQUAL(expected, message, sizeof(expected));
+}
+
+// A configuration with a setting that can't be built isn't generated
+TEST(Test, check_configuration_with_read_only_field_is_not_generated)
+{
+    digi_setting_t settings[] = {{DIGI_FIELD_CH, 0x0C}, {DIGI_FIELD_SH, 0}};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    LONGS_EQUAL(0, digi_generate_configuration(message, sizeof(message), 5, settings, 2));
+}
+
+// A configuration that doesn't fit isn't generated, even when only the AC is left over
+TEST(Test, check_configuration_is_not_generated_into_small_buffer)
+{
+    digi_setting_t settings[] = {{DIGI_FIELD_CH, 0x0C}};
+    uint8_t message[16] = {0};
+
+    LONGS_EQUAL(0, digi_generate_configuration(message, sizeof(message), 5, settings, 1));
+}
+
+// Codes that aren't fields aren't found
+TEST(Test, check_unknown_code_is_not_a_field)
+{
+    uint8_t code[2] = {'Z', 'Z'};
+
+    CHECK(digi_field_from_code(code) == DIGI_FIELD_END);
+    CHECK(digi_field_info(DIGI_FIELD_END) == NULL);
+}
+
+// A local AT command response is matched to its field
+TEST(Test, check_at_response_decodes_field)
+{
+    digi_at_response_t response;
+    size_t consumed = 0;
+
+    digi_parser_feed(&parser, id_response, sizeof(id_response), &consumed, &frame);
+    IS_OK(digi_decode_at_response(&frame, &response));
+    BYTES_EQUAL(1, response.frame_id);
+    CHECK(response.field == DIGI_FIELD_ID);
+    BYTES_EQUAL(0, response.status);
+    LONGS_EQUAL(2, response.length);
+    POINTERS_EQUAL(&id_response[8], response.value);
+}
+
+// A receive packet decodes to a view of its payload in the input
+TEST(Test, check_receive_packet_decodes_in_place)
+{
+    uint8_t bytes[] = {0x7E, 0x00, 0x0E, 0x90, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0xFF, 0xFE, 0x01, 0xAA, 0xBB, 0xE8};
+    digi_receive_packet_t packet;
+    size_t consumed = 0;
+
+    CHECK(digi_parser_feed(&parser, bytes, sizeof(bytes), &consumed, &frame) == DIGI_PARSE_FRAME);
+    IS_OK(digi_decode_receive_packet(&frame, &packet));
+    MEMCMP_EQUAL(id.serial, packet.source.serial, DIGI_SERIAL_LENGTH);
+    BYTES_EQUAL(0x01, packet.options);
+    LONGS_EQUAL(2, packet.length);
+    POINTERS_EQUAL(&bytes[15], packet.payload);
+}
+
+// Frames that aren't receive packets are refused
+TEST(Test, check_receive_packet_rejects_other_frames)
+{
+    digi_receive_packet_t packet;
+    size_t consumed = 0;
+
+    digi_parser_feed(&parser, id_response, sizeof(id_response), &consumed, &frame);
+    CHECK(digi_decode_receive_packet(&frame, &packet) == DIGI_ERROR);
+
+    frame.type = DIGI_FRAME_RECEIVE_PACKET;
+    CHECK(digi_decode_receive_packet(&frame, &packet) == DIGI_ERROR);
 }
 
 /********/
 /* Many */
 /********/
+
+// A payload spread over several pieces is sent back to back
+TEST(Test, check_transmit_request_gathers_payload_pieces)
+{
+    uint8_t header[] = {0xA0, 0xA1};
+    uint8_t body[] = {0xB0, 0xB1, 0xB2};
+    digi_payload_t payload[] = {{header, sizeof(header)}, {NULL, 0}, {body, sizeof(body)}};
+    uint8_t expected_payload[] = {0xA0, 0xA1, 0xB0, 0xB1, 0xB2};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+    size_t consumed = 0;
+
+    size_t size = digi_generate_transmit_request(message, sizeof(message), 3, &id, 0, payload, 3);
+    LONGS_EQUAL(18 + sizeof(expected_payload), size);
+
+    CHECK(digi_parser_feed(&parser, message, size, &consumed, &frame) == DIGI_PARSE_FRAME);
+    BYTES_EQUAL(DIGI_FRAME_TRANSMIT_REQUEST, frame.type);
+    LONGS_EQUAL(13 + sizeof(expected_payload), frame.length);
+    MEMCMP_EQUAL(expected_payload, &frame.data[13], sizeof(expected_payload));
+}
+
+// A frame retargeted many times over still parses for every destination
+TEST(Test, check_transmit_request_fans_out)
+{
+    uint8_t payload_bytes[40];
+    digi_payload_t payload = {payload_bytes, sizeof(payload_bytes)};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+
+    for(size_t idx = 0; idx < sizeof(payload_bytes); idx++)
+    {
+        payload_bytes[idx] = (uint8_t)(idx * 37);
+    }
+
+    size_t size = digi_generate_transmit_request(message, sizeof(message), 1, &id, 0, &payload, 1);
+
+    for(uint16_t node = 0; node < 300; node++)
+    {
+        digi_serial_t destination = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x40, (uint8_t)(node >> 8), (uint8_t)node, (uint8_t)(node * 7)}};
+        size_t consumed = 0;
+
+        CHECK(digi_retarget_transmit_request(message, size, (uint8_t)(node | 1), &destination) == DIGI_OK);
+        CHECK(digi_parser_feed(&parser, message, size, &consumed, &frame) == DIGI_PARSE_FRAME);
+        BYTES_EQUAL((uint8_t)(node | 1), frame.data[0]);
+        MEMCMP_EQUAL(destination.serial, &frame.data[1], DIGI_SERIAL_LENGTH);
+        MEMCMP_EQUAL(payload_bytes, &frame.data[13], sizeof(payload_bytes));
+    }
+}
+
+// Every setting in a configuration is queued in order and only the final AC asks for a response
+TEST(Test, check_configuration_parses_into_queued_frames_and_apply)
+{
+    digi_setting_t settings[] = {{DIGI_FIELD_ID, 0x7FFF}, {DIGI_FIELD_CH, 0x0C}, {DIGI_FIELD_DH, 0x0013A200}};
+    uint8_t message[MAXIMUM_MESSAGE_SIZE] = {0};
+    size_t size = digi_generate_configuration(message, sizeof(message), 9, settings, 3);
+    size_t offset = 0;
+    int frames = 0;
+
+    LONGS_EQUAL(10 + 9 + 12 + 8, size);
+
+    while(offset < size)
+    {
+        size_t consumed = 0;
+        CHECK(digi_parser_feed(&parser, &message[offset], size - offset, &consumed, &frame) == DIGI_PARSE_FRAME);
+        offset += consumed;
+
+        if(frames < 3)
+        {
+            BYTES_EQUAL(DIGI_FRAME_LOCAL_AT_QUEUE, frame.type);
+            BYTES_EQUAL(0, frame.data[0]);
+            LONGS_EQUAL(settings[frames].field, digi_field_from_code(&frame.data[1]));
+        }
+        else
+        {
+            BYTES_EQUAL(DIGI_FRAME_LOCAL_AT, frame.type);
+            BYTES_EQUAL(9, frame.data[0]);
+            LONGS_EQUAL(DIGI_FIELD_AC, digi_field_from_code(&frame.data[1]));
+        }
+        frames++;
+    }
+
+    LONGS_EQUAL(4, frames);
+}
+
+// Registering one digi module leaves the others untouched
+TEST(Test, check_digi_contexts_are_independent)
+{
+    digi_context_storage_t other_storage;
+    digi_t * other = digi_init(&other_storage);
+    digi_serial_t serial;
+
+    register_digi();
+
+    IS_DIGI_REGISTERED();
+    CHECK(!digi_is_initialized(other));
+
+    IS_OK(digi_get_serial(digi, &serial));
+    MEMCMP_EQUAL(id.serial, serial.serial, DIGI_SERIAL_LENGTH);
+}
+
+// A noise byte that looks like a start delimiter can claim a length that swallows a real frame. The real
+// frame is found inside the dropped one however the bytes are chunked.
+TEST(Test, check_parser_finds_frame_inside_dropped_frame)
+{
+    uint8_t stream[3 + sizeof(id_response) + 24] = {0x7E, 0x00, 0x20};
+
+    memcpy(&stream[3], id_response, sizeof(id_response));
+
+    for(size_t chunk = 1; chunk <= sizeof(stream); chunk++)
+    {
+        digi_parser_init(&parser);
+        LONGS_EQUAL(1, feed_in_chunks(stream, sizeof(stream), chunk));
+        LONGS_EQUAL(1, digi_parser_resyncs(&parser));
+        LONGS_EQUAL(sizeof(stream) - sizeof(id_response), digi_parser_discarded(&parser));
+    }
+}
+
+// A caller that stops once its input is used up misses a frame kept back from a dropped one. The frame only
+// comes out of the extra call with no input left.
+TEST(Test, check_parser_needs_drain_call_after_input_runs_out)
+{
+    uint8_t stream[3 + sizeof(id_response)] = {0x7E, 0x00, sizeof(id_response) - 1};
+    int frames = 0;
+
+    memcpy(&stream[3], id_response, sizeof(id_response));
+
+    // Split the noise frame across calls so it is gathered, and end the input with its checksum
+    size_t offsets[] = {0, 1, sizeof(stream)};
+    for(size_t idx = 0; idx + 1 < sizeof(offsets) / sizeof(offsets[0]); idx++)
+    {
+        size_t offset = offsets[idx];
+        size_t length = offsets[idx + 1] - offset;
+
+        while(length > 0)
+        {
+            size_t consumed = 0;
+            if(digi_parser_feed(&parser, &stream[offset], length, &consumed, &frame) == DIGI_PARSE_FRAME)
+            {
+                frames++;
+            }
+            offset += consumed;
+            length -= consumed;
+        }
+    }
+    LONGS_EQUAL(0, frames);
+
+    size_t consumed = 0;
+    CHECK(digi_parser_feed(&parser, stream, 0, &consumed, &frame) == DIGI_PARSE_FRAME);
+    LONGS_EQUAL(0, consumed);
+    BYTES_EQUAL(DIGI_FRAME_LOCAL_AT_RESPONSE, frame.type);
+    MEMCMP_EQUAL(&id_response[4], frame.data, 6);
+
+    digi_parser_init(&parser);
+    LONGS_EQUAL(1, feed_in_chunks(stream, 1, 1) + feed_in_chunks(&stream[1], sizeof(stream) - 1, sizeof(stream)));
+}
+
+// Dropped frames nested inside each other are unpicked one start delimiter at a time
+TEST(Test, check_parser_finds_frame_inside_nested_dropped_frames)
+{
+    uint8_t stream[6 + sizeof(id_response) + 40] = {0x7E, 0x00, 0x30, 0x7E, 0x00, 0x10};
+
+    memcpy(&stream[6], id_response, sizeof(id_response));
+
+    for(size_t chunk = 1; chunk <= sizeof(stream); chunk++)
+    {
+        digi_parser_init(&parser);
+        LONGS_EQUAL(1, feed_in_chunks(stream, sizeof(stream), chunk));
+        LONGS_EQUAL(2, digi_parser_resyncs(&parser));
+        LONGS_EQUAL(sizeof(stream) - sizeof(id_response), digi_parser_discarded(&parser));
+    }
+}
+
+// Every field's code leads back to the field
+TEST(Test, check_every_field_code_round_trips)
+{
+    for(int field = 0; field < DIGI_FIELD_END; field++)
+    {
+        const digi_field_info_t * info = digi_field_info((digi_field_t)field);
+        uint8_t code[2] = {(uint8_t)info->code[0], (uint8_t)info->code[1]};
+
+        LONGS_EQUAL(field, digi_field_from_code(code));
+    }
+}
+
+// Noise between frames is skipped and every frame is found no matter how the input is chunked
+TEST(Test, check_parser_finds_frames_among_noise_in_any_chunking)
+{
+    uint8_t stream[3 * sizeof(id_response) + 4] = {0};
+    size_t offset = 0;
+
+    stream[offset++] = 0x13;
+    for(int idx = 0; idx < 3; idx++)
+    {
+        memcpy(&stream[offset], id_response, sizeof(id_response));
+        offset += sizeof(id_response);
+        stream[offset++] = 0x00;
+    }
+
+    for(size_t chunk = 1; chunk <= sizeof(stream); chunk++)
+    {
+        digi_parser_init(&parser);
+        LONGS_EQUAL(3, feed_in_chunks(stream, offset, chunk));
+        LONGS_EQUAL(4, digi_parser_discarded(&parser));
+    }
+}
@@ -0,0 +1,273 @@
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+
+extern "C" 
+{
+    #include "c_driver_digimesh_aggregate.h"
+}
+
+
+#define PAYLOAD_SIZE 32
+#define SLOTS 2
+#define MAXIMUM_SENT 16
+
+typedef struct{
+    digi_serial_t destinations[MAXIMUM_SENT];
+    uint8_t payloads[MAXIMUM_SENT][PAYLOAD_SIZE];
+    size_t lengths[MAXIMUM_SENT];
+    size_t count;
+    bool refuse;        // Fail every send without taking it
+}sent_t;
+
+typedef struct{
+    uint8_t data[MAXIMUM_SENT][PAYLOAD_SIZE];
+    size_t lengths[MAXIMUM_SENT];
+    size_t count;
+}received_t;
+
+static digi_status_t capture_send(void * context, const digi_serial_t * destination, const uint8_t * payload, size_t length)
+{
+    sent_t * sent = (sent_t *)context;
+
+    if(sent->refuse)
+    {
+        return DIGI_ERROR;
+    }
+
+    sent->destinations[sent->count] = *destination;
+    memcpy(sent->payloads[sent->count], payload, length);
+    sent->lengths[sent->count] = length;
+    sent->count++;
+
+    return DIGI_OK;
+}
+
+static void capture_receive(void * context, const digi_serial_t * source, const uint8_t * data, size_t length)
+{
+    received_t * received = (received_t *)context;
+
+    memcpy(received->data[received->count], data, length);
+    received->lengths[received->count] = length;
+    received->count++;
+}
+
+TEST_GROUP(Aggregate) 
+{
+    void setup()
+    {
+        memset(&sent, 0, sizeof(sent));
+        memset(&received, 0, sizeof(received));
+        CHECK(digi_aggregate_init(&aggregate, slots, SLOTS, buffers, PAYLOAD_SIZE, capture_send, &sent) == DIGI_OK);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_aggregate_t aggregate;
+    digi_aggregate_slot_t slots[SLOTS];
+    uint8_t buffers[SLOTS * PAYLOAD_SIZE];
+    sent_t sent;
+    received_t received;
+    digi_serial_t gateway = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x40, 0x00, 0x00, 0x01}};
+    digi_serial_t other = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x40, 0x00, 0x00, 0x02}};
+    digi_serial_t third = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x40, 0x00, 0x00, 0x03}};
+    uint8_t reading[PAYLOAD_SIZE] = {0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1A, 0x1B};
+
+    // Split a sent payload as the receiving end would
+    digi_status_t split(size_t index)
+    {
+        digi_receive_packet_t packet = {};
+
+        packet.source = sent.destinations[index];
+        packet.payload = sent.payloads[index];
+        packet.length = (uint16_t)sent.lengths[index];
+
+        return digi_aggregate_split(&packet, capture_receive, &received);
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// Nothing queued sends nothing
+TEST(Aggregate, check_empty_sends_nothing)
+{
+    CHECK(digi_aggregate_poll(&aggregate, 1000) == DIGI_OK);
+    CHECK(digi_aggregate_flush(&aggregate) == DIGI_OK);
+
+    LONGS_EQUAL(0, sent.count);
+    LONGS_EQUAL(0, digi_aggregate_payloads(&aggregate));
+}
+
+// Storage that can't hold the slots is refused
+TEST(Aggregate, check_init_rejects_bad_storage)
+{
+    CHECK(digi_aggregate_init(&aggregate, slots, 0, buffers, PAYLOAD_SIZE, capture_send, &sent) == DIGI_ERROR);
+    CHECK(digi_aggregate_init(&aggregate, slots, SLOTS, NULL, PAYLOAD_SIZE, capture_send, &sent) == DIGI_ERROR);
+    CHECK(digi_aggregate_init(&aggregate, NULL, SLOTS, buffers, PAYLOAD_SIZE, capture_send, &sent) == DIGI_ERROR);
+    CHECK(digi_aggregate_init(&aggregate, slots, SLOTS, buffers, 0, capture_send, &sent) == DIGI_ERROR);
+    CHECK(digi_aggregate_init(&aggregate, slots, SLOTS, buffers, SIZE_MAX, capture_send, &sent) == DIGI_ERROR);
+}
+
+// A message too long to pack is refused
+TEST(Aggregate, check_long_message_is_refused)
+{
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, PAYLOAD_SIZE, 10, 0) == DIGI_ERROR);
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, PAYLOAD_SIZE - DIGI_AGGREGATE_HEADER_SIZE, 10, 0) == DIGI_OK);
+}
+
+// An empty payload splits into no messages
+TEST(Aggregate, check_split_empty)
+{
+    digi_receive_packet_t packet = {};
+
+    CHECK(digi_aggregate_split(&packet, capture_receive, &received) == DIGI_OK);
+    LONGS_EQUAL(0, received.count);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A message waits until its latency runs out
+TEST(Aggregate, check_sent_at_deadline)
+{
+    uint8_t expected[] = {0x03, 0x10, 0x11, 0x12};
+
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 3, 10, 100) == DIGI_OK);
+
+    digi_aggregate_poll(&aggregate, 109);
+    LONGS_EQUAL(0, sent.count);
+
+    digi_aggregate_poll(&aggregate, 110);
+    LONGS_EQUAL(1, sent.count);
+    LONGS_EQUAL(sizeof(expected), sent.lengths[0]);
+    MEMCMP_EQUAL(expected, sent.payloads[0], sizeof(expected));
+    MEMCMP_EQUAL(gateway.serial, sent.destinations[0].serial, DIGI_SERIAL_LENGTH);
+}
+
+// A payload with a length running past its end is rejected without delivering anything
+TEST(Aggregate, check_split_rejects_overrun)
+{
+    uint8_t payload[] = {0x01, 0xAA, 0x05, 0xBB};
+    digi_receive_packet_t packet = {};
+    packet.payload = payload;
+    packet.length = sizeof(payload);
+
+    CHECK(digi_aggregate_split(&packet, capture_receive, &received) == DIGI_ERROR);
+    LONGS_EQUAL(0, received.count);
+}
+
+// Deadlines keep working when the clock wraps
+TEST(Aggregate, check_deadline_across_wrap)
+{
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 3, 20, UINT32_MAX - 9) == DIGI_OK);
+
+    digi_aggregate_poll(&aggregate, 5);
+    LONGS_EQUAL(0, sent.count);
+    digi_aggregate_poll(&aggregate, 10);
+    LONGS_EQUAL(1, sent.count);
+}
+
+/********/
+/* Many */
+/********/
+
+// Messages for one destination share a payload and split back apart in order
+TEST(Aggregate, check_messages_pack_and_split)
+{
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 6, 50, 0) == DIGI_OK);
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, &reading[6], 4, 50, 1) == DIGI_OK);
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 0, 50, 2) == DIGI_OK);
+    digi_aggregate_flush(&aggregate);
+
+    LONGS_EQUAL(1, sent.count);
+    LONGS_EQUAL(3 + 6 + 4, sent.lengths[0]);
+    LONGS_EQUAL(3, digi_aggregate_messages(&aggregate));
+
+    CHECK(split(0) == DIGI_OK);
+    LONGS_EQUAL(3, received.count);
+    LONGS_EQUAL(6, received.lengths[0]);
+    MEMCMP_EQUAL(reading, received.data[0], 6);
+    LONGS_EQUAL(4, received.lengths[1]);
+    MEMCMP_EQUAL(&reading[6], received.data[1], 4);
+    LONGS_EQUAL(0, received.lengths[2]);
+}
+
+// The most urgent message sets when the payload goes out
+TEST(Aggregate, check_earliest_deadline_wins)
+{
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 4, 100, 0) == DIGI_OK);
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 4, 10, 5) == DIGI_OK);
+
+    digi_aggregate_poll(&aggregate, 14);
+    LONGS_EQUAL(0, sent.count);
+    digi_aggregate_poll(&aggregate, 15);
+    LONGS_EQUAL(1, sent.count);
+    LONGS_EQUAL(10, sent.lengths[0]);
+}
+
+// A message that doesn't fit sends what is waiting first, and a full payload goes out straight away
+TEST(Aggregate, check_size_flushes)
+{
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 12, 100, 0) == DIGI_OK);
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 12, 100, 0) == DIGI_OK);
+    LONGS_EQUAL(0, sent.count);
+
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 12, 100, 0) == DIGI_OK);
+    LONGS_EQUAL(1, sent.count);
+    LONGS_EQUAL(26, sent.lengths[0]);
+
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, PAYLOAD_SIZE - 13 - DIGI_AGGREGATE_HEADER_SIZE, 100, 0) == DIGI_OK);
+    LONGS_EQUAL(2, sent.count);
+    LONGS_EQUAL(PAYLOAD_SIZE, sent.lengths[1]);
+}
+
+// Destinations are packed separately, and a new one sends the most urgent when every slot is in use
+TEST(Aggregate, check_destinations_separate)
+{
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 4, 10, 0) == DIGI_OK);
+    CHECK(digi_aggregate_queue(&aggregate, &other, reading, 5, 50, 0) == DIGI_OK);
+    LONGS_EQUAL(0, sent.count);
+
+    CHECK(digi_aggregate_queue(&aggregate, &third, reading, 6, 30, 0) == DIGI_OK);
+    LONGS_EQUAL(1, sent.count);
+    MEMCMP_EQUAL(gateway.serial, sent.destinations[0].serial, DIGI_SERIAL_LENGTH);
+
+    CHECK(digi_aggregate_poll(&aggregate, 30) == DIGI_OK);
+    LONGS_EQUAL(2, sent.count);
+    MEMCMP_EQUAL(third.serial, sent.destinations[1].serial, DIGI_SERIAL_LENGTH);
+    LONGS_EQUAL(7, sent.lengths[1]);
+
+    CHECK(digi_aggregate_flush(&aggregate) == DIGI_OK);
+    LONGS_EQUAL(3, sent.count);
+    MEMCMP_EQUAL(other.serial, sent.destinations[2].serial, DIGI_SERIAL_LENGTH);
+    LONGS_EQUAL(3, digi_aggregate_payloads(&aggregate));
+}
+
+// A send the transport refuses keeps its messages queued, and a message needing that send is refused
+TEST(Aggregate, check_failed_send_keeps_messages)
+{
+    CHECK(digi_aggregate_queue(&aggregate, &gateway, reading, 4, 10, 0) == DIGI_OK);
+    CHECK(digi_aggregate_queue(&aggregate, &other, reading, 5, 50, 0) == DIGI_OK);
+
+    sent.refuse = true;
+    CHECK(digi_aggregate_poll(&aggregate, 10) == DIGI_ERROR);
+    CHECK(digi_aggregate_queue(&aggregate, &third, reading, 6, 30, 0) == DIGI_ERROR);
+    CHECK(digi_aggregate_flush(&aggregate) == DIGI_ERROR);
+    LONGS_EQUAL(0, digi_aggregate_payloads(&aggregate));
+
+    sent.refuse = false;
+    CHECK(digi_aggregate_poll(&aggregate, 10) == DIGI_OK);
+    LONGS_EQUAL(1, sent.count);
+    MEMCMP_EQUAL(gateway.serial, sent.destinations[0].serial, DIGI_SERIAL_LENGTH);
+    LONGS_EQUAL(5, sent.lengths[0]);
+
+    CHECK(digi_aggregate_flush(&aggregate) == DIGI_OK);
+    LONGS_EQUAL(2, sent.count);
+    MEMCMP_EQUAL(other.serial, sent.destinations[1].serial, DIGI_SERIAL_LENGTH);
+    LONGS_EQUAL(2, digi_aggregate_messages(&aggregate));
+}
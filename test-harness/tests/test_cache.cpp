@@ -0,0 +1,260 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_cache.h"
+}
+
+
+TEST_GROUP(Cache) 
+{
+    void setup()
+    {
+        digi_cache_init(&cache);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_cache_t cache;
+    uint8_t data[8];
+    uint8_t message[MAXIMUM_MESSAGE_SIZE];
+
+    // Make a local AT command response with a value of up to 4 bytes. Each call reuses the same storage.
+    digi_frame_view_t response(char first, char second, uint8_t status, const uint8_t * value, uint16_t length)
+    {
+        data[0] = 1;
+        data[1] = (uint8_t)first;
+        data[2] = (uint8_t)second;
+        data[3] = status;
+        if(length > 0)
+        {
+            memcpy(&data[4], value, length);
+        }
+
+        digi_frame_view_t frame = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, (uint16_t)(4 + length)};
+        return frame;
+    }
+
+    // Fill the cache with the network id 0x7FFF
+    void learn_network_id()
+    {
+        uint8_t value[] = {0x7F, 0xFF};
+        digi_frame_view_t frame = response('I', 'D', 0, value, sizeof(value));
+        digi_cache_frame(&cache, &frame);
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// Nothing is cached after initialization
+TEST(Cache, check_nothing_cached_on_init)
+{
+    uint32_t value = 0;
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_ERROR);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_END, &value) == DIGI_ERROR);
+    LONGS_EQUAL(0, digi_cache_hits(&cache));
+    LONGS_EQUAL(2, digi_cache_misses(&cache));
+}
+
+// A string field is never cached, even when its value is short enough to look like an integer
+TEST(Cache, check_string_field_is_not_cached)
+{
+    uint32_t value = 0;
+    digi_frame_view_t frame = response('N', 'I', 0, (const uint8_t *)"AB", 2);
+
+    digi_cache_frame(&cache, &frame);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_NI, &value) == DIGI_ERROR);
+}
+
+// A read of a field that is never cached builds no query
+TEST(Cache, check_read_of_string_field_builds_no_query)
+{
+    uint32_t value = 0;
+    size_t written = 1;
+
+    CHECK(digi_cache_read(&cache, DIGI_FIELD_NI, &value, message, sizeof(message), 1, &written) == DIGI_ERROR);
+    LONGS_EQUAL(0, written);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A query response fills the cache and later reads hit
+TEST(Cache, check_query_response_is_cached)
+{
+    uint32_t value = 0;
+
+    learn_network_id();
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_OK);
+    LONGS_EQUAL(0x7FFF, value);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_OK);
+    LONGS_EQUAL(2, digi_cache_hits(&cache));
+    LONGS_EQUAL(0, digi_cache_misses(&cache));
+}
+
+// Responses with an error status or no value aren't cached
+TEST(Cache, check_failed_and_empty_responses_are_not_cached)
+{
+    uint8_t value[] = {0x0C};
+    uint32_t cached = 0;
+    digi_frame_view_t frame = response('C', 'H', 3, value, sizeof(value));
+    digi_cache_frame(&cache, &frame);
+    frame = response('P', 'L', 0, value, 0);
+    digi_cache_frame(&cache, &frame);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_CH, &cached) == DIGI_ERROR);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_PL, &cached) == DIGI_ERROR);
+}
+
+// Setting a field forgets it
+TEST(Cache, check_local_write_invalidates_field)
+{
+    uint32_t value = 0;
+    size_t size = digi_generate_set_field_message(message, sizeof(message), 1, DIGI_FIELD_ID, 0x1234);
+
+    learn_network_id();
+    digi_cache_sent(&cache, message, size);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_ERROR);
+}
+
+// Querying a field doesn't forget it
+TEST(Cache, check_local_query_keeps_field)
+{
+    uint32_t value = 0;
+    size_t size = digi_generate_get_field_message(message, sizeof(message), 1, DIGI_FIELD_ID);
+
+    learn_network_id();
+    digi_cache_sent(&cache, message, size);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_OK);
+}
+
+// Sending RE forgets everything
+TEST(Cache, check_restore_defaults_invalidates_all)
+{
+    uint32_t value = 0;
+    size_t size = digi_generate_get_field_message(message, sizeof(message), 1, DIGI_FIELD_RE);
+
+    learn_network_id();
+    digi_cache_sent(&cache, message, size);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_ERROR);
+}
+
+// A successful AC response forgets everything
+TEST(Cache, check_apply_response_invalidates_all)
+{
+    uint32_t value = 0;
+
+    learn_network_id();
+    digi_frame_view_t applied = response('A', 'C', 0, NULL, 0);
+    digi_cache_frame(&cache, &applied);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_ERROR);
+}
+
+// A modem status reset forgets everything but other modem status doesn't
+TEST(Cache, check_modem_reset_invalidates_all)
+{
+    uint32_t value = 0;
+    uint8_t associated[] = {DIGI_MODEM_STATUS_JOINED};
+    uint8_t reset[] = {DIGI_MODEM_STATUS_HARDWARE_RESET};
+    digi_frame_view_t status = {DIGI_FRAME_MODEM_STATUS, associated, 1};
+
+    learn_network_id();
+    digi_cache_frame(&cache, &status);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_OK);
+
+    status.data = reset;
+    digi_cache_frame(&cache, &status);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_ERROR);
+}
+
+// A read that misses builds the query, and its response makes the next read a hit
+TEST(Cache, check_read_through_builds_query_then_hits)
+{
+    uint8_t expected[] = {0x7E, 0x00, 0x04, 0x08, 0x05, 'I', 'D', 0x65};
+    uint32_t value = 0;
+    size_t written = 0;
+
+    CHECK(digi_cache_read(&cache, DIGI_FIELD_ID, &value, message, sizeof(message), 5, &written) == DIGI_ERROR);
+    LONGS_EQUAL(sizeof(expected), written);
+    MEMCMP_EQUAL(expected, message, sizeof(expected));
+
+    learn_network_id();
+
+    CHECK(digi_cache_read(&cache, DIGI_FIELD_ID, &value, message, sizeof(message), 6, &written) == DIGI_OK);
+    LONGS_EQUAL(0, written);
+    LONGS_EQUAL(0x7FFF, value);
+    LONGS_EQUAL(1, digi_cache_hits(&cache));
+    LONGS_EQUAL(1, digi_cache_misses(&cache));
+}
+
+/********/
+/* Many */
+/********/
+
+// A configuration forgets the fields it sets and, through its AC, everything else
+TEST(Cache, check_configuration_invalidates_all)
+{
+    digi_setting_t settings[] = {{DIGI_FIELD_CH, 0x0C}};
+    uint8_t channel[] = {0x0B};
+    uint32_t value = 0;
+    size_t size = digi_generate_configuration(message, sizeof(message), 1, settings, 1);
+
+    learn_network_id();
+    digi_frame_view_t frame = response('C', 'H', 0, channel, sizeof(channel));
+    digi_cache_frame(&cache, &frame);
+    digi_cache_sent(&cache, message, size);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_ERROR);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_CH, &value) == DIGI_ERROR);
+}
+
+// A field learned after an invalidation is cached again while the rest stay forgotten
+TEST(Cache, check_relearn_after_invalidation)
+{
+    uint8_t channel[] = {0x0C};
+    uint32_t value = 0;
+
+    learn_network_id();
+    for(int idx = 0; idx < 3; idx++)
+    {
+        digi_cache_invalidate_all(&cache);
+    }
+    digi_frame_view_t frame = response('C', 'H', 0, channel, sizeof(channel));
+    digi_cache_frame(&cache, &frame);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_CH, &value) == DIGI_OK);
+    LONGS_EQUAL(0x0C, value);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_ERROR);
+    LONGS_EQUAL(1, digi_cache_hits(&cache));
+    LONGS_EQUAL(1, digi_cache_misses(&cache));
+}
+
+// Values are kept per field
+TEST(Cache, check_fields_are_independent)
+{
+    uint8_t channel[] = {0x0C};
+    uint8_t level[] = {0x04};
+    uint32_t value = 0;
+    digi_frame_view_t frame = response('C', 'H', 0, channel, sizeof(channel));
+
+    digi_cache_frame(&cache, &frame);
+    frame = response('P', 'L', 0, level, sizeof(level));
+    digi_cache_frame(&cache, &frame);
+    digi_cache_invalidate(&cache, DIGI_FIELD_CH);
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_CH, &value) == DIGI_ERROR);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_PL, &value) == DIGI_OK);
+    LONGS_EQUAL(4, value);
+}
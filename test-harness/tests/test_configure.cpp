@@ -0,0 +1,153 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_configure.h"
+}
+
+
+TEST_GROUP(Configure) 
+{
+    void setup()
+    {
+        digi_pending_init(&pending);
+        digi_parser_init(&parser);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_pending_t pending;
+    digi_parser_t parser;
+    digi_configure_t configure;
+    uint8_t message[MAXIMUM_MESSAGE_SIZE * 4];
+    digi_setting_t settings[3] = {{DIGI_FIELD_ID, 0x7FFF}, {DIGI_FIELD_CH, 0x0C}, {DIGI_FIELD_DH, 0x0013A200}};
+
+    // Parse the batch and return the frame id of the final AC, checking nothing before it asks for a response
+    uint8_t apply_frame_id(size_t size)
+    {
+        size_t offset = 0;
+        uint8_t frame_id = 0;
+
+        while(offset < size)
+        {
+            size_t consumed = 0;
+            digi_frame_view_t frame;
+
+            CHECK(digi_parser_feed(&parser, &message[offset], size - offset, &consumed, &frame) == DIGI_PARSE_FRAME);
+            LONGS_EQUAL(0, frame_id);
+            frame_id = frame.data[0];
+            offset += consumed;
+        }
+
+        return frame_id;
+    }
+
+    // Answer the AC the way the digi module would
+    digi_status_t respond(uint8_t frame_id, uint8_t status)
+    {
+        uint8_t data[4] = {frame_id, 'A', 'C', status};
+        digi_frame_view_t frame = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+
+        return digi_pending_complete(&pending, &frame);
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// A batch that can't be built takes no frame id
+TEST(Configure, check_unbuildable_batch_takes_no_frame_id)
+{
+    LONGS_EQUAL(0, digi_configure_start(&configure, &pending, message, 8, settings, 3));
+    CHECK(digi_configure_done(&configure));
+    CHECK_FALSE(digi_pending_is_active(&pending, configure.frame_id));
+}
+
+/*******/
+/* One */
+/*******/
+
+// The batch is done once the AC's response arrives, and carries its status
+TEST(Configure, check_done_on_apply_response)
+{
+    size_t size = digi_configure_start(&configure, &pending, message, sizeof(message), settings, 3);
+    uint8_t frame_id = apply_frame_id(size);
+
+    CHECK(frame_id != 0);
+    CHECK_FALSE(digi_configure_done(&configure));
+    BYTES_EQUAL(0xFF, digi_configure_status(&configure));
+
+    CHECK(respond(frame_id, 0x00) == DIGI_OK);
+    CHECK(digi_configure_done(&configure));
+    BYTES_EQUAL(0x00, digi_configure_status(&configure));
+}
+
+// A rejected apply is reported
+TEST(Configure, check_apply_error_is_reported)
+{
+    size_t size = digi_configure_start(&configure, &pending, message, sizeof(message), settings, 3);
+
+    CHECK(respond(apply_frame_id(size), 0x03) == DIGI_OK);
+    BYTES_EQUAL(0x03, digi_configure_status(&configure));
+}
+
+// Cancelling gives back the frame id and a late response is ignored
+TEST(Configure, check_cancel_frees_frame_id)
+{
+    size_t size = digi_configure_start(&configure, &pending, message, sizeof(message), settings, 3);
+    uint8_t frame_id = apply_frame_id(size);
+
+    digi_configure_cancel(&configure);
+
+    CHECK(digi_configure_done(&configure));
+    CHECK_FALSE(digi_pending_is_active(&pending, frame_id));
+    CHECK(respond(frame_id, 0x00) == DIGI_ERROR);
+    BYTES_EQUAL(0xFF, digi_configure_status(&configure));
+}
+
+// A response that doesn't decode still ends the batch, as an error, and leaves its frame id alone after
+TEST(Configure, check_malformed_response_ends_batch)
+{
+    size_t size = digi_configure_start(&configure, &pending, message, sizeof(message), settings, 3);
+    uint8_t frame_id = apply_frame_id(size);
+    uint8_t data[2] = {frame_id, 'A'};
+    digi_frame_view_t frame = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+
+    CHECK(digi_pending_complete(&pending, &frame) == DIGI_OK);
+    CHECK(digi_configure_done(&configure));
+    BYTES_EQUAL(0x01, digi_configure_status(&configure));
+
+    // The id may belong to someone else by now so cancelling mustn't touch it
+    uint8_t other;
+    CHECK(digi_pending_add(&pending, NULL, NULL, &other) == DIGI_OK);
+    while(other != frame_id)
+    {
+        CHECK(digi_pending_add(&pending, NULL, NULL, &other) == DIGI_OK);
+    }
+    digi_configure_cancel(&configure);
+    CHECK(digi_pending_is_active(&pending, frame_id));
+}
+
+/********/
+/* Many */
+/********/
+
+// Batches in flight together are told apart by their AC's frame id
+TEST(Configure, check_batches_complete_independently)
+{
+    digi_configure_t other;
+    uint8_t first = apply_frame_id(digi_configure_start(&configure, &pending, message, sizeof(message), settings, 3));
+    uint8_t second = apply_frame_id(digi_configure_start(&other, &pending, message, sizeof(message), settings, 1));
+
+    CHECK(first != second);
+
+    CHECK(respond(second, 0x00) == DIGI_OK);
+    CHECK_FALSE(digi_configure_done(&configure));
+    CHECK(digi_configure_done(&other));
+
+    CHECK(respond(first, 0x00) == DIGI_OK);
+    CHECK(digi_configure_done(&configure));
+}
@@ -0,0 +1,327 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_delivery.h"
+}
+
+
+TEST_GROUP(Delivery) 
+{
+    void setup()
+    {
+        digi_pending_init(&pending);
+        digi_delivery_init(&delivery, &pending, nodes, links, 8);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_pending_t pending;
+    digi_delivery_t delivery;
+    digi_node_t nodes[8];
+    digi_delivery_link_t links[8];
+    uint8_t message[MAXIMUM_MESSAGE_SIZE];
+
+    digi_serial_t near_node = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x11}};
+    digi_serial_t far_node = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x22}};
+
+    // Send a transmit request to a destination at a time and give back the frame id it was sent with
+    uint8_t send(const digi_serial_t * destination, uint32_t now)
+    {
+        uint8_t frame_id = 0;
+
+        CHECK(digi_delivery_generate(&delivery, message, sizeof(message), destination, 0, NULL, 0, now, &frame_id) > 0);
+        BYTES_EQUAL(message[4], frame_id);
+
+        return frame_id;
+    }
+
+    // Receive the transmit status for a frame id at a time
+    digi_status_t status(uint8_t frame_id, uint8_t retries, uint8_t delivered, uint8_t discovery, uint32_t now)
+    {
+        uint8_t data[] = {frame_id, 0xFF, 0xFE, retries, delivered, discovery};
+        digi_frame_view_t frame = {DIGI_FRAME_TRANSMIT_STATUS, data, sizeof(data)};
+
+        return digi_delivery_complete(&delivery, &frame, now);
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// Capacity has to be a power of two
+TEST(Delivery, check_capacity_must_be_power_of_two)
+{
+    CHECK(digi_delivery_init(&delivery, &pending, nodes, links, 6) == DIGI_ERROR);
+    CHECK(digi_delivery_init(&delivery, &pending, nodes, links, 0) == DIGI_ERROR);
+}
+
+// Nothing is known before anything is sent
+TEST(Delivery, check_nothing_tracked_on_init)
+{
+    uint32_t cursor = 0;
+
+    POINTERS_EQUAL(NULL, digi_delivery_link(&delivery, &near_node));
+    POINTERS_EQUAL(NULL, digi_delivery_next(&delivery, &cursor));
+    CHECK(status(1, 0, 0, 0, 0) == DIGI_ERROR);
+}
+
+// A request that doesn't fit gives its frame id back and isn't tracked
+TEST(Delivery, check_request_that_does_not_fit_is_refused)
+{
+    uint8_t frame_id;
+
+    LONGS_EQUAL(0, digi_delivery_generate(&delivery, message, 4, &near_node, 0, NULL, 0, 0, &frame_id));
+
+    POINTERS_EQUAL(NULL, digi_delivery_link(&delivery, &near_node));
+    for(uint16_t id = 1; id < DIGI_PENDING_SLOTS; id++)
+    {
+        CHECK(!digi_pending_is_active(&pending, (uint8_t)id));
+    }
+}
+
+// Only a request still waiting can be cancelled
+TEST(Delivery, check_cancel_of_unknown_frame_id_is_refused)
+{
+    CHECK(digi_delivery_cancel(&delivery, 1) == DIGI_ERROR);
+    CHECK(digi_delivery_cancel(&delivery, 0) == DIGI_ERROR);
+}
+
+// Frames other than transmit statuses are refused
+TEST(Delivery, check_other_frame_is_refused)
+{
+    uint8_t data[] = {0x01, 'I', 'D', 0x00};
+    digi_frame_view_t frame = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+
+    CHECK(digi_delivery_complete(&delivery, &frame, 0) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A transmit status decodes from its frame
+TEST(Delivery, check_transmit_status_decodes)
+{
+    uint8_t data[] = {0x07, 0xFF, 0xFE, 0x02, 0x21, 0x02};
+    digi_frame_view_t frame = {DIGI_FRAME_TRANSMIT_STATUS, data, sizeof(data)};
+    digi_transmit_status_t decoded;
+
+    CHECK(digi_decode_transmit_status(&frame, &decoded) == DIGI_OK);
+    BYTES_EQUAL(0x07, decoded.frame_id);
+    BYTES_EQUAL(0x02, decoded.retries);
+    BYTES_EQUAL(0x21, decoded.delivery);
+    BYTES_EQUAL(0x02, decoded.discovery);
+
+    frame.length = 5;
+    CHECK(digi_decode_transmit_status(&frame, &decoded) == DIGI_ERROR);
+}
+
+// A delivered transmission is recorded against its destination
+TEST(Delivery, check_delivery_is_recorded)
+{
+    uint8_t id = send(&near_node, 100);
+    CHECK(status(id, 1, 0, 2, 112) == DIGI_OK);
+
+    const digi_delivery_link_t * link = digi_delivery_link(&delivery, &near_node);
+    CHECK(link != NULL);
+    LONGS_EQUAL(1, link->delivered);
+    LONGS_EQUAL(0, link->failed);
+    LONGS_EQUAL(1, link->latency[4]);
+    LONGS_EQUAL(1, link->retries[1]);
+    LONGS_EQUAL(1, link->discovery[DIGI_DELIVERY_DISCOVERY_ROUTE]);
+    LONGS_EQUAL(15, digi_delivery_latency_percentile(link, 50));
+}
+
+// A transmit status only matches once
+TEST(Delivery, check_status_matches_once)
+{
+    uint8_t id = send(&near_node, 0);
+
+    CHECK(status(id, 0, 0, 0, 1) == DIGI_OK);
+    CHECK(status(id, 0, 0, 0, 2) == DIGI_ERROR);
+}
+
+// A transmit status that never arrives counts as a failure once the timeout passes and frees its frame id
+TEST(Delivery, check_lost_status_times_out)
+{
+    uint8_t id = send(&near_node, 10);
+
+    digi_delivery_poll(&delivery, 109, 100);
+    CHECK(digi_pending_is_active(&pending, id));
+
+    digi_delivery_poll(&delivery, 110, 100);
+    CHECK_FALSE(digi_pending_is_active(&pending, id));
+
+    const digi_delivery_link_t * link = digi_delivery_link(&delivery, &near_node);
+    LONGS_EQUAL(1, link->failed);
+    LONGS_EQUAL(0, link->delivered);
+    LONGS_EQUAL(0, digi_nodes_find(&delivery.nodes, digi_serial_to_key(&near_node))->pending_tx);
+
+    // Should it turn up after all it's no longer matched
+    CHECK(status(id, 0, 0, 0, 111) == DIGI_ERROR);
+    digi_delivery_poll(&delivery, 500, 100);
+    LONGS_EQUAL(1, link->failed);
+}
+
+// A cancelled request frees its frame id without recording anything
+TEST(Delivery, check_cancel_frees_frame_id)
+{
+    uint8_t id = send(&near_node, 0);
+
+    CHECK(digi_delivery_cancel(&delivery, id) == DIGI_OK);
+    CHECK_FALSE(digi_pending_is_active(&pending, id));
+    CHECK(digi_delivery_cancel(&delivery, id) == DIGI_ERROR);
+    CHECK(status(id, 0, 0, 0, 1) == DIGI_ERROR);
+
+    const digi_delivery_link_t * link = digi_delivery_link(&delivery, &near_node);
+    LONGS_EQUAL(0, link->failed);
+    LONGS_EQUAL(0, link->delivered);
+    LONGS_EQUAL(0, digi_nodes_find(&delivery.nodes, digi_serial_to_key(&near_node))->pending_tx);
+}
+
+// A transmit status that doesn't decode still frees its request and counts as a failure
+TEST(Delivery, check_malformed_status_counts_as_failure)
+{
+    uint8_t id = send(&near_node, 0);
+    uint8_t data[] = {id, 0xFF};
+    digi_frame_view_t frame = {DIGI_FRAME_TRANSMIT_STATUS, data, sizeof(data)};
+
+    CHECK(digi_delivery_complete(&delivery, &frame, 1) == DIGI_OK);
+
+    LONGS_EQUAL(1, digi_delivery_link(&delivery, &near_node)->failed);
+    CHECK(digi_delivery_cancel(&delivery, id) == DIGI_ERROR);
+}
+
+// The destination's node counts the transmissions still waiting for a transmit status
+TEST(Delivery, check_node_counts_pending_transmissions)
+{
+    uint8_t first = send(&near_node, 0);
+    uint8_t second = send(&near_node, 0);
+    digi_node_t * node = digi_nodes_find(&delivery.nodes, digi_serial_to_key(&near_node));
+
+    CHECK(node != NULL);
+    LONGS_EQUAL(2, node->pending_tx);
+    CHECK(status(first, 0, 0, 0, 1) == DIGI_OK);
+    LONGS_EQUAL(1, node->pending_tx);
+    CHECK(status(second, 0, 0, 0, 1) == DIGI_OK);
+    LONGS_EQUAL(0, node->pending_tx);
+}
+
+// Extended timeout discovery has its own bucket and unknown values don't land in a known one
+TEST(Delivery, check_discovery_values_are_bucketed_explicitly)
+{
+    CHECK(status(send(&near_node, 0), 0, 0, 0x00, 1) == DIGI_OK);
+    CHECK(status(send(&near_node, 0), 0, 0, 0x03, 1) == DIGI_OK);
+    CHECK(status(send(&near_node, 0), 0, 0, 0x40, 1) == DIGI_OK);
+    CHECK(status(send(&near_node, 0), 0, 0, 0x42, 1) == DIGI_OK);
+
+    const digi_delivery_link_t * link = digi_delivery_link(&delivery, &near_node);
+    LONGS_EQUAL(1, link->discovery[DIGI_DELIVERY_DISCOVERY_NONE]);
+    LONGS_EQUAL(0, link->discovery[DIGI_DELIVERY_DISCOVERY_ADDRESS]);
+    LONGS_EQUAL(0, link->discovery[DIGI_DELIVERY_DISCOVERY_ROUTE]);
+    LONGS_EQUAL(1, link->discovery[DIGI_DELIVERY_DISCOVERY_ADDRESS_AND_ROUTE]);
+    LONGS_EQUAL(1, link->discovery[DIGI_DELIVERY_DISCOVERY_EXTENDED_TIMEOUT]);
+    LONGS_EQUAL(1, link->discovery[DIGI_DELIVERY_DISCOVERY_OTHER]);
+}
+
+/********/
+/* Many */
+/********/
+
+// Destinations are kept apart and a slow one stands out
+TEST(Delivery, check_slow_link_stands_out)
+{
+    for(uint8_t idx = 0; idx < 10; idx++)
+    {
+        uint8_t near_id = send(&near_node, 1000);
+        uint8_t far_id = send(&far_node, 1000);
+        CHECK(status(far_id, 3, (idx == 0) ? 0x21 : 0, 0, 1000 + 900) == DIGI_OK);
+        CHECK(status(near_id, 0, 0, 0, 1000 + 3) == DIGI_OK);
+    }
+
+    const digi_delivery_link_t * near_link = digi_delivery_link(&delivery, &near_node);
+    const digi_delivery_link_t * far_link = digi_delivery_link(&delivery, &far_node);
+
+    LONGS_EQUAL(10, near_link->delivered);
+    LONGS_EQUAL(9, far_link->delivered);
+    LONGS_EQUAL(1, far_link->failed);
+    LONGS_EQUAL(10, far_link->retries[3]);
+    LONGS_EQUAL(3, digi_delivery_latency_percentile(near_link, 99));
+    LONGS_EQUAL(1023, digi_delivery_latency_percentile(far_link, 50));
+
+    uint32_t cursor = 0;
+    int seen = 0;
+    while(digi_delivery_next(&delivery, &cursor) != NULL)
+    {
+        seen++;
+    }
+    LONGS_EQUAL(2, seen);
+}
+
+// Once the node table is at its load limit new destinations are counted as untracked
+TEST(Delivery, check_full_table_counts_untracked)
+{
+    digi_serial_t node = near_node;
+
+    for(uint8_t idx = 0; idx < 8; idx++)
+    {
+        node.serial[7] = idx;
+        CHECK(status(send(&node, 0), 0, 0, 0, 1) == DIGI_OK);
+    }
+
+    LONGS_EQUAL(2, digi_delivery_untracked(&delivery));
+    node.serial[7] = 7;
+    POINTERS_EQUAL(NULL, digi_delivery_link(&delivery, &node));
+    node.serial[7] = 5;
+    CHECK(digi_delivery_link(&delivery, &node) != NULL);
+}
+
+// Frame ids come from the pending table so they never clash with its other users
+TEST(Delivery, check_frame_ids_shared_with_other_pending_users)
+{
+    uint8_t other;
+    CHECK(digi_pending_add(&pending, NULL, NULL, &other) == DIGI_OK);
+
+    uint8_t id = send(&near_node, 0);
+    CHECK(id != other);
+
+    // The other user's transmit status goes to it and isn't counted against the destination
+    CHECK(status(other, 0, 0x21, 0, 1) == DIGI_OK);
+    CHECK(status(id, 0, 0, 0, 1) == DIGI_OK);
+
+    const digi_delivery_link_t * link = digi_delivery_link(&delivery, &near_node);
+    LONGS_EQUAL(1, link->delivered);
+    LONGS_EQUAL(0, link->failed);
+}
+
+// Latencies past the last bucket land in it
+TEST(Delivery, check_long_latency_lands_in_last_bucket)
+{
+    uint8_t id = send(&near_node, 0);
+    CHECK(status(id, 0, 0, 0, UINT32_MAX) == DIGI_OK);
+
+    const digi_delivery_link_t * link = digi_delivery_link(&delivery, &near_node);
+    LONGS_EQUAL(1, link->latency[DIGI_DELIVERY_LATENCY_BUCKETS - 1]);
+    LONGS_EQUAL(UINT32_MAX, digi_delivery_latency_percentile(link, 100));
+}
+
+// Lost transmit statuses don't use up the frame ids for good
+TEST(Delivery, check_lost_statuses_are_reclaimed)
+{
+    uint8_t frame_id;
+
+    for(uint16_t idx = 1; idx < DIGI_PENDING_SLOTS; idx++)
+    {
+        send(&near_node, 0);
+    }
+    LONGS_EQUAL(0, digi_delivery_generate(&delivery, message, sizeof(message), &near_node, 0, NULL, 0, 0, &frame_id));
+
+    digi_delivery_poll(&delivery, 100, 100);
+
+    LONGS_EQUAL(DIGI_PENDING_SLOTS - 1, digi_delivery_link(&delivery, &near_node)->failed);
+    send(&near_node, 100);
+}
@@ -0,0 +1,126 @@
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+
+extern "C" 
+{
+    #include "c_driver_digimesh_dispatch.h"
+}
+
+
+TEST_GROUP(Dispatch) 
+{
+    void setup()
+    {
+        digi_dispatch_init(&dispatch);
+        digi_parser_init(&parser);
+        at_responses = 0;
+        receive_packets = 0;
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_dispatch_t dispatch;
+    digi_parser_t parser;
+    int at_responses;
+    int receive_packets;
+
+    // Local AT command response to an ID query with frame id 1, status OK and value 0x7FFF
+    uint8_t id_response[11] = {0x7E, 0x00, 0x07, 0x88, 0x01, 'I', 'D', 0x00, 0x7F, 0xFF, 0x6B};
+
+    // Modem status frame reporting a hardware reset
+    uint8_t modem_status[6] = {0x7E, 0x00, 0x02, 0x8A, 0x00, 0x75};
+
+    // Counts the frames it is called with in the int pointed to by context
+    static void count_frame(void * context, const digi_frame_view_t * frame)
+    {
+        *(int *)context += 1;
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// Frames with no handler are counted and dropped
+TEST(Dispatch, check_unhandled_frames_are_counted)
+{
+    LONGS_EQUAL(1, digi_dispatch_receive(&dispatch, &parser, id_response, sizeof(id_response)));
+    LONGS_EQUAL(1, digi_dispatch_unhandled(&dispatch));
+}
+
+// A handler has to be given
+TEST(Dispatch, check_null_handler_is_refused)
+{
+    CHECK(digi_dispatch_register(&dispatch, DIGI_FRAME_RECEIVE_PACKET, NULL, NULL) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A frame goes to the handler registered for its type and no other
+TEST(Dispatch, check_frame_goes_to_its_handler)
+{
+    digi_dispatch_register(&dispatch, DIGI_FRAME_LOCAL_AT_RESPONSE, count_frame, &at_responses);
+    digi_dispatch_register(&dispatch, DIGI_FRAME_RECEIVE_PACKET, count_frame, &receive_packets);
+
+    digi_dispatch_receive(&dispatch, &parser, id_response, sizeof(id_response));
+
+    LONGS_EQUAL(1, at_responses);
+    LONGS_EQUAL(0, receive_packets);
+    LONGS_EQUAL(0, digi_dispatch_unhandled(&dispatch));
+}
+
+// An unregistered handler isn't called any more
+TEST(Dispatch, check_unregistered_handler_is_not_called)
+{
+    digi_dispatch_register(&dispatch, DIGI_FRAME_LOCAL_AT_RESPONSE, count_frame, &at_responses);
+    digi_dispatch_unregister(&dispatch, DIGI_FRAME_LOCAL_AT_RESPONSE);
+
+    digi_dispatch_receive(&dispatch, &parser, id_response, sizeof(id_response));
+
+    LONGS_EQUAL(0, at_responses);
+    LONGS_EQUAL(1, digi_dispatch_unhandled(&dispatch));
+}
+
+// A copy of the table counts its own unhandled frames, not the original's
+TEST(Dispatch, check_copied_table_counts_into_itself)
+{
+    digi_dispatch_t copy = dispatch;
+
+    digi_dispatch_receive(&copy, &parser, id_response, sizeof(id_response));
+
+    LONGS_EQUAL(1, digi_dispatch_unhandled(&copy));
+    LONGS_EQUAL(0, digi_dispatch_unhandled(&dispatch));
+}
+
+/********/
+/* Many */
+/********/
+
+// A stream of mixed frames is split between handled and unhandled types
+TEST(Dispatch, check_mixed_frames_are_routed)
+{
+    uint8_t stream[3 * sizeof(id_response) + 2 * sizeof(modem_status)];
+    size_t offset = 0;
+
+    for(int idx = 0; idx < 3; idx++)
+    {
+        memcpy(&stream[offset], id_response, sizeof(id_response));
+        offset += sizeof(id_response);
+        if(idx < 2)
+        {
+            memcpy(&stream[offset], modem_status, sizeof(modem_status));
+            offset += sizeof(modem_status);
+        }
+    }
+
+    digi_dispatch_register(&dispatch, DIGI_FRAME_LOCAL_AT_RESPONSE, count_frame, &at_responses);
+
+    LONGS_EQUAL(5, digi_dispatch_receive(&dispatch, &parser, stream, offset));
+    LONGS_EQUAL(3, at_responses);
+    LONGS_EQUAL(2, digi_dispatch_unhandled(&dispatch));
+}
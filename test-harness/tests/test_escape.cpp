@@ -0,0 +1,144 @@
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+
+extern "C" 
+{
+    #include "c_driver_digimesh_escape.h"
+    #include "c_driver_digimesh_parser.h"
+}
+
+
+TEST_GROUP(Escape) 
+{
+    void setup()
+    {
+        digi_unescaper_init(&unescaper);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_unescaper_t unescaper;
+
+    // Fill a buffer with a pattern that hits every byte value, including the ones that need escaping
+    void fill_pattern(uint8_t * bytes, size_t size)
+    {
+        bytes[0] = DIGI_START_DELIMITER;
+        for(size_t idx = 1; idx < size; idx++)
+        {
+            bytes[idx] = (uint8_t)(idx * 7);
+        }
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// Nothing in gives nothing out
+TEST(Escape, check_empty_input)
+{
+    uint8_t bytes[1] = {0};
+
+    LONGS_EQUAL(0, digi_escape(bytes, 0, bytes, sizeof(bytes)));
+    LONGS_EQUAL(0, digi_unescape(&unescaper, bytes, 0, bytes));
+}
+
+/*******/
+/* One */
+/*******/
+
+// The example frame from the digi documentation escapes its XON byte
+TEST(Escape, check_frame_is_escaped)
+{
+    uint8_t frame[] = {0x7E, 0x00, 0x02, 0x23, 0x11, 0xCB};
+    uint8_t expected[] = {0x7E, 0x00, 0x02, 0x23, 0x7D, 0x31, 0xCB};
+    uint8_t escaped[16];
+
+    LONGS_EQUAL(sizeof(expected), digi_escape(frame, sizeof(frame), escaped, sizeof(escaped)));
+    MEMCMP_EQUAL(expected, escaped, sizeof(expected));
+}
+
+// A frame that doesn't fit once escaped isn't written
+TEST(Escape, check_escape_into_small_buffer)
+{
+    uint8_t frame[] = {0x7E, 0x00, 0x02, 0x23, 0x11, 0xCB};
+    uint8_t escaped[6];
+
+    LONGS_EQUAL(0, digi_escape(frame, sizeof(frame), escaped, sizeof(escaped)));
+}
+
+// An escape split across two chunks is applied to the first byte of the second
+TEST(Escape, check_unescape_across_chunks)
+{
+    uint8_t first[] = {0x7E, 0x00, 0x02, 0x23, 0x7D};
+    uint8_t second[] = {0x31, 0xCB};
+    uint8_t output[8];
+
+    LONGS_EQUAL(4, digi_unescape(&unescaper, first, sizeof(first), output));
+    LONGS_EQUAL(2, digi_unescape(&unescaper, second, sizeof(second), &output[4]));
+    BYTES_EQUAL(0x11, output[4]);
+    BYTES_EQUAL(0xCB, output[5]);
+}
+
+// A start delimiter after an escape is kept so the parser can resynchronize
+TEST(Escape, check_start_delimiter_is_never_unescaped)
+{
+    uint8_t bytes[] = {0x23, 0x7D, 0x7E, 0x00};
+
+    LONGS_EQUAL(3, digi_unescape(&unescaper, bytes, sizeof(bytes), bytes));
+    BYTES_EQUAL(0x7E, bytes[1]);
+}
+
+/********/
+/* Many */
+/********/
+
+// Every frame of a batch keeps its start delimiter, and a 0x7E inside a frame is still escaped
+TEST(Escape, check_batch_is_escaped_frame_by_frame)
+{
+    uint8_t frames[] = {0x7E, 0x00, 0x02, 0x23, 0x11, 0xCB, 0x7E, 0x00, 0x02, 0x7E, 0x23, 0x5E};
+    uint8_t expected[] = {0x7E, 0x00, 0x02, 0x23, 0x7D, 0x31, 0xCB, 0x7E, 0x00, 0x02, 0x7D, 0x5E, 0x23, 0x5E};
+    uint8_t escaped[32];
+
+    LONGS_EQUAL(sizeof(expected), digi_escape(frames, sizeof(frames), escaped, sizeof(escaped)));
+    MEMCMP_EQUAL(expected, escaped, sizeof(expected));
+
+    LONGS_EQUAL(0, digi_escape(frames, sizeof(frames), escaped, sizeof(expected) - 1));
+}
+
+// Long runs of every byte value survive escaping and unescaping in place, in any chunking
+TEST(Escape, check_round_trip)
+{
+    uint8_t frame[300];
+    uint8_t escaped[600];
+    fill_pattern(frame, sizeof(frame));
+
+    size_t size = digi_escape(frame, sizeof(frame), escaped, sizeof(escaped));
+    CHECK(size > sizeof(frame));
+    for(size_t idx = 1; idx < size; idx++)
+    {
+        CHECK(escaped[idx] != 0x7E && escaped[idx] != 0x11 && escaped[idx] != 0x13);
+    }
+
+    for(size_t chunk = 1; chunk < 20; chunk++)
+    {
+        uint8_t copy[600];
+        size_t in = 0;
+        size_t out = 0;
+
+        memcpy(copy, escaped, size);
+        digi_unescaper_init(&unescaper);
+        while(in < size)
+        {
+            size_t length = (size - in < chunk) ? size - in : chunk;
+            out += digi_unescape(&unescaper, &copy[in], length, &copy[out]);
+            in += length;
+        }
+
+        LONGS_EQUAL(sizeof(frame), out);
+        MEMCMP_EQUAL(frame, copy, sizeof(frame));
+    }
+}
@@ -0,0 +1,293 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_fragment.h"
+}
+
+
+TEST_GROUP(Fragment) 
+{
+    void setup()
+    {
+        CHECK(digi_reassembly_init(&reassembly, slots, SLOTS, buffers, BUFFER_SIZE, 100, on_message, this) == DIGI_OK);
+        messages = 0;
+        received_length = 0;
+        digi_parser_init(&parser);
+
+        for(size_t idx = 0; idx < sizeof(original); idx++)
+        {
+            original[idx] = (uint8_t)(idx * 7 + 3);
+        }
+    }
+
+    void teardown()
+    {
+    }
+
+    static const uint32_t SLOTS = 2;
+    static const size_t BUFFER_SIZE = 1024;
+    static const uint16_t NP = 73;
+
+    digi_reassembly_t reassembly;
+    digi_reassembly_slot_t slots[SLOTS];
+    uint8_t buffers[SLOTS * BUFFER_SIZE];
+    digi_parser_t parser;
+
+    int messages;
+    uint8_t received[BUFFER_SIZE];
+    size_t received_length;
+    digi_serial_t received_source;
+
+    uint8_t original[1000];
+    uint8_t message[MAXIMUM_MESSAGE_SIZE];
+
+    digi_serial_t sender = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x11}};
+    digi_serial_t other_sender = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x22}};
+
+    static void on_message(void * context, const digi_serial_t * source, const uint8_t * data, size_t length)
+    {
+        TEST_GROUP_Fragment * self = (TEST_GROUP_Fragment *)context;
+
+        self->messages++;
+        self->received_source = *source;
+        memcpy(self->received, data, length);
+        self->received_length = length;
+    }
+
+    // Build one fragment, send it through the parser and hand it to the reassembler as if from source
+    digi_status_t deliver(const digi_serial_t * source, uint8_t message_id, size_t length, uint8_t index, uint32_t now)
+    {
+        size_t size = digi_generate_fragment(message, sizeof(message), 0, &sender, 0, message_id, original, length, NP, index);
+        size_t consumed = 0;
+        digi_frame_view_t frame;
+
+        CHECK(size > 0);
+        CHECK(digi_parser_feed(&parser, message, size, &consumed, &frame) == DIGI_PARSE_FRAME);
+
+        // The receiving end sees the transmit request's payload in a receive packet
+        digi_receive_packet_t packet = {*source, 0, &frame.data[13], (uint16_t)(frame.length - 13)};
+        return digi_reassembly_receive(&reassembly, &packet, now);
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// A payload limit too small for the header can't carry anything
+TEST(Fragment, check_tiny_payload_limit_is_refused)
+{
+    LONGS_EQUAL(0, digi_fragment_count(10, DIGI_FRAGMENT_HEADER_SIZE));
+    LONGS_EQUAL(0, digi_generate_fragment(message, sizeof(message), 0, &sender, 0, 1, original, 10, DIGI_FRAGMENT_HEADER_SIZE, 0));
+}
+
+// A reassembler needs at least one slot
+TEST(Fragment, check_no_slots_is_refused)
+{
+    CHECK(digi_reassembly_init(&reassembly, slots, 0, buffers, BUFFER_SIZE, 100, on_message, this) == DIGI_ERROR);
+}
+
+// An empty message is one empty fragment
+TEST(Fragment, check_empty_message_round_trips)
+{
+    LONGS_EQUAL(1, digi_fragment_count(0, NP));
+    CHECK(deliver(&sender, 1, 0, 0, 0) == DIGI_OK);
+
+    LONGS_EQUAL(1, messages);
+    LONGS_EQUAL(0, received_length);
+}
+
+// Fragments too short to hold a header are dropped
+TEST(Fragment, check_short_fragment_is_dropped)
+{
+    uint8_t payload[] = {1, 0};
+    digi_receive_packet_t packet = {sender, 0, payload, sizeof(payload)};
+
+    CHECK(digi_reassembly_receive(&reassembly, &packet, 0) == DIGI_ERROR);
+    LONGS_EQUAL(1, digi_reassembly_dropped(&reassembly));
+}
+
+/*******/
+/* One */
+/*******/
+
+// A message that fits in one fragment is handed over straight away
+TEST(Fragment, check_single_fragment_message)
+{
+    LONGS_EQUAL(1, digi_fragment_count(NP - DIGI_FRAGMENT_HEADER_SIZE, NP));
+    CHECK(deliver(&sender, 1, NP - DIGI_FRAGMENT_HEADER_SIZE, 0, 0) == DIGI_OK);
+
+    LONGS_EQUAL(1, messages);
+    LONGS_EQUAL(NP - DIGI_FRAGMENT_HEADER_SIZE, received_length);
+    MEMCMP_EQUAL(original, received, received_length);
+    MEMCMP_EQUAL(sender.serial, received_source.serial, DIGI_SERIAL_LENGTH);
+}
+
+// Fragments that disagree with the header are dropped
+TEST(Fragment, check_inconsistent_fragments_are_dropped)
+{
+    uint8_t index_past_count[] = {1, 3, 3, 4, 0, 0, 0, 0};
+    uint8_t short_middle[] = {1, 0, 3, 4, 0, 0};
+    uint8_t long_last[] = {1, 2, 3, 4, 0, 0, 0, 0, 0};
+    digi_receive_packet_t packet = {sender, 0, index_past_count, sizeof(index_past_count)};
+
+    CHECK(digi_reassembly_receive(&reassembly, &packet, 0) == DIGI_ERROR);
+    packet.payload = short_middle;
+    packet.length = sizeof(short_middle);
+    CHECK(digi_reassembly_receive(&reassembly, &packet, 0) == DIGI_ERROR);
+    packet.payload = long_last;
+    packet.length = sizeof(long_last);
+    CHECK(digi_reassembly_receive(&reassembly, &packet, 0) == DIGI_ERROR);
+
+    LONGS_EQUAL(3, digi_reassembly_dropped(&reassembly));
+    LONGS_EQUAL(0, messages);
+}
+
+// A message longer than the buffers is dropped
+TEST(Fragment, check_message_longer_than_buffer_is_dropped)
+{
+    uint8_t payload[4 + 255] = {1, 5, 6, 255};
+    digi_receive_packet_t packet = {sender, 0, payload, sizeof(payload)};
+
+    CHECK(digi_reassembly_receive(&reassembly, &packet, 0) == DIGI_ERROR);
+    LONGS_EQUAL(1, digi_reassembly_dropped(&reassembly));
+}
+
+// A message missing a fragment times out
+TEST(Fragment, check_missing_fragment_times_out)
+{
+    CHECK(deliver(&sender, 1, 200, 0, 10) == DIGI_OK);
+    CHECK(deliver(&sender, 1, 200, 2, 20) == DIGI_OK);
+
+    digi_reassembly_poll(&reassembly, 109);
+    LONGS_EQUAL(0, digi_reassembly_failures(&reassembly));
+
+    digi_reassembly_poll(&reassembly, 110);
+    LONGS_EQUAL(1, digi_reassembly_failures(&reassembly));
+
+    // The late fragment starts a new message that never completes
+    CHECK(deliver(&sender, 1, 200, 1, 111) == DIGI_OK);
+    LONGS_EQUAL(0, messages);
+}
+
+// A single fragment message repeated by the sender is handed over once until the timeout passes
+TEST(Fragment, check_single_fragment_repeat_is_ignored)
+{
+    CHECK(deliver(&sender, 1, 10, 0, 0) == DIGI_OK);
+    CHECK(deliver(&sender, 1, 10, 0, 50) == DIGI_OK);
+    LONGS_EQUAL(1, messages);
+
+    digi_reassembly_poll(&reassembly, 100);
+    LONGS_EQUAL(0, digi_reassembly_failures(&reassembly));
+
+    CHECK(deliver(&sender, 1, 10, 0, 101) == DIGI_OK);
+    LONGS_EQUAL(2, messages);
+}
+
+// A single fragment message doesn't push out messages still arriving to be remembered
+TEST(Fragment, check_single_fragment_does_not_evict)
+{
+    CHECK(deliver(&sender, 1, 200, 0, 0) == DIGI_OK);
+    CHECK(deliver(&sender, 2, 200, 0, 0) == DIGI_OK);
+    CHECK(deliver(&sender, 3, 10, 0, 1) == DIGI_OK);
+
+    LONGS_EQUAL(1, messages);
+    LONGS_EQUAL(0, digi_reassembly_failures(&reassembly));
+}
+
+// A fragment repeated after its message was handed over is ignored rather than starting a new message
+TEST(Fragment, check_late_repeat_after_completion_is_ignored)
+{
+    for(uint8_t index = 0; index < 3; index++)
+    {
+        CHECK(deliver(&sender, 1, 200, index, 10) == DIGI_OK);
+    }
+    LONGS_EQUAL(1, messages);
+
+    CHECK(deliver(&sender, 1, 200, 1, 50) == DIGI_OK);
+    LONGS_EQUAL(1, messages);
+
+    digi_reassembly_poll(&reassembly, 110);
+    LONGS_EQUAL(1, digi_reassembly_completed(&reassembly));
+    LONGS_EQUAL(0, digi_reassembly_failures(&reassembly));
+    LONGS_EQUAL(0, digi_reassembly_dropped(&reassembly));
+}
+
+/********/
+/* Many */
+/********/
+
+// A long message arrives in full whatever order its fragments come in, repeats included
+TEST(Fragment, check_long_message_in_any_order)
+{
+    uint8_t count = digi_fragment_count(sizeof(original), NP);
+
+    LONGS_EQUAL(15, count);
+    for(uint8_t step = 0; step < count; step++)
+    {
+        uint8_t index = (uint8_t)((step * 7) % count);
+        CHECK(deliver(&sender, 9, sizeof(original), index, step) == DIGI_OK);
+        CHECK(deliver(&sender, 9, sizeof(original), index, step) == DIGI_OK);
+    }
+
+    LONGS_EQUAL(1, messages);
+    LONGS_EQUAL(sizeof(original), received_length);
+    MEMCMP_EQUAL(original, received, sizeof(original));
+    LONGS_EQUAL(1, digi_reassembly_completed(&reassembly));
+    LONGS_EQUAL(0, digi_reassembly_dropped(&reassembly));
+}
+
+// Messages from different senders are kept apart
+TEST(Fragment, check_senders_interleave)
+{
+    uint8_t count = digi_fragment_count(300, NP);
+
+    for(uint8_t index = 0; index < count; index++)
+    {
+        CHECK(deliver(&sender, 1, 300, index, 0) == DIGI_OK);
+        if(index + 1 < count)
+        {
+            CHECK(deliver(&other_sender, 1, 300, index, 0) == DIGI_OK);
+        }
+    }
+
+    LONGS_EQUAL(1, messages);
+    MEMCMP_EQUAL(sender.serial, received_source.serial, DIGI_SERIAL_LENGTH);
+
+    CHECK(deliver(&other_sender, 1, 300, (uint8_t)(count - 1), 0) == DIGI_OK);
+    LONGS_EQUAL(2, messages);
+    MEMCMP_EQUAL(other_sender.serial, received_source.serial, DIGI_SERIAL_LENGTH);
+    MEMCMP_EQUAL(original, received, 300);
+}
+
+// With every slot busy the oldest message makes way for a new one
+TEST(Fragment, check_oldest_message_is_evicted)
+{
+    CHECK(deliver(&sender, 1, 200, 0, 0) == DIGI_OK);
+    CHECK(deliver(&sender, 2, 200, 0, 5) == DIGI_OK);
+    CHECK(deliver(&sender, 3, 200, 0, 10) == DIGI_OK);
+
+    LONGS_EQUAL(1, digi_reassembly_failures(&reassembly));
+
+    CHECK(deliver(&sender, 2, 200, 1, 11) == DIGI_OK);
+    CHECK(deliver(&sender, 2, 200, 2, 12) == DIGI_OK);
+    LONGS_EQUAL(1, messages);
+}
+
+// A message already handed over makes way before a message still arriving
+TEST(Fragment, check_completed_message_makes_way_first)
+{
+    for(uint8_t index = 0; index < 3; index++)
+    {
+        CHECK(deliver(&sender, 1, 200, index, 0) == DIGI_OK);
+    }
+    CHECK(deliver(&sender, 2, 200, 0, 5) == DIGI_OK);
+    CHECK(deliver(&sender, 3, 200, 0, 10) == DIGI_OK);
+
+    LONGS_EQUAL(0, digi_reassembly_failures(&reassembly));
+
+    CHECK(deliver(&sender, 2, 200, 1, 11) == DIGI_OK);
+    CHECK(deliver(&sender, 2, 200, 2, 12) == DIGI_OK);
+    LONGS_EQUAL(2, messages);
+}
@@ -0,0 +1,252 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_identify.h"
+}
+
+
+TEST_GROUP(Identify) 
+{
+    void setup()
+    {
+        digi = digi_init(&storage);
+        digi_pending_init(&pending);
+        digi_cache_init(&cache);
+        digi_parser_init(&parser);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_context_storage_t storage;
+    digi_t * digi;
+    digi_pending_t pending;
+    digi_cache_t cache;
+    digi_parser_t parser;
+    digi_identify_t identify;
+    uint8_t message[DIGI_IDENTIFY_MESSAGE_SIZE];
+    uint8_t frame_ids[DIGI_IDENTIFY_FIELDS];
+    char codes[DIGI_IDENTIFY_FIELDS][2];
+
+    // Start identifying and note the frame id and field of every query sent
+    void start()
+    {
+        size_t size = digi_identify_start(&identify, digi, &pending, &cache, message, sizeof(message));
+        size_t offset = 0;
+        int queries = 0;
+
+        CHECK(size > 0);
+        while(offset < size)
+        {
+            size_t consumed = 0;
+            digi_frame_view_t frame;
+
+            CHECK(digi_parser_feed(&parser, &message[offset], size - offset, &consumed, &frame) == DIGI_PARSE_FRAME);
+            BYTES_EQUAL(DIGI_FRAME_LOCAL_AT, frame.type);
+            frame_ids[queries] = frame.data[0];
+            codes[queries][0] = (char)frame.data[1];
+            codes[queries][1] = (char)frame.data[2];
+            offset += consumed;
+            queries++;
+        }
+        LONGS_EQUAL(DIGI_IDENTIFY_FIELDS, queries);
+    }
+
+    // Answer the query for a field the way the digi module would
+    void respond(char first, char second, uint8_t status, const uint8_t * value, uint16_t length)
+    {
+        uint8_t data[4 + DIGI_IDENTIFY_NODE_IDENTIFIER_SIZE];
+        int query = 0;
+
+        while(codes[query][0] != first || codes[query][1] != second)
+        {
+            query++;
+        }
+
+        data[0] = frame_ids[query];
+        data[1] = (uint8_t)first;
+        data[2] = (uint8_t)second;
+        data[3] = status;
+        if(length > 0)
+        {
+            memcpy(&data[4], value, length);
+        }
+
+        digi_frame_view_t frame = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, (uint16_t)(4 + length)};
+        CHECK(digi_pending_complete(&pending, &frame) == DIGI_OK);
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// Nothing is sent or reserved when the queries don't fit
+TEST(Identify, check_nothing_started_into_small_buffer)
+{
+    LONGS_EQUAL(0, digi_identify_start(&identify, digi, &pending, &cache, message, sizeof(message) - 1));
+    LONGS_EQUAL(0, digi_pending_count(&pending));
+}
+
+// Nothing is sent or reserved when there aren't enough frame ids
+TEST(Identify, check_nothing_started_without_frame_ids)
+{
+    uint8_t frame_id;
+
+    for(int idx = 0; idx < DIGI_PENDING_SLOTS - 1 - (DIGI_IDENTIFY_FIELDS - 1); idx++)
+    {
+        digi_pending_add(&pending, NULL, NULL, &frame_id);
+    }
+
+    LONGS_EQUAL(0, digi_identify_start(&identify, digi, &pending, &cache, message, sizeof(message)));
+    LONGS_EQUAL(DIGI_PENDING_SLOTS - 1 - (DIGI_IDENTIFY_FIELDS - 1), digi_pending_count(&pending));
+}
+
+/*******/
+/* One */
+/*******/
+
+// Every query is sent at once with its own frame id
+TEST(Identify, check_queries_are_pipelined)
+{
+    start();
+
+    LONGS_EQUAL(DIGI_IDENTIFY_FIELDS, digi_pending_count(&pending));
+    for(int query = 0; query < DIGI_IDENTIFY_FIELDS; query++)
+    {
+        CHECK(frame_ids[query] != 0);
+        for(int other = 0; other < query; other++)
+        {
+            CHECK(frame_ids[query] != frame_ids[other]);
+        }
+    }
+    CHECK(!digi_identify_done(&identify));
+    CHECK(!digi_is_initialized(digi));
+}
+
+// The digi module is initialized only once both halves of the serial are back
+TEST(Identify, check_initialized_once_serial_lands)
+{
+    uint8_t high[] = {0x00, 0x13, 0xA2, 0x00};
+    uint8_t low[] = {0x41, 0x52, 0x7E, 0x11};
+    uint8_t expected[] = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x11};
+    digi_serial_t serial;
+
+    start();
+
+    respond('S', 'L', 0, low, sizeof(low));
+    CHECK(!digi_is_initialized(digi));
+
+    respond('S', 'H', 0, high, sizeof(high));
+    CHECK(digi_is_initialized(digi));
+    digi_get_serial(digi, &serial);
+    MEMCMP_EQUAL(expected, serial.serial, DIGI_SERIAL_LENGTH);
+    CHECK(!digi_identify_done(&identify));
+}
+
+// A failed serial query leaves the digi module uninitialized
+TEST(Identify, check_failed_serial_query_is_reported)
+{
+    uint8_t low[] = {0x41, 0x52, 0x7E, 0x11};
+
+    start();
+
+    respond('S', 'H', 1, NULL, 0);
+    respond('S', 'L', 0, low, sizeof(low));
+
+    CHECK(!digi_is_initialized(digi));
+    CHECK(digi_identify_failed(&identify));
+}
+
+// A response that doesn't decode fails its query rather than leaving it outstanding
+TEST(Identify, check_malformed_response_fails_query)
+{
+    start();
+
+    uint8_t data[2] = {frame_ids[2], 'N'};
+    digi_frame_view_t frame = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+    CHECK(digi_pending_complete(&pending, &frame) == DIGI_OK);
+    CHECK(digi_identify_failed(&identify));
+
+    for(int query = 0; query < DIGI_IDENTIFY_FIELDS; query++)
+    {
+        if(query != 2)
+        {
+            uint8_t value[4] = {0};
+            respond(codes[query][0], codes[query][1], 0, value, sizeof(value));
+        }
+    }
+    CHECK(digi_identify_done(&identify));
+}
+
+// Cancelling gives back the frame ids still waiting and ends the identification
+TEST(Identify, check_cancel_frees_outstanding_frame_ids)
+{
+    uint8_t serial_high[4] = {0x00, 0x13, 0xA2, 0x00};
+
+    start();
+    respond('S', 'H', 0, serial_high, sizeof(serial_high));
+    digi_identify_cancel(&identify);
+
+    CHECK(digi_identify_done(&identify));
+    CHECK(digi_identify_failed(&identify));
+    for(int query = 0; query < DIGI_IDENTIFY_FIELDS; query++)
+    {
+        CHECK_FALSE(digi_pending_is_active(&pending, frame_ids[query]));
+    }
+    CHECK_FALSE(digi_is_initialized(digi));
+}
+
+/********/
+/* Many */
+/********/
+
+// Responses in any order fill the context, the cache and the node identifier
+TEST(Identify, check_responses_in_any_order_fill_context)
+{
+    uint8_t high[] = {0x13, 0xA2, 0x00};
+    uint8_t low[] = {0x41, 0x52, 0x7E, 0x11};
+    uint8_t network[] = {0x7F, 0xFF};
+    uint8_t channel[] = {0x0C};
+    uint8_t payload[] = {0x01, 0x00};
+    uint8_t firmware[] = {0x00, 0x00, 0x90, 0x02};
+    uint8_t hardware[] = {0x22, 0x47};
+    uint8_t name[] = {'G', 'A', 'T', 'E'};
+    uint8_t expected[] = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x11};
+    digi_serial_t serial;
+    uint32_t value = 0;
+
+    start();
+
+    respond('V', 'R', 0, firmware, sizeof(firmware));
+    respond('N', 'I', 0, name, sizeof(name));
+    respond('S', 'L', 0, low, sizeof(low));
+    respond('C', 'H', 0, channel, sizeof(channel));
+    respond('H', 'V', 0, hardware, sizeof(hardware));
+    respond('S', 'H', 0, high, sizeof(high));
+    respond('N', 'P', 0, payload, sizeof(payload));
+    CHECK(!digi_identify_done(&identify));
+    respond('I', 'D', 0, network, sizeof(network));
+
+    CHECK(digi_identify_done(&identify));
+    CHECK(!digi_identify_failed(&identify));
+    LONGS_EQUAL(0, digi_pending_count(&pending));
+
+    digi_get_serial(digi, &serial);
+    MEMCMP_EQUAL(expected, serial.serial, DIGI_SERIAL_LENGTH);
+    STRCMP_EQUAL("GATE", digi_identify_node_identifier(&identify));
+
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_ID, &value) == DIGI_OK);
+    LONGS_EQUAL(0x7FFF, value);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_CH, &value) == DIGI_OK);
+    LONGS_EQUAL(0x0C, value);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_NP, &value) == DIGI_OK);
+    LONGS_EQUAL(0x100, value);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_VR, &value) == DIGI_OK);
+    LONGS_EQUAL(0x9002, value);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_HV, &value) == DIGI_OK);
+    LONGS_EQUAL(0x2247, value);
+    CHECK(digi_cache_get(&cache, DIGI_FIELD_NI, &value) == DIGI_ERROR);
+}
@@ -0,0 +1,122 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_nodes.h"
+}
+
+
+TEST_GROUP(Nodes) 
+{
+    void setup()
+    {
+        digi_nodes_init(&table, storage, 64);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_node_table_t table;
+    digi_node_t storage[64];
+
+    digi_serial_t serial = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x11}};
+
+    // Keys that only differ in their low bits, like serials from one batch of modules
+    uint64_t batch_key(uint32_t idx)
+    {
+        return 0x0013A20041000000ull + idx;
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// A new table has no nodes
+TEST(Nodes, check_table_is_empty_on_init)
+{
+    LONGS_EQUAL(0, digi_nodes_count(&table));
+    CHECK(digi_nodes_find(&table, digi_serial_to_key(&serial)) == NULL);
+    CHECK(digi_nodes_evict(&table, digi_serial_to_key(&serial)) == DIGI_ERROR);
+}
+
+// Only power of two capacities are accepted
+TEST(Nodes, check_table_rejects_odd_capacity)
+{
+    CHECK(digi_nodes_init(&table, storage, 48) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// Serial numbers pack most significant byte first and unpack again
+TEST(Nodes, check_serial_packs_into_key)
+{
+    digi_serial_t unpacked;
+    uint64_t key = digi_serial_to_key(&serial);
+
+    CHECK(key == 0x0013A20041527E11ull);
+    digi_key_to_serial(key, &unpacked);
+    MEMCMP_EQUAL(serial.serial, unpacked.serial, DIGI_SERIAL_LENGTH);
+}
+
+// An inserted node can be found and keeps what's stored in it
+TEST(Nodes, check_inserted_node_is_found)
+{
+    uint64_t key = digi_serial_to_key(&serial);
+    digi_node_t * node = digi_nodes_insert(&table, key);
+
+    CHECK(node != NULL);
+    node->link_quality = 40;
+    node->sleep = DIGI_NODE_AWAKE;
+
+    POINTERS_EQUAL(node, digi_nodes_find(&table, key));
+    POINTERS_EQUAL(node, digi_nodes_insert(&table, key));
+    BYTES_EQUAL(40, digi_nodes_find(&table, key)->link_quality);
+    LONGS_EQUAL(1, digi_nodes_count(&table));
+}
+
+/********/
+/* Many */
+/********/
+
+// Inserts stop at the load limit
+TEST(Nodes, check_full_table_refuses_new_nodes)
+{
+    for(uint32_t idx = 0; idx < 48; idx++)
+    {
+        CHECK(digi_nodes_insert(&table, batch_key(idx)) != NULL);
+    }
+
+    CHECK(digi_nodes_insert(&table, batch_key(48)) == NULL);
+    CHECK(digi_nodes_insert(&table, batch_key(0)) != NULL);
+    LONGS_EQUAL(48, digi_nodes_count(&table));
+}
+
+// Evicting nodes in any order leaves every other node findable
+TEST(Nodes, check_evict_keeps_others_findable)
+{
+    for(uint32_t idx = 0; idx < 48; idx++)
+    {
+        digi_nodes_insert(&table, batch_key(idx))->last_seen = idx;
+    }
+
+    for(uint32_t evicted = 0; evicted < 48; evicted++)
+    {
+        uint32_t victim = (evicted * 29) % 48;
+        CHECK(digi_nodes_evict(&table, batch_key(victim)) == DIGI_OK);
+        CHECK(digi_nodes_find(&table, batch_key(victim)) == NULL);
+
+        for(uint32_t idx = evicted + 1; idx < 48; idx++)
+        {
+            uint32_t remaining = (idx * 29) % 48;
+            digi_node_t * node = digi_nodes_find(&table, batch_key(remaining));
+            CHECK(node != NULL);
+            LONGS_EQUAL(remaining, node->last_seen);
+        }
+    }
+
+    LONGS_EQUAL(0, digi_nodes_count(&table));
+}
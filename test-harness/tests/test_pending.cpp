@@ -0,0 +1,139 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_pending.h"
+}
+
+
+TEST_GROUP(Pending) 
+{
+    void setup()
+    {
+        digi_pending_init(&pending);
+        calls = 0;
+        last_id = 0;
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_pending_t pending;
+
+    static int calls;
+    static uint8_t last_id;
+
+    static void on_response(void * context, const digi_frame_view_t * frame)
+    {
+        calls++;
+        last_id = frame->data[0];
+        *(int *)context += 1;
+    }
+
+    // Make a response frame carrying a frame id
+    digi_frame_view_t response(uint8_t type, const uint8_t * data)
+    {
+        digi_frame_view_t frame = {type, data, 4};
+        return frame;
+    }
+};
+
+int TEST_GROUP_Pending::calls;
+uint8_t TEST_GROUP_Pending::last_id;
+
+/********/
+/* Zero */
+/********/
+
+// Nothing is pending after initialization
+TEST(Pending, check_nothing_pending_on_init)
+{
+    uint8_t data[4] = {1, 'I', 'D', 0};
+    digi_frame_view_t frame = response(DIGI_FRAME_LOCAL_AT_RESPONSE, data);
+
+    LONGS_EQUAL(0, digi_pending_count(&pending));
+    CHECK(digi_pending_complete(&pending, &frame) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A response completes the request with the same frame id
+TEST(Pending, check_response_completes_request)
+{
+    int context = 0;
+    uint8_t id = 0;
+
+    CHECK(digi_pending_add(&pending, on_response, &context, &id) == DIGI_OK);
+    CHECK(id != 0);
+    CHECK(digi_pending_is_active(&pending, id));
+
+    uint8_t data[4] = {id, 0x00, 0x00, 0x00};
+    digi_frame_view_t frame = response(DIGI_FRAME_TRANSMIT_STATUS, data);
+
+    CHECK(digi_pending_complete(&pending, &frame) == DIGI_OK);
+    LONGS_EQUAL(1, calls);
+    LONGS_EQUAL(1, context);
+    BYTES_EQUAL(id, last_id);
+    CHECK(!digi_pending_is_active(&pending, id));
+
+    // A second response with the same id is ignored
+    CHECK(digi_pending_complete(&pending, &frame) == DIGI_ERROR);
+    LONGS_EQUAL(1, calls);
+}
+
+// Frames that aren't responses complete nothing
+TEST(Pending, check_other_frames_are_ignored)
+{
+    uint8_t id = 0;
+
+    digi_pending_add(&pending, on_response, &calls, &id);
+
+    uint8_t data[4] = {id, 0x00, 0x00, 0x00};
+    digi_frame_view_t frame = response(DIGI_FRAME_RECEIVE_PACKET, data);
+
+    CHECK(digi_pending_complete(&pending, &frame) == DIGI_ERROR);
+    LONGS_EQUAL(0, calls);
+}
+
+// A cancelled request frees its frame id without a callback
+TEST(Pending, check_cancel_frees_id)
+{
+    uint8_t id = 0;
+
+    digi_pending_add(&pending, on_response, &calls, &id);
+    CHECK(digi_pending_cancel(&pending, id) == DIGI_OK);
+    LONGS_EQUAL(0, digi_pending_count(&pending));
+    CHECK(digi_pending_cancel(&pending, id) == DIGI_ERROR);
+}
+
+/********/
+/* Many */
+/********/
+
+// Every non zero id can be in flight at once and ids are reused least recently used first
+TEST(Pending, check_all_ids_can_be_pending)
+{
+    uint8_t id = 0;
+    uint8_t first = 0;
+
+    for(int idx = 0; idx < 255; idx++)
+    {
+        CHECK(digi_pending_add(&pending, NULL, NULL, &id) == DIGI_OK);
+        CHECK(id != 0);
+        if(idx == 0)
+        {
+            first = id;
+        }
+    }
+    LONGS_EQUAL(255, digi_pending_count(&pending));
+    CHECK(digi_pending_add(&pending, NULL, NULL, &id) == DIGI_ERROR);
+
+    digi_pending_cancel(&pending, 200);
+    digi_pending_cancel(&pending, first);
+
+    CHECK(digi_pending_add(&pending, NULL, NULL, &id) == DIGI_OK);
+    BYTES_EQUAL(200, id);
+}
@@ -0,0 +1,189 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_pool.h"
+}
+
+
+TEST_GROUP(Pool) 
+{
+    void setup()
+    {
+        digi_pool_init(&pool, blocks, BLOCKS, DIGI_POOL_BLOCK_SIZE);
+        memset(&cache, 0, sizeof(cache));
+    }
+
+    void teardown()
+    {
+    }
+
+    static const uint32_t BLOCKS = 4 * DIGI_POOL_CACHE_BATCH;
+
+    digi_pool_t pool;
+    digi_pool_block_t blocks[BLOCKS];
+    digi_pool_cache_t cache;
+};
+
+/********/
+/* Zero */
+/********/
+
+// A pool needs at least one block
+TEST(Pool, check_empty_storage_is_refused)
+{
+    CHECK(digi_pool_init(&pool, blocks, 0, DIGI_POOL_BLOCK_SIZE) == DIGI_ERROR);
+}
+
+// Storage laid out with a different block size is refused
+TEST(Pool, check_other_block_size_is_refused)
+{
+    CHECK(digi_pool_init(&pool, blocks, BLOCKS, DIGI_POOL_BLOCK_SIZE + 1) == DIGI_ERROR);
+}
+
+// Nothing is in use after initialization
+TEST(Pool, check_nothing_used_on_init)
+{
+    LONGS_EQUAL(0, digi_pool_used(&pool));
+    LONGS_EQUAL(0, digi_pool_high_water(&pool));
+    LONGS_EQUAL(0, digi_pool_failures(&pool));
+}
+
+// Pointers from elsewhere aren't taken back
+TEST(Pool, check_foreign_pointer_is_refused)
+{
+    uint8_t other[DIGI_POOL_BLOCK_SIZE] = {0};
+
+    CHECK(digi_pool_free(&pool, other) == DIGI_ERROR);
+    CHECK(digi_pool_cache_free(&cache, &pool, other) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A block is big enough for the largest frame and comes back when freed
+TEST(Pool, check_block_round_trips)
+{
+    uint8_t * block = digi_pool_alloc(&pool);
+
+    CHECK(block != NULL);
+    CHECK(DIGI_POOL_BLOCK_SIZE >= MAXIMUM_MESSAGE_SIZE + 4);
+    memset(block, 0xAA, DIGI_POOL_BLOCK_SIZE);
+    LONGS_EQUAL(1, digi_pool_used(&pool));
+
+    CHECK(digi_pool_free(&pool, block) == DIGI_OK);
+    LONGS_EQUAL(0, digi_pool_used(&pool));
+    LONGS_EQUAL(1, digi_pool_high_water(&pool));
+}
+
+// A pointer part way into a block frees the block
+TEST(Pool, check_interior_pointer_frees_block)
+{
+    uint8_t * block = digi_pool_alloc(&pool);
+
+    CHECK(digi_pool_free(&pool, block + 10) == DIGI_OK);
+    LONGS_EQUAL(0, digi_pool_used(&pool));
+    POINTERS_EQUAL(block, digi_pool_alloc(&pool));
+}
+
+// A block given back twice is refused and the free list stays intact
+TEST(Pool, check_double_free_is_refused)
+{
+    uint8_t * first = digi_pool_alloc(&pool);
+    uint8_t * second = digi_pool_alloc(&pool);
+
+    CHECK(digi_pool_free(&pool, first) == DIGI_OK);
+    CHECK(digi_pool_free(&pool, first + 1) == DIGI_ERROR);
+    LONGS_EQUAL(1, digi_pool_used(&pool));
+
+    CHECK(digi_pool_free(&pool, second) == DIGI_OK);
+    CHECK(digi_pool_free(&pool, second) == DIGI_ERROR);
+    LONGS_EQUAL(0, digi_pool_used(&pool));
+
+    uint8_t * again = digi_pool_alloc(&pool);
+    CHECK(again != digi_pool_alloc(&pool));
+}
+
+// A block given back to a cache twice is refused
+TEST(Pool, check_double_free_through_cache_is_refused)
+{
+    uint8_t * block = digi_pool_cache_alloc(&cache, &pool);
+
+    CHECK(digi_pool_cache_free(&cache, &pool, block) == DIGI_OK);
+    CHECK(digi_pool_cache_free(&cache, &pool, block) == DIGI_ERROR);
+    LONGS_EQUAL(DIGI_POOL_CACHE_BATCH, cache.count);
+}
+
+/********/
+/* Many */
+/********/
+
+// Every block can be handed out once and then allocation fails
+TEST(Pool, check_exhaustion_is_counted)
+{
+    uint8_t * taken[BLOCKS];
+
+    for(uint32_t idx = 0; idx < BLOCKS; idx++)
+    {
+        taken[idx] = digi_pool_alloc(&pool);
+        CHECK(taken[idx] != NULL);
+        for(uint32_t other = 0; other < idx; other++)
+        {
+            CHECK(taken[idx] != taken[other]);
+        }
+    }
+
+    POINTERS_EQUAL(NULL, digi_pool_alloc(&pool));
+    LONGS_EQUAL(1, digi_pool_failures(&pool));
+    LONGS_EQUAL(BLOCKS, digi_pool_high_water(&pool));
+
+    for(uint32_t idx = 0; idx < BLOCKS; idx++)
+    {
+        CHECK(digi_pool_free(&pool, taken[idx]) == DIGI_OK);
+    }
+    LONGS_EQUAL(0, digi_pool_used(&pool));
+    LONGS_EQUAL(BLOCKS, digi_pool_high_water(&pool));
+}
+
+// A cache refills a batch at a time and hands surplus back
+TEST(Pool, check_cache_moves_batches)
+{
+    uint8_t * taken[3 * DIGI_POOL_CACHE_BATCH];
+
+    taken[0] = digi_pool_cache_alloc(&cache, &pool);
+    CHECK(taken[0] != NULL);
+    LONGS_EQUAL(DIGI_POOL_CACHE_BATCH, digi_pool_used(&pool));
+
+    for(uint32_t idx = 1; idx < 3 * DIGI_POOL_CACHE_BATCH; idx++)
+    {
+        taken[idx] = digi_pool_cache_alloc(&cache, &pool);
+        CHECK(taken[idx] != NULL);
+    }
+    LONGS_EQUAL(3 * DIGI_POOL_CACHE_BATCH, digi_pool_used(&pool));
+
+    for(uint32_t idx = 0; idx < 3 * DIGI_POOL_CACHE_BATCH; idx++)
+    {
+        CHECK(digi_pool_cache_free(&cache, &pool, taken[idx]) == DIGI_OK);
+    }
+    CHECK(cache.count < 2 * DIGI_POOL_CACHE_BATCH);
+    LONGS_EQUAL(cache.count, digi_pool_used(&pool));
+
+    digi_pool_cache_drain(&cache, &pool);
+    LONGS_EQUAL(0, digi_pool_used(&pool));
+    LONGS_EQUAL(0, cache.count);
+}
+
+// A cache and the shared pool together never hand out more blocks than there are
+TEST(Pool, check_cache_and_pool_share_blocks)
+{
+    uint32_t taken = 0;
+
+    while(digi_pool_cache_alloc(&cache, &pool) != NULL)
+    {
+        taken++;
+    }
+
+    LONGS_EQUAL(BLOCKS, taken);
+    POINTERS_EQUAL(NULL, digi_pool_alloc(&pool));
+}
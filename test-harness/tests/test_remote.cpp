@@ -0,0 +1,388 @@
+#include "CppUTest/TestHarness.h"
+
+#include <string.h>
+
+extern "C" 
+{
+    #include "c_driver_digimesh_remote.h"
+}
+
+
+#define MAXIMUM_OUTCOMES 32
+
+typedef struct{
+    uint32_t requests[MAXIMUM_OUTCOMES];
+    bool responded[MAXIMUM_OUTCOMES];
+    uint8_t statuses[MAXIMUM_OUTCOMES];
+    size_t count;
+}outcomes_t;
+
+static void outcome(void * context, const digi_remote_request_t * request, const digi_remote_at_response_t * response)
+{
+    outcomes_t * outcomes = (outcomes_t *)context;
+
+    // Queries don't use the value so it numbers the requests
+    outcomes->requests[outcomes->count] = request->value;
+    outcomes->responded[outcomes->count] = response != NULL;
+    outcomes->statuses[outcomes->count] = (response != NULL) ? response->response.status : 0xFF;
+    outcomes->count++;
+}
+
+TEST_GROUP(Remote) 
+{
+    void setup()
+    {
+        digi_pending_init(&pending);
+        digi_parser_init(&parser);
+        memset(&outcomes, 0, sizeof(outcomes));
+        for(size_t idx = 0; idx < MAXIMUM_OUTCOMES; idx++)
+        {
+            requests[idx] = {destination, DIGI_FIELD_CH, false, (uint32_t)idx, 0};
+        }
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_pending_t pending;
+    digi_parser_t parser;
+    digi_remote_t remote;
+    outcomes_t outcomes;
+    digi_serial_t destination = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x40, 0x00, 0x00, 0x01}};
+    digi_remote_request_t requests[MAXIMUM_OUTCOMES];
+    uint8_t message[MAXIMUM_MESSAGE_SIZE * 4];
+    uint8_t frame_ids[MAXIMUM_OUTCOMES];
+
+    // Parse the frames written by a poll, noting their frame ids, and return how many there were
+    size_t sent(size_t size)
+    {
+        size_t offset = 0;
+        size_t frames = 0;
+
+        while(offset < size)
+        {
+            size_t consumed = 0;
+            digi_frame_view_t frame;
+
+            CHECK(digi_parser_feed(&parser, &message[offset], size - offset, &consumed, &frame) == DIGI_PARSE_FRAME);
+            BYTES_EQUAL(DIGI_FRAME_REMOTE_AT, frame.type);
+            frame_ids[frames++] = frame.data[0];
+            offset += consumed;
+        }
+
+        return frames;
+    }
+
+    // Answer a remote AT command the way the remote digi module would
+    void respond(uint8_t frame_id, uint8_t status)
+    {
+        uint8_t data[15] = {0};
+
+        data[0] = frame_id;
+        memcpy(&data[1], destination.serial, DIGI_SERIAL_LENGTH);
+        data[9] = 0x12;
+        data[10] = 0x34;
+        data[11] = 'C';
+        data[12] = 'H';
+        data[13] = status;
+        data[14] = 0x0C;
+
+        digi_frame_view_t frame = {DIGI_FRAME_REMOTE_AT_RESPONSE, data, sizeof(data)};
+        CHECK(digi_pending_complete(&pending, &frame) == DIGI_OK);
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// The window and attempts must be in range
+TEST(Remote, check_init_rejects_bad_parameters)
+{
+    CHECK(digi_remote_init(&remote, &pending, 0, 3, 100, 50, outcome, &outcomes) == DIGI_ERROR);
+    CHECK(digi_remote_init(&remote, &pending, DIGI_REMOTE_MAXIMUM_WINDOW + 1, 3, 100, 50, outcome, &outcomes) == DIGI_ERROR);
+    CHECK(digi_remote_init(&remote, &pending, 4, 0, 100, 50, outcome, &outcomes) == DIGI_ERROR);
+}
+
+// Nothing to run writes nothing and is done
+TEST(Remote, check_empty_engine_is_done)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 0));
+    CHECK(digi_remote_done(&remote));
+}
+
+// A remote AT response that is too short fails to decode
+TEST(Remote, check_decode_short_response)
+{
+    uint8_t data[13] = {0};
+    digi_frame_view_t frame = {DIGI_FRAME_REMOTE_AT_RESPONSE, data, sizeof(data)};
+    digi_remote_at_response_t response;
+
+    CHECK(digi_decode_remote_at_response(&frame, &response) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A remote query is built with the destination, the unknown network address and the field code
+TEST(Remote, check_generate_remote_get)
+{
+    uint8_t expected[] = {0x7E, 0x00, 0x0F, 0x17, 0x01, 0x00, 0x13, 0xA2, 0x00, 0x40, 0x00, 0x00, 0x01, 0xFF, 0xFE, 0x00, 'C', 'H', 0x69};
+
+    LONGS_EQUAL(sizeof(expected), digi_generate_remote_get_field_message(message, sizeof(message), 1, &destination, DIGI_FIELD_CH));
+    MEMCMP_EQUAL(expected, message, sizeof(expected));
+}
+
+// A remote set carries the options and the value at the field's width
+TEST(Remote, check_generate_remote_set)
+{
+    uint8_t expected[] = {0x7E, 0x00, 0x10, 0x17, 0x02, 0x00, 0x13, 0xA2, 0x00, 0x40, 0x00, 0x00, 0x01, 0xFF, 0xFE, 0x02, 'C', 'H', 0x0C, 0x5A};
+
+    LONGS_EQUAL(sizeof(expected), digi_generate_remote_set_field_message(message, sizeof(message), 2, &destination, 0x02, DIGI_FIELD_CH, 0x0C));
+    MEMCMP_EQUAL(expected, message, sizeof(expected));
+    LONGS_EQUAL(0, digi_generate_remote_set_field_message(message, sizeof(expected) - 1, 2, &destination, 0x02, DIGI_FIELD_CH, 0x0C));
+}
+
+// A remote AT response decodes to its source, field, status and value
+TEST(Remote, check_decode_response)
+{
+    uint8_t data[] = {0x07, 0x00, 0x13, 0xA2, 0x00, 0x40, 0x00, 0x00, 0x01, 0x12, 0x34, 'C', 'H', 0x00, 0x0C};
+    digi_frame_view_t frame = {DIGI_FRAME_REMOTE_AT_RESPONSE, data, sizeof(data)};
+    digi_remote_at_response_t response;
+
+    CHECK(digi_decode_remote_at_response(&frame, &response) == DIGI_OK);
+    MEMCMP_EQUAL(destination.serial, response.source.serial, DIGI_SERIAL_LENGTH);
+    BYTES_EQUAL(0x07, response.response.frame_id);
+    CHECK(response.response.field == DIGI_FIELD_CH);
+    BYTES_EQUAL(0x00, response.response.status);
+    LONGS_EQUAL(1, response.response.length);
+    BYTES_EQUAL(0x0C, response.response.value[0]);
+}
+
+// A request is sent once and reported when its response arrives
+TEST(Remote, check_request_completes)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 1);
+
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 10));
+    CHECK_FALSE(digi_remote_done(&remote));
+
+    respond(frame_ids[0], 0x00);
+
+    LONGS_EQUAL(1, outcomes.count);
+    CHECK(outcomes.responded[0]);
+    BYTES_EQUAL(0x00, outcomes.statuses[0]);
+    CHECK(digi_remote_done(&remote));
+    CHECK_FALSE(digi_pending_is_active(&pending, frame_ids[0]));
+}
+
+// A rejected command is reported straight away without a retry
+TEST(Remote, check_error_status_is_reported)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 1);
+
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    respond(frame_ids[0], 0x02);
+
+    LONGS_EQUAL(1, outcomes.count);
+    BYTES_EQUAL(0x02, outcomes.statuses[0]);
+    LONGS_EQUAL(0, digi_remote_retries(&remote));
+    CHECK(digi_remote_done(&remote));
+}
+
+// A missing response is retried after the backoff, doubling each time, then given up on
+TEST(Remote, check_timeout_backs_off_then_fails)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 1);
+
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    uint8_t first = frame_ids[0];
+
+    // Overdue at 100, first retry due 50 later
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 100));
+    CHECK_FALSE(digi_pending_is_active(&pending, first));
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 149));
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 150)));
+
+    // Overdue at 250, second retry due 100 later
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 250));
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 349));
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 350)));
+    LONGS_EQUAL(2, digi_remote_retries(&remote));
+    LONGS_EQUAL(0, outcomes.count);
+
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 450));
+    LONGS_EQUAL(1, outcomes.count);
+    CHECK_FALSE(outcomes.responded[0]);
+    LONGS_EQUAL(1, digi_remote_failures(&remote));
+    CHECK(digi_remote_done(&remote));
+}
+
+// A backoff too large to double is capped rather than wrapping round to now
+TEST(Remote, check_large_backoff_saturates)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 10, 0x90000000, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 1);
+
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 10));
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 11));
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 10 + UINT32_MAX / 2 - 1));
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 10 + UINT32_MAX / 2)));
+    LONGS_EQUAL(1, digi_remote_retries(&remote));
+}
+
+// A response that came too late for its frame id is ignored
+TEST(Remote, check_late_response_is_ignored)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 1);
+
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    uint8_t first = frame_ids[0];
+    digi_remote_poll(&remote, message, sizeof(message), 100);
+
+    uint8_t data[15] = {first};
+    digi_frame_view_t frame = {DIGI_FRAME_REMOTE_AT_RESPONSE, data, sizeof(data)};
+    CHECK(digi_pending_complete(&pending, &frame) == DIGI_ERROR);
+    LONGS_EQUAL(0, outcomes.count);
+}
+
+// A failed transmission to the remote module is retried
+TEST(Remote, check_transmission_failure_is_retried)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 1);
+
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    respond(frame_ids[0], 0x04);
+    LONGS_EQUAL(0, outcomes.count);
+    LONGS_EQUAL(1, digi_remote_retries(&remote));
+
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, sizeof(message), 50)));
+    respond(frame_ids[0], 0x00);
+    LONGS_EQUAL(1, outcomes.count);
+    CHECK(outcomes.responded[0]);
+}
+
+/********/
+/* Many */
+/********/
+
+// No more than the window is in flight, and finished requests make room for the next
+TEST(Remote, check_window_limits_in_flight)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 10);
+
+    LONGS_EQUAL(4, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, sizeof(message), 1));
+
+    respond(frame_ids[1], 0x00);
+    respond(frame_ids[3], 0x00);
+    uint8_t waiting[2] = {frame_ids[0], frame_ids[2]};
+
+    LONGS_EQUAL(2, sent(digi_remote_poll(&remote, message, sizeof(message), 2)));
+    respond(waiting[0], 0x00);
+    respond(waiting[1], 0x00);
+    respond(frame_ids[0], 0x00);
+    respond(frame_ids[1], 0x00);
+
+    while(!digi_remote_done(&remote))
+    {
+        size_t frames = sent(digi_remote_poll(&remote, message, sizeof(message), 3));
+        CHECK(frames > 0);
+        for(size_t idx = 0; idx < frames; idx++)
+        {
+            respond(frame_ids[idx], 0x00);
+        }
+    }
+
+    LONGS_EQUAL(10, outcomes.count);
+    LONGS_EQUAL(1, outcomes.requests[0]);
+    LONGS_EQUAL(3, outcomes.requests[1]);
+}
+
+// Frames that don't fit in the buffer go out on the next poll
+TEST(Remote, check_small_buffer_spreads_frames)
+{
+    size_t frame_size = digi_generate_remote_get_field_message(message, sizeof(message), 1, &destination, DIGI_FIELD_CH);
+
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 4);
+
+    LONGS_EQUAL(3, sent(digi_remote_poll(&remote, message, frame_size * 3 + 1, 0)));
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, frame_size * 3 + 1, 0)));
+    LONGS_EQUAL(0, digi_remote_poll(&remote, message, frame_size * 3 + 1, 0));
+}
+
+// A full buffer doesn't stop every overdue response being given up on
+TEST(Remote, check_full_buffer_still_expires_every_slot)
+{
+    size_t frame_size = digi_generate_remote_get_field_message(message, sizeof(message), 1, &destination, DIGI_FIELD_CH);
+
+    CHECK(digi_remote_init(&remote, &pending, 3, 3, 100, 0, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 4);
+
+    LONGS_EQUAL(3, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    uint8_t last = frame_ids[2];
+    respond(frame_ids[0], 0x00);
+
+    // The new request fills the buffer, so the first retry stops sending before the last slot is reached
+    LONGS_EQUAL(1, sent(digi_remote_poll(&remote, message, frame_size, 100)));
+    LONGS_EQUAL(2, digi_remote_retries(&remote));
+    CHECK_FALSE(digi_pending_is_active(&pending, last));
+}
+
+// Starting a new list leaves the requests in flight alone, even when the caller reuses the old list
+TEST(Remote, check_start_while_in_flight)
+{
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 4);
+    LONGS_EQUAL(4, sent(digi_remote_poll(&remote, message, sizeof(message), 0)));
+    uint8_t earlier[4];
+    memcpy(earlier, frame_ids, sizeof(earlier));
+
+    requests[0].value = 100;
+    requests[1].value = 101;
+    digi_remote_start(&remote, requests, 2);
+    CHECK_FALSE(digi_remote_done(&remote));
+
+    for(size_t idx = 0; idx < 4; idx++)
+    {
+        respond(earlier[idx], 0x00);
+        LONGS_EQUAL(idx, outcomes.requests[idx]);
+    }
+
+    LONGS_EQUAL(2, sent(digi_remote_poll(&remote, message, sizeof(message), 1)));
+    respond(frame_ids[0], 0x00);
+    respond(frame_ids[1], 0x00);
+
+    LONGS_EQUAL(6, outcomes.count);
+    LONGS_EQUAL(100, outcomes.requests[4]);
+    LONGS_EQUAL(101, outcomes.requests[5]);
+    CHECK(digi_remote_done(&remote));
+}
+
+// Sets and queries mix in one list
+TEST(Remote, check_sets_and_queries)
+{
+    requests[1].set = true;
+    requests[1].value = 0x0C;
+    requests[1].options = 0x02;
+
+    CHECK(digi_remote_init(&remote, &pending, 4, 3, 100, 50, outcome, &outcomes) == DIGI_OK);
+    digi_remote_start(&remote, requests, 2);
+
+    size_t size = digi_remote_poll(&remote, message, sizeof(message), 0);
+    LONGS_EQUAL(2, sent(size));
+    LONGS_EQUAL(19 + 20, size);
+}
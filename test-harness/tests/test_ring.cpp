@@ -0,0 +1,139 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_ring.h"
+}
+
+
+TEST_GROUP(Ring) 
+{
+    void setup()
+    {
+        digi_ring_init(&ring, storage, sizeof(storage));
+        digi_parser_init(&parser);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_ring_t ring;
+    uint8_t storage[16];
+    digi_parser_t parser;
+
+    // Local AT command response to an ID query with frame id 1, status OK and value 0x7FFF
+    uint8_t id_response[11] = {0x7E, 0x00, 0x07, 0x88, 0x01, 'I', 'D', 0x00, 0x7F, 0xFF, 0x6B};
+
+    // Drain the ring through the parser a region at a time and count the frames found
+    int drain_through_parser()
+    {
+        int frames = 0;
+        const uint8_t * region;
+        size_t size;
+
+        while((size = digi_ring_read_peek(&ring, &region)) > 0)
+        {
+            size_t consumed = 0;
+            digi_frame_view_t frame;
+            digi_parse_result_t result;
+            do
+            {
+                result = digi_parser_feed(&parser, region, size, &consumed, &frame);
+                if(result == DIGI_PARSE_FRAME)
+                {
+                    frames++;
+                }
+                region += consumed;
+                size -= consumed;
+                digi_ring_read_commit(&ring, consumed);
+            }while(result != DIGI_PARSE_NEED_MORE);
+        }
+
+        return frames;
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// A new ring has nothing to read
+TEST(Ring, check_ring_is_empty_on_init)
+{
+    const uint8_t * region;
+
+    LONGS_EQUAL(0, digi_ring_used(&ring));
+    LONGS_EQUAL(0, digi_ring_read_peek(&ring, &region));
+    LONGS_EQUAL(0, digi_ring_overruns(&ring));
+}
+
+// Only power of two sizes are accepted
+TEST(Ring, check_ring_rejects_odd_size)
+{
+    CHECK(digi_ring_init(&ring, storage, 12) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// Bytes pushed come back out in order
+TEST(Ring, check_pushed_bytes_can_be_read)
+{
+    uint8_t bytes[] = {1, 2, 3};
+    const uint8_t * region;
+
+    LONGS_EQUAL(3, digi_ring_push(&ring, bytes, sizeof(bytes)));
+    LONGS_EQUAL(3, digi_ring_read_peek(&ring, &region));
+    MEMCMP_EQUAL(bytes, region, 3);
+
+    digi_ring_read_commit(&ring, 3);
+    LONGS_EQUAL(0, digi_ring_used(&ring));
+}
+
+// Bytes that don't fit are dropped and counted
+TEST(Ring, check_overrun_is_counted)
+{
+    uint8_t bytes[20] = {0};
+
+    LONGS_EQUAL(16, digi_ring_push(&ring, bytes, sizeof(bytes)));
+    LONGS_EQUAL(4, digi_ring_overruns(&ring));
+    LONGS_EQUAL(0, digi_ring_push(&ring, bytes, 1));
+    LONGS_EQUAL(5, digi_ring_overruns(&ring));
+}
+
+/********/
+/* Many */
+/********/
+
+// A frame that wraps around the end of the ring is still parsed, a region at a time
+TEST(Ring, check_frame_across_wrap_is_parsed)
+{
+    uint8_t filler[10] = {0};
+    const uint8_t * region;
+
+    digi_ring_push(&ring, filler, sizeof(filler));
+    digi_ring_read_peek(&ring, &region);
+    digi_ring_read_commit(&ring, sizeof(filler));
+
+    LONGS_EQUAL(sizeof(id_response), digi_ring_push(&ring, id_response, sizeof(id_response)));
+    LONGS_EQUAL(6, digi_ring_read_peek(&ring, &region));
+    LONGS_EQUAL(1, drain_through_parser());
+    LONGS_EQUAL(0, digi_ring_used(&ring));
+}
+
+// Many frames streamed through a small ring are all found
+TEST(Ring, check_many_frames_stream_through)
+{
+    int frames = 0;
+
+    for(int idx = 0; idx < 100; idx++)
+    {
+        LONGS_EQUAL(sizeof(id_response), digi_ring_push(&ring, id_response, sizeof(id_response)));
+        frames += drain_through_parser();
+    }
+
+    LONGS_EQUAL(100, frames);
+    LONGS_EQUAL(0, digi_ring_overruns(&ring));
+}
@@ -0,0 +1,246 @@
+#include "CppUTest/TestHarness.h"
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+extern "C" 
+{
+    #include "user_serial.h"
+}
+
+
+TEST_GROUP(Serial) 
+{
+    void setup()
+    {
+        // The master side of a pty pair stands in for the digi module
+        master = posix_openpt(O_RDWR | O_NOCTTY);
+        CHECK(master >= 0);
+        LONGS_EQUAL(0, grantpt(master));
+        LONGS_EQUAL(0, unlockpt(master));
+        CHECK(user_serial_open(&port, ptsname(master), 115200, false) == DIGI_OK);
+        digi_parser_init(&parser);
+    }
+
+    void teardown()
+    {
+        user_serial_close(&port);
+        if(master >= 0)
+        {
+            close(master);
+        }
+    }
+
+    int master;
+    user_serial_t port;
+    digi_parser_t parser;
+
+    // Local AT command response to an ID query with frame id 1, status OK and value 0x7FFF
+    uint8_t id_response[11] = {0x7E, 0x00, 0x07, 0x88, 0x01, 'I', 'D', 0x00, 0x7F, 0xFF, 0x6B};
+
+    // Read from the port until size bytes have arrived or the pty stays quiet
+    size_t read_all(uint8_t * buffer, size_t size)
+    {
+        size_t total = 0;
+
+        for(int attempt = 0; attempt < 1000 && total < size; attempt++)
+        {
+            size_t received = 0;
+            CHECK(user_serial_read(&port, buffer + total, size - total, &received) == DIGI_OK);
+            total += received;
+
+            if(received == 0)
+            {
+                usleep(1000);
+            }
+        }
+
+        return total;
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// Reading before anything arrives returns straight away with nothing
+TEST(Serial, check_read_with_nothing_arrived_returns_immediately)
+{
+    uint8_t buffer[16];
+    size_t received = 1;
+
+    CHECK(user_serial_read(&port, buffer, sizeof(buffer), &received) == DIGI_OK);
+    LONGS_EQUAL(0, received);
+}
+
+// Reading after the digi module hangs up is an error rather than an endless run of empty reads
+TEST(Serial, check_read_after_hang_up_fails)
+{
+    uint8_t buffer[16];
+    size_t received = 1;
+
+    close(master);
+    master = -1;
+
+    CHECK(user_serial_read(&port, buffer, sizeof(buffer), &received) == DIGI_ERROR);
+    LONGS_EQUAL(0, received);
+}
+
+// A baud rate the digi module can't use is rejected
+TEST(Serial, check_open_rejects_unsupported_baud)
+{
+    user_serial_t other;
+
+    CHECK(user_serial_open(&other, ptsname(master), 12345, false) == DIGI_ERROR);
+    LONGS_EQUAL(-1, user_serial_fd(&other));
+}
+
+// A tty that doesn't exist is rejected
+TEST(Serial, check_open_rejects_missing_device)
+{
+    user_serial_t other;
+
+    CHECK(user_serial_open(&other, "/dev/does-not-exist", 9600, false) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A frame sent by the digi module is read and parsed
+TEST(Serial, check_frame_from_module_parses)
+{
+    uint8_t buffer[64];
+    size_t consumed = 0;
+    digi_frame_view_t frame;
+
+    LONGS_EQUAL(sizeof(id_response), write(master, id_response, sizeof(id_response)));
+    LONGS_EQUAL(sizeof(id_response), read_all(buffer, sizeof(id_response)));
+
+    CHECK(digi_parser_feed(&parser, buffer, sizeof(id_response), &consumed, &frame) == DIGI_PARSE_FRAME);
+    CHECK(frame.type == DIGI_FRAME_LOCAL_AT_RESPONSE);
+    LONGS_EQUAL(sizeof(id_response), consumed);
+}
+
+// A frame written to the port reaches the digi module
+TEST(Serial, check_write_reaches_module)
+{
+    uint8_t message[MAXIMUM_MESSAGE_SIZE];
+    uint8_t buffer[MAXIMUM_MESSAGE_SIZE];
+    size_t sent = 0;
+    size_t size = digi_generate_get_field_message(message, sizeof(message), 1, DIGI_FIELD_ID);
+
+    CHECK(user_serial_write(&port, message, size, &sent) == DIGI_OK);
+    LONGS_EQUAL(size, sent);
+    LONGS_EQUAL((ssize_t)size, read(master, buffer, sizeof(buffer)));
+    MEMCMP_EQUAL(message, buffer, size);
+}
+
+// The file descriptor is open and non-blocking
+TEST(Serial, check_fd_is_non_blocking)
+{
+    CHECK(user_serial_fd(&port) >= 0);
+    CHECK(fcntl(user_serial_fd(&port), F_GETFL) & O_NONBLOCK);
+}
+
+/********/
+/* Many */
+/********/
+
+// Bytes read into a ring land on both sides of the wrap
+TEST(Serial, check_read_into_ring_across_wrap)
+{
+    uint8_t storage[16];
+    digi_ring_t ring;
+    const uint8_t * region;
+    size_t received = 0;
+
+    digi_ring_init(&ring, storage, sizeof(storage));
+
+    // Move the ring's head near the end so the next read wraps
+    uint8_t filler[12] = {0};
+    digi_ring_push(&ring, filler, sizeof(filler));
+    digi_ring_read_commit(&ring, digi_ring_read_peek(&ring, &region));
+
+    LONGS_EQUAL(sizeof(id_response), write(master, id_response, sizeof(id_response)));
+    for(int attempt = 0; attempt < 1000 && received < sizeof(id_response); attempt++)
+    {
+        size_t count = 0;
+        CHECK(user_serial_read_ring(&port, &ring, &count) == DIGI_OK);
+        received += count;
+        usleep(count == 0 ? 1000 : 0);
+    }
+
+    LONGS_EQUAL(sizeof(id_response), received);
+    LONGS_EQUAL(sizeof(id_response), digi_ring_used(&ring));
+
+    uint8_t copy[sizeof(id_response)];
+    size_t copied = 0;
+    size_t size;
+    while((size = digi_ring_read_peek(&ring, &region)) > 0)
+    {
+        memcpy(copy + copied, region, size);
+        copied += size;
+        digi_ring_read_commit(&ring, size);
+    }
+    MEMCMP_EQUAL(id_response, copy, sizeof(id_response));
+}
+
+// Back to back frames arrive in one read and all parse
+TEST(Serial, check_several_frames_in_one_read)
+{
+    uint8_t buffer[64];
+    uint8_t stream[3 * sizeof(id_response)];
+    int frames = 0;
+
+    for(int i = 0; i < 3; i++)
+    {
+        memcpy(stream + i * sizeof(id_response), id_response, sizeof(id_response));
+    }
+
+    LONGS_EQUAL(sizeof(stream), write(master, stream, sizeof(stream)));
+    size_t size = read_all(buffer, sizeof(stream));
+    LONGS_EQUAL(sizeof(stream), size);
+
+    size_t offset = 0;
+    while(offset < size)
+    {
+        size_t consumed = 0;
+        digi_frame_view_t frame;
+        if(digi_parser_feed(&parser, buffer + offset, size - offset, &consumed, &frame) == DIGI_PARSE_FRAME)
+        {
+            frames++;
+        }
+        offset += consumed;
+    }
+
+    LONGS_EQUAL(3, frames);
+}
+
+// Several frames go out in one writev through a TX queue
+TEST(Serial, check_tx_queue_writes_batch)
+{
+    digi_tx_t tx;
+    uint8_t messages[3][MAXIMUM_MESSAGE_SIZE];
+    uint8_t expected[3 * MAXIMUM_MESSAGE_SIZE];
+    uint8_t buffer[3 * MAXIMUM_MESSAGE_SIZE];
+    size_t total = 0;
+
+    digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES, user_serial_writev, &port, SIZE_MAX, 10);
+
+    for(uint8_t idx = 0; idx < 3; idx++)
+    {
+        size_t size = digi_generate_get_field_message(messages[idx], MAXIMUM_MESSAGE_SIZE, (uint8_t)(idx + 1), DIGI_FIELD_ID);
+        memcpy(expected + total, messages[idx], size);
+        total += size;
+        CHECK(digi_tx_queue(&tx, messages[idx], size, 0) == DIGI_OK);
+    }
+
+    CHECK(digi_tx_poll(&tx, 10) == DIGI_OK);
+    LONGS_EQUAL(0, digi_tx_pending(&tx));
+    LONGS_EQUAL(1, digi_tx_batches(&tx, 3));
+
+    LONGS_EQUAL(total, read(master, buffer, sizeof(buffer)));
+    MEMCMP_EQUAL(expected, buffer, total);
+}
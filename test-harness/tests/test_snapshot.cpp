@@ -0,0 +1,196 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_snapshot.h"
+}
+
+
+TEST_GROUP(Snapshot) 
+{
+    void setup()
+    {
+        digi = digi_init(&storage);
+        digi_cache_init(&cache);
+        digi_nodes_init(&table, node_storage, 16);
+
+        restored = digi_init(&restored_storage);
+        digi_cache_init(&restored_cache);
+        digi_nodes_init(&restored_table, restored_node_storage, 16);
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_context_storage_t storage;
+    digi_t * digi;
+    digi_cache_t cache;
+    digi_node_table_t table;
+    digi_node_t node_storage[16];
+
+    digi_context_storage_t restored_storage;
+    digi_t * restored;
+    digi_cache_t restored_cache;
+    digi_node_table_t restored_table;
+    digi_node_t restored_node_storage[16];
+
+    uint8_t snapshot[512];
+
+    digi_serial_t serial = {.serial = {0x00, 0x13, 0xA2, 0x00, 0x41, 0x52, 0x7E, 0x11}};
+
+    // Fill the cache with a field's value as if the digi module had been queried
+    void learn(char first, char second, uint8_t value)
+    {
+        uint8_t data[] = {1, (uint8_t)first, (uint8_t)second, 0, value};
+        digi_frame_view_t frame = {DIGI_FRAME_LOCAL_AT_RESPONSE, data, sizeof(data)};
+        digi_cache_frame(&cache, &frame);
+    }
+
+    // Give the digi module a serial, two cached fields and three nodes
+    size_t save_populated()
+    {
+        digi_register(digi, &serial);
+        learn('C', 'H', 0x0C);
+        learn('P', 'L', 0x04);
+
+        for(uint32_t idx = 0; idx < 3; idx++)
+        {
+            digi_node_t * node = digi_nodes_insert(&table, 0x0013A20041000000ull + idx);
+            node->last_seen = 1000 + idx;
+            node->link_quality = (uint8_t)(40 + idx);
+            node->sleep = DIGI_NODE_AWAKE;
+        }
+
+        return digi_snapshot_save(snapshot, sizeof(snapshot), digi, &cache, &table);
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// An empty state saves just the header and loads back
+TEST(Snapshot, check_empty_state_round_trips)
+{
+    size_t size = digi_snapshot_save(snapshot, sizeof(snapshot), digi, &cache, &table);
+
+    LONGS_EQUAL(DIGI_SNAPSHOT_HEADER_SIZE, size);
+    LONGS_EQUAL(size, digi_snapshot_size(&cache, &table));
+    CHECK(digi_snapshot_load(snapshot, size, restored, &restored_cache, &restored_table) == DIGI_OK);
+    CHECK(!digi_is_initialized(restored));
+    LONGS_EQUAL(0, digi_nodes_count(&restored_table));
+}
+
+// Nothing is written into a buffer that's too small
+TEST(Snapshot, check_snapshot_is_not_saved_into_small_buffer)
+{
+    LONGS_EQUAL(0, digi_snapshot_save(snapshot, DIGI_SNAPSHOT_HEADER_SIZE - 1, digi, NULL, NULL));
+}
+
+// A buffer too short to be a snapshot is refused
+TEST(Snapshot, check_truncated_snapshot_is_refused)
+{
+    size_t size = save_populated();
+
+    CHECK(digi_snapshot_load(snapshot, 8, restored, &restored_cache, &restored_table) == DIGI_ERROR);
+    CHECK(digi_snapshot_load(snapshot, size - 1, restored, &restored_cache, &restored_table) == DIGI_ERROR);
+    CHECK(!digi_is_initialized(restored));
+}
+
+/*******/
+/* One */
+/*******/
+
+// The serial number comes back
+TEST(Snapshot, check_serial_round_trips)
+{
+    digi_serial_t loaded;
+
+    digi_register(digi, &serial);
+    size_t size = digi_snapshot_save(snapshot, sizeof(snapshot), digi, NULL, NULL);
+
+    CHECK(digi_snapshot_load(snapshot, size, restored, NULL, NULL) == DIGI_OK);
+    CHECK(digi_is_initialized(restored));
+    digi_get_serial(restored, &loaded);
+    MEMCMP_EQUAL(serial.serial, loaded.serial, DIGI_SERIAL_LENGTH);
+}
+
+// A snapshot with a flipped byte is refused and nothing changes
+TEST(Snapshot, check_corrupt_snapshot_is_refused)
+{
+    size_t size = save_populated();
+    uint32_t value = 0;
+
+    snapshot[size - 3] ^= 0x01;
+
+    CHECK(digi_snapshot_load(snapshot, size, restored, &restored_cache, &restored_table) == DIGI_ERROR);
+    CHECK(!digi_is_initialized(restored));
+    CHECK(digi_cache_get(&restored_cache, DIGI_FIELD_CH, &value) == DIGI_ERROR);
+    LONGS_EQUAL(0, digi_nodes_count(&restored_table));
+}
+
+// A snapshot from another layout version is refused
+TEST(Snapshot, check_other_version_is_refused)
+{
+    size_t size = save_populated();
+
+    snapshot[4] = DIGI_SNAPSHOT_VERSION + 1;
+
+    CHECK(digi_snapshot_load(snapshot, size, restored, &restored_cache, &restored_table) == DIGI_ERROR);
+}
+
+/********/
+/* Many */
+/********/
+
+// Cached values and nodes come back as they were
+TEST(Snapshot, check_state_round_trips)
+{
+    size_t size = save_populated();
+    uint32_t value = 0;
+
+    LONGS_EQUAL(DIGI_SNAPSHOT_HEADER_SIZE + 2 * DIGI_SNAPSHOT_FIELD_SIZE + 3 * DIGI_SNAPSHOT_NODE_SIZE, size);
+    CHECK(digi_snapshot_load(snapshot, size, restored, &restored_cache, &restored_table) == DIGI_OK);
+
+    CHECK(digi_cache_get(&restored_cache, DIGI_FIELD_CH, &value) == DIGI_OK);
+    LONGS_EQUAL(0x0C, value);
+    CHECK(digi_cache_get(&restored_cache, DIGI_FIELD_PL, &value) == DIGI_OK);
+    LONGS_EQUAL(0x04, value);
+    CHECK(digi_cache_get(&restored_cache, DIGI_FIELD_ID, &value) == DIGI_ERROR);
+
+    LONGS_EQUAL(3, digi_nodes_count(&restored_table));
+    for(uint32_t idx = 0; idx < 3; idx++)
+    {
+        digi_node_t * node = digi_nodes_find(&restored_table, 0x0013A20041000000ull + idx);
+        CHECK(node != NULL);
+        LONGS_EQUAL(1000 + idx, node->last_seen);
+        LONGS_EQUAL(40 + idx, node->link_quality);
+        LONGS_EQUAL(DIGI_NODE_AWAKE, node->sleep);
+    }
+}
+
+// Parts can be skipped when loading
+TEST(Snapshot, check_parts_can_be_skipped)
+{
+    size_t size = save_populated();
+    uint32_t value = 0;
+
+    CHECK(digi_snapshot_load(snapshot, size, restored, NULL, &restored_table) == DIGI_OK);
+    CHECK(digi_cache_get(&restored_cache, DIGI_FIELD_CH, &value) == DIGI_ERROR);
+    LONGS_EQUAL(3, digi_nodes_count(&restored_table));
+}
+
+// A node table without room for every node is refused before anything changes
+TEST(Snapshot, check_small_node_table_is_refused)
+{
+    size_t size = save_populated();
+    digi_node_table_t small;
+    digi_node_t small_storage[2];
+
+    digi_nodes_init(&small, small_storage, 2);
+
+    CHECK(digi_snapshot_load(snapshot, size, restored, &restored_cache, &small) == DIGI_ERROR);
+    CHECK(!digi_is_initialized(restored));
+    LONGS_EQUAL(0, digi_nodes_count(&small));
+}
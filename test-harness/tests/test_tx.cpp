@@ -0,0 +1,280 @@
+#include "CppUTest/TestHarness.h"
+
+extern "C" 
+{
+    #include "c_driver_digimesh_tx.h"
+}
+
+
+TEST_GROUP(Tx) 
+{
+    void setup()
+    {
+        CHECK(digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES, write, this, 64, 10) == DIGI_OK);
+        writes = 0;
+        sent_size = 0;
+        limit = SIZE_MAX;
+        fail = false;
+    }
+
+    void teardown()
+    {
+    }
+
+    digi_tx_t tx;
+    int writes;
+    uint8_t sent[256];
+    size_t sent_size;
+    size_t limit;
+    bool fail;
+
+    uint8_t frame_a[8] = {0x7E, 0x00, 0x04, 0x08, 0x01, 'I', 'D', 0x69};
+    uint8_t frame_b[8] = {0x7E, 0x00, 0x04, 0x08, 0x02, 'C', 'H', 0x6A};
+
+    // Records what would go out on the wire, accepting at most limit bytes per write
+    static digi_status_t write(void * context, const digi_payload_t * frames, size_t count, size_t * written)
+    {
+        TEST_GROUP_Tx * self = (TEST_GROUP_Tx *)context;
+        size_t total = 0;
+
+        self->writes++;
+        *written = 0;
+
+        if(self->fail)
+        {
+            return DIGI_ERROR;
+        }
+
+        for(size_t idx = 0; idx < count && total < self->limit; idx++)
+        {
+            size_t size = frames[idx].length;
+            if(size > self->limit - total)
+            {
+                size = self->limit - total;
+            }
+
+            memcpy(self->sent + self->sent_size, frames[idx].data, size);
+            self->sent_size += size;
+            total += size;
+        }
+
+        *written = total;
+        return DIGI_OK;
+    }
+};
+
+/********/
+/* Zero */
+/********/
+
+// Nothing is written when the queue is empty
+TEST(Tx, check_empty_flush_does_not_write)
+{
+    CHECK(digi_tx_flush(&tx) == DIGI_OK);
+    CHECK(digi_tx_poll(&tx, 1000) == DIGI_OK);
+
+    LONGS_EQUAL(0, writes);
+    LONGS_EQUAL(0, digi_tx_pending(&tx));
+    LONGS_EQUAL(0, digi_tx_batches(&tx, 0));
+    LONGS_EQUAL(0, digi_tx_batches(&tx, DIGI_TX_MAXIMUM_FRAMES + 1));
+}
+
+// A caller built with a different DIGI_TX_MAXIMUM_FRAMES is refused
+TEST(Tx, check_init_rejects_other_maximum_frames)
+{
+    CHECK(digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES + 1, write, this, 64, 10) == DIGI_ERROR);
+}
+
+/*******/
+/* One */
+/*******/
+
+// A single frame waits for the deadline
+TEST(Tx, check_frame_waits_for_deadline)
+{
+    CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), 100) == DIGI_OK);
+    CHECK(digi_tx_poll(&tx, 109) == DIGI_OK);
+
+    LONGS_EQUAL(0, writes);
+    LONGS_EQUAL(1, digi_tx_pending(&tx));
+
+    CHECK(digi_tx_poll(&tx, 110) == DIGI_OK);
+
+    LONGS_EQUAL(1, writes);
+    LONGS_EQUAL(0, digi_tx_pending(&tx));
+    LONGS_EQUAL(1, digi_tx_batches(&tx, 1));
+    LONGS_EQUAL(1, digi_tx_frames_sent(&tx));
+    MEMCMP_EQUAL(frame_a, sent, sizeof(frame_a));
+}
+
+// The deadline still works when the caller's clock wraps
+TEST(Tx, check_deadline_across_clock_wrap)
+{
+    CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), UINT32_MAX - 4) == DIGI_OK);
+    CHECK(digi_tx_poll(&tx, 4) == DIGI_OK);
+
+    LONGS_EQUAL(0, writes);
+
+    CHECK(digi_tx_poll(&tx, 5) == DIGI_OK);
+
+    LONGS_EQUAL(1, writes);
+}
+
+// A failed write is reported and the frame stays queued
+TEST(Tx, check_failed_write_keeps_frame)
+{
+    fail = true;
+    CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), 0) == DIGI_OK);
+
+    CHECK(digi_tx_flush(&tx) == DIGI_ERROR);
+    LONGS_EQUAL(1, digi_tx_pending(&tx));
+
+    fail = false;
+    CHECK(digi_tx_flush(&tx) == DIGI_OK);
+    LONGS_EQUAL(0, digi_tx_pending(&tx));
+    LONGS_EQUAL(1, digi_tx_batches(&tx, 1));
+}
+
+// A write that only gets part of a frame out counts as a batch that completed none
+TEST(Tx, check_partial_frame_write_counts_no_frames)
+{
+    limit = 3;
+    CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), 0) == DIGI_OK);
+    CHECK(digi_tx_flush(&tx) == DIGI_OK);
+
+    LONGS_EQUAL(1, digi_tx_batches(&tx, 0));
+    LONGS_EQUAL(0, digi_tx_batches(&tx, 1));
+    LONGS_EQUAL(0, digi_tx_frames_sent(&tx));
+}
+
+// A frame whose flush failed is still queued, and goes out once with the next flush
+TEST(Tx, check_failed_flush_on_queue_keeps_frame_once)
+{
+    digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES, write, this, 8, 10);
+
+    fail = true;
+    CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), 0) == DIGI_OK);
+    LONGS_EQUAL(1, writes);
+    LONGS_EQUAL(1, digi_tx_pending(&tx));
+
+    fail = false;
+    CHECK(digi_tx_flush(&tx) == DIGI_OK);
+    LONGS_EQUAL(0, digi_tx_pending(&tx));
+    LONGS_EQUAL(sizeof(frame_a), sent_size);
+}
+
+/********/
+/* Many */
+/********/
+
+// A full queue goes out in one write, in order
+TEST(Tx, check_full_queue_flushes_in_one_write)
+{
+    digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES, write, this, SIZE_MAX, 10);
+
+    for(int idx = 0; idx < DIGI_TX_MAXIMUM_FRAMES; idx++)
+    {
+        uint8_t * frame = (idx % 2) ? frame_b : frame_a;
+        CHECK(digi_tx_queue(&tx, frame, 8, 0) == DIGI_OK);
+    }
+
+    LONGS_EQUAL(1, writes);
+    LONGS_EQUAL(0, digi_tx_pending(&tx));
+    LONGS_EQUAL(1, digi_tx_batches(&tx, DIGI_TX_MAXIMUM_FRAMES));
+    LONGS_EQUAL(DIGI_TX_MAXIMUM_FRAMES, digi_tx_frames_sent(&tx));
+    LONGS_EQUAL(DIGI_TX_MAXIMUM_FRAMES * 8, sent_size);
+    MEMCMP_EQUAL(frame_a, sent, 8);
+    MEMCMP_EQUAL(frame_b, sent + 8, 8);
+}
+
+// Crossing the byte threshold flushes early
+TEST(Tx, check_byte_threshold_flushes)
+{
+    digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES, write, this, 20, 10);
+
+    CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), 0) == DIGI_OK);
+    CHECK(digi_tx_queue(&tx, frame_b, sizeof(frame_b), 0) == DIGI_OK);
+    LONGS_EQUAL(0, writes);
+
+    CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), 0) == DIGI_OK);
+    LONGS_EQUAL(1, writes);
+    LONGS_EQUAL(1, digi_tx_batches(&tx, 3));
+}
+
+// A partial write keeps the unsent tail and sends it next time
+TEST(Tx, check_partial_write_resumes)
+{
+    uint8_t expected[16];
+    memcpy(expected, frame_a, 8);
+    memcpy(expected + 8, frame_b, 8);
+
+    limit = 11;
+    CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), 0) == DIGI_OK);
+    CHECK(digi_tx_queue(&tx, frame_b, sizeof(frame_b), 0) == DIGI_OK);
+    CHECK(digi_tx_flush(&tx) == DIGI_OK);
+
+    LONGS_EQUAL(1, digi_tx_pending(&tx));
+    LONGS_EQUAL(1, digi_tx_frames_sent(&tx));
+
+    limit = SIZE_MAX;
+    CHECK(digi_tx_flush(&tx) == DIGI_OK);
+
+    LONGS_EQUAL(0, digi_tx_pending(&tx));
+    LONGS_EQUAL(2, digi_tx_frames_sent(&tx));
+    LONGS_EQUAL(0, digi_tx_batches(&tx, 2));
+    LONGS_EQUAL(2, digi_tx_batches(&tx, 1));
+    LONGS_EQUAL(16, sent_size);
+    MEMCMP_EQUAL(expected, sent, 16);
+}
+
+// A full queue that the writer won't take rejects more frames
+TEST(Tx, check_full_queue_rejects_when_blocked)
+{
+    digi_tx_init(&tx, DIGI_TX_MAXIMUM_FRAMES, write, this, SIZE_MAX, 10);
+    limit = 0;
+
+    for(int idx = 0; idx < DIGI_TX_MAXIMUM_FRAMES; idx++)
+    {
+        CHECK(digi_tx_queue(&tx, frame_a, sizeof(frame_a), 0) == DIGI_OK);
+    }
+
+    CHECK(digi_tx_queue(&tx, frame_b, sizeof(frame_b), 0) == DIGI_ERROR);
+    LONGS_EQUAL(DIGI_TX_MAXIMUM_FRAMES, digi_tx_pending(&tx));
+
+    // Writes that got nothing out aren't counted as batches
+    for(size_t frames = 0; frames <= DIGI_TX_MAXIMUM_FRAMES; frames++)
+    {
+        LONGS_EQUAL(0, digi_tx_batches(&tx, frames));
+    }
+
+    limit = SIZE_MAX;
+    CHECK(digi_tx_queue(&tx, frame_b, sizeof(frame_b), 0) == DIGI_OK);
+    LONGS_EQUAL(1, digi_tx_pending(&tx));
+}
+
+// Frames built in pool blocks go back to the pool once written in full
+TEST(Tx, check_sent_frames_return_to_pool)
+{
+    digi_pool_t pool;
+    digi_pool_block_t blocks[2];
+    uint8_t * first;
+    uint8_t * second;
+
+    digi_pool_init(&pool, blocks, 2, DIGI_POOL_BLOCK_SIZE);
+    digi_tx_set_pool(&tx, &pool);
+    first = digi_pool_alloc(&pool);
+    second = digi_pool_alloc(&pool);
+
+    size_t first_size = digi_generate_get_field_message(first, DIGI_POOL_BLOCK_SIZE, 1, DIGI_FIELD_ID);
+    size_t second_size = digi_generate_get_field_message(second, DIGI_POOL_BLOCK_SIZE, 2, DIGI_FIELD_CH);
+
+    limit = first_size + 1;
+    CHECK(digi_tx_queue(&tx, first, first_size, 0) == DIGI_OK);
+    CHECK(digi_tx_queue(&tx, second, second_size, 0) == DIGI_OK);
+    CHECK(digi_tx_flush(&tx) == DIGI_OK);
+    LONGS_EQUAL(1, digi_pool_used(&pool));
+
+    limit = SIZE_MAX;
+    CHECK(digi_tx_flush(&tx) == DIGI_OK);
+    LONGS_EQUAL(0, digi_pool_used(&pool));
+}
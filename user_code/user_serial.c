@@ -0,0 +1,247 @@
+#define _DEFAULT_SOURCE
+
+#include "user_serial.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+/*********************************/
+/* PRIVATE FUNCTION DECLARATIONS */
+/*********************************/
+
+/**
+ * @brief Convert a baud rate to its termios speed.
+ * 
+ * @param baud - the baud rate
+ * @param speed - populated with the termios speed
+ * 
+ * @return digi_status_t - DIGI_ERROR if the baud rate isn't supported
+ */
+static digi_status_t user_serial_speed(uint32_t baud, speed_t * speed);
+
+/********************************/
+/* PRIVATE FUNCTION DEFINITIONS */
+/********************************/
+
+static digi_status_t user_serial_speed(uint32_t baud, speed_t * speed)
+{
+    switch(baud)
+    {
+        case 1200:      *speed = B1200;     break;
+        case 2400:      *speed = B2400;     break;
+        case 4800:      *speed = B4800;     break;
+        case 9600:      *speed = B9600;     break;
+        case 19200:     *speed = B19200;    break;
+        case 38400:     *speed = B38400;    break;
+        case 57600:     *speed = B57600;    break;
+        case 115200:    *speed = B115200;   break;
+        case 230400:    *speed = B230400;   break;
+#ifdef B460800
+        case 460800:    *speed = B460800;   break;
+#endif
+#ifdef B921600
+        case 921600:    *speed = B921600;   break;
+#endif
+        default:
+            return DIGI_ERROR;
+    }
+
+    return DIGI_OK;
+}
+
+/*******************************/
+/* PUBLIC FUNCTION DEFINITIONS */
+/*******************************/
+
+digi_status_t user_serial_open(user_serial_t * port, const char * path, uint32_t baud, bool software_flow_control)
+{
+    struct termios options;
+    speed_t speed;
+
+    port->fd = -1;
+
+    if(user_serial_speed(baud, &speed) != DIGI_OK)
+    {
+        return DIGI_ERROR;
+    }
+
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if(fd < 0)
+    {
+        return DIGI_ERROR;
+    }
+
+    if(tcgetattr(fd, &options) != 0)
+    {
+        close(fd);
+        return DIGI_ERROR;
+    }
+
+    // Raw 8N1, no line editing or translation, reads return immediately with whatever has arrived
+    cfmakeraw(&options);
+    options.c_cflag |= CLOCAL | CREAD;
+    options.c_cflag &= ~(tcflag_t)CSTOPB;
+    options.c_cc[VMIN] = 0;
+    options.c_cc[VTIME] = 0;
+
+    if(software_flow_control)
+    {
+        options.c_iflag |= IXON | IXOFF;
+    }
+
+    if(cfsetispeed(&options, speed) != 0 || cfsetospeed(&options, speed) != 0 || tcsetattr(fd, TCSANOW, &options) != 0)
+    {
+        close(fd);
+        return DIGI_ERROR;
+    }
+
+    tcflush(fd, TCIOFLUSH);
+    port->fd = fd;
+
+    return DIGI_OK;
+}
+
+void user_serial_close(user_serial_t * port)
+{
+    if(port->fd >= 0)
+    {
+        close(port->fd);
+        port->fd = -1;
+    }
+
+    return;
+}
+
+int user_serial_fd(const user_serial_t * port)
+{
+    return port->fd;
+}
+
+digi_status_t user_serial_read(user_serial_t * port, uint8_t * buffer, size_t size, size_t * received)
+{
+    *received = 0;
+
+    if(size == 0)
+    {
+        return DIGI_OK;
+    }
+
+    ssize_t count;
+    do
+    {
+        count = read(port->fd, buffer, size);
+    }while(count < 0 && errno == EINTR);
+
+    if(count < 0)
+    {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? DIGI_OK : DIGI_ERROR;
+    }
+
+    // A raw tty with VMIN and VTIME at 0 reads 0 both when nothing has arrived and when it has hung up,
+    // only poll tells them apart
+    if(count == 0)
+    {
+        struct pollfd status = {.fd = port->fd, .events = POLLIN};
+
+        if(poll(&status, 1, 0) > 0 && (status.revents & (POLLHUP | POLLERR)))
+        {
+            return DIGI_ERROR;
+        }
+    }
+
+    *received = (size_t)count;
+
+    return DIGI_OK;
+}
+
+digi_status_t user_serial_read_ring(user_serial_t * port, digi_ring_t * ring, size_t * received)
+{
+    *received = 0;
+
+    // The free space is at most two regions, before and after the wrap
+    for(uint8_t region_count = 0; region_count < 2; region_count++)
+    {
+        uint8_t * region;
+        size_t space = digi_ring_write_peek(ring, &region);
+        size_t count = 0;
+
+        if(user_serial_read(port, region, space, &count) != DIGI_OK)
+        {
+            return DIGI_ERROR;
+        }
+
+        digi_ring_write_commit(ring, count);
+        *received += count;
+
+        // A short read means nothing more is waiting
+        if(count < space || space == 0)
+        {
+            break;
+        }
+    }
+
+    return DIGI_OK;
+}
+
+digi_status_t user_serial_write(user_serial_t * port, const uint8_t * bytes, size_t size, size_t * sent)
+{
+    *sent = 0;
+
+    if(size == 0)
+    {
+        return DIGI_OK;
+    }
+
+    ssize_t count;
+    do
+    {
+        count = write(port->fd, bytes, size);
+    }while(count < 0 && errno == EINTR);
+
+    if(count < 0)
+    {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? DIGI_OK : DIGI_ERROR;
+    }
+
+    *sent = (size_t)count;
+
+    return DIGI_OK;
+}
+
+digi_status_t user_serial_writev(void * context, const digi_payload_t * frames, size_t count, size_t * written)
+{
+    user_serial_t * port = context;
+    struct iovec vectors[DIGI_TX_MAXIMUM_FRAMES];
+
+    *written = 0;
+
+    if(count > DIGI_TX_MAXIMUM_FRAMES)
+    {
+        return DIGI_ERROR;
+    }
+
+    for(size_t idx = 0; idx < count; idx++)
+    {
+        vectors[idx].iov_base = (void *)frames[idx].data;
+        vectors[idx].iov_len = frames[idx].length;
+    }
+
+    ssize_t total;
+    do
+    {
+        total = writev(port->fd, vectors, (int)count);
+    }while(total < 0 && errno == EINTR);
+
+    if(total < 0)
+    {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? DIGI_OK : DIGI_ERROR;
+    }
+
+    *written = (size_t)total;
+
+    return DIGI_OK;
+}
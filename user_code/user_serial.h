@@ -0,0 +1,105 @@
+#ifndef USER_SERIAL_H
+#define USER_SERIAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "c_driver_digimesh_parser.h"
+#include "c_driver_digimesh_ring.h"
+#include "c_driver_digimesh_tx.h"
+
+/****************/
+/* PUBLIC TYPES */
+/****************/
+
+/**
+ * @brief A serial port connected to a digi module, opened in non-blocking raw mode.
+ */
+typedef struct{
+    int fd;     // File descriptor of the open tty. -1 when closed.
+}user_serial_t;
+
+/********************************/
+/* PUBLIC FUNCTION DECLARATIONS */
+/********************************/
+
+/**
+ * @brief Open a tty for talking to a digi module. The port is put in raw 8N1 mode with reads and writes that
+ * never block, so it can be polled or added to an epoll set through user_serial_fd.
+ * 
+ * @param port - populated with the open port
+ * @param path - the tty, e.g. "/dev/ttyUSB0"
+ * @param baud - the baud rate the digi module is set to (BD)
+ * @param software_flow_control - use XON/XOFF flow control, for digi modules in API mode 2
+ * 
+ * @return digi_status_t - DIGI_ERROR if the tty can't be opened or the baud rate isn't supported
+ */
+digi_status_t user_serial_open(user_serial_t * port, const char * path, uint32_t baud, bool software_flow_control);
+
+/**
+ * @brief Close a port.
+ * 
+ * @param port - the port
+ */
+void user_serial_close(user_serial_t * port);
+
+/**
+ * @brief The file descriptor of a port, for poll, select or epoll. It becomes readable when bytes arrive.
+ * 
+ * @param port - the port
+ * 
+ * @return int 
+ */
+int user_serial_fd(const user_serial_t * port);
+
+/**
+ * @brief Read whatever bytes have arrived, up to size, in one system call. Never blocks.
+ * 
+ * @param port - the port
+ * @param buffer - where to put the bytes
+ * @param size - number of bytes available in buffer
+ * @param received - populated with the number of bytes read, 0 if nothing had arrived
+ * 
+ * @return digi_status_t - DIGI_ERROR if the read failed or the tty hung up
+ */
+digi_status_t user_serial_read(user_serial_t * port, uint8_t * buffer, size_t size, size_t * received);
+
+/**
+ * @brief Read whatever bytes have arrived straight into the free space of a ring. Never blocks and never
+ * copies, at most two system calls are made when the free space wraps.
+ * 
+ * @param port - the port
+ * @param ring - the ring to fill. The caller must be its only producer.
+ * @param received - populated with the number of bytes read
+ * 
+ * @return digi_status_t - DIGI_ERROR if the read failed or the tty hung up
+ */
+digi_status_t user_serial_read_ring(user_serial_t * port, digi_ring_t * ring, size_t * received);
+
+/**
+ * @brief Write as many bytes as the tty will take without blocking.
+ * 
+ * @param port - the port
+ * @param bytes - the bytes to send
+ * @param size - number of bytes to send
+ * @param sent - populated with the number of bytes written, which may be less than size
+ * 
+ * @return digi_status_t - DIGI_ERROR if the write failed
+ */
+digi_status_t user_serial_write(user_serial_t * port, const uint8_t * bytes, size_t size, size_t * sent);
+
+/**
+ * @brief Write a batch of frames with one writev, taking as many bytes as the tty will without blocking.
+ * Matches digi_tx_write_t so a port can be given to digi_tx_init with the port as the context.
+ * 
+ * @param context - the port
+ * @param frames - the frames to send
+ * @param count - number of frames, at most DIGI_TX_MAXIMUM_FRAMES
+ * @param written - populated with the number of bytes written, which may be less than the batch
+ * 
+ * @return digi_status_t - DIGI_ERROR if the write failed
+ */
+digi_status_t user_serial_writev(void * context, const digi_payload_t * frames, size_t count, size_t * written);
+
+#endif